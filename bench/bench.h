@@ -0,0 +1,139 @@
+// Shared harness for the native micro-benchmarks.
+//
+// Each benchmark executable includes this header from exactly one source file:
+// it replaces the global operator new to count the heap allocations made by
+// the measured code. Results print as a table, or with --json as one object
+// per run that bench/compare.js can diff against another run.
+
+#ifndef ABLETONLINK_BENCH_H
+#define ABLETONLINK_BENCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace bench {
+inline std::atomic<uint64_t> allocations{0};
+
+struct Result {
+    std::string name;
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    double opsPerSec = 0.0;
+    // Payload bytes handled per op, for paths that move audio data.
+    double bytesPerOp = 0.0;
+};
+
+struct Options {
+    uint64_t iterations = 1000000;
+    bool json = false;
+};
+
+// Usage: <bench> [iterations] [--json]
+inline Options ParseOptions(int argc, char** argv, uint64_t defaultIterations) {
+    Options options;
+    options.iterations = defaultIterations;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        } else {
+            options.iterations = std::strtoull(argv[i], nullptr, 10);
+        }
+    }
+    return options;
+}
+
+template <typename Fn>
+Result Measure(const char* name, uint64_t iterations, Fn&& fn, double bytesPerOp = 0.0) {
+    // Warm up caches and the Link clock before timing.
+    for (uint64_t i = 0; i < iterations / 10; ++i) {
+        fn();
+    }
+    const auto allocsBefore = allocations.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto allocs = allocations.load(std::memory_order_relaxed) - allocsBefore;
+    const auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+    Result result;
+    result.name = name;
+    result.nsPerOp = ns / static_cast<double>(iterations);
+    result.allocsPerOp = static_cast<double>(allocs) / static_cast<double>(iterations);
+    result.opsPerSec = result.nsPerOp > 0.0 ? 1e9 / result.nsPerOp : 0.0;
+    result.bytesPerOp = bytesPerOp;
+    return result;
+}
+
+class Reporter {
+public:
+    Reporter(const char* suite, const Options& options) : suite_(suite), options_(options) {
+        if (!options_.json) {
+            std::printf("%s, iterations: %llu\n", suite_,
+                        static_cast<unsigned long long>(options_.iterations));
+        }
+    }
+
+    void Add(const Result& result) {
+        results_.push_back(result);
+        if (options_.json) {
+            return;
+        }
+        std::printf("%-32s %10.1f ns/op %8.2f allocs/op %12.0f ops/s", result.name.c_str(),
+                    result.nsPerOp, result.allocsPerOp, result.opsPerSec);
+        if (result.bytesPerOp > 0.0) {
+            std::printf(" %10.1f MB/s", result.bytesPerOp * result.opsPerSec / 1e6);
+        }
+        std::printf("\n");
+    }
+
+    void Finish() const {
+        if (!options_.json) {
+            return;
+        }
+        std::printf("{\"suite\":\"%s\",\"iterations\":%llu,\"results\":[", suite_,
+                    static_cast<unsigned long long>(options_.iterations));
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const auto& r = results_[i];
+            std::printf("%s{\"name\":\"%s\",\"nsPerOp\":%.3f,\"allocsPerOp\":%.4f,"
+                        "\"opsPerSec\":%.1f,\"bytesPerOp\":%.1f}",
+                        i == 0 ? "" : ",", r.name.c_str(), r.nsPerOp, r.allocsPerOp,
+                        r.opsPerSec, r.bytesPerOp);
+        }
+        std::printf("]}\n");
+    }
+
+    bool Json() const { return options_.json; }
+
+private:
+    const char* suite_;
+    Options options_;
+    std::vector<Result> results_;
+};
+} // namespace bench
+
+void* operator new(std::size_t size) {
+    bench::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif // ABLETONLINK_BENCH_H
@@ -0,0 +1,70 @@
+// Compares two benchmark runs produced with --json.
+//
+//   node bench/compare.js base.json head.json [--threshold 10]
+//
+// Each file holds one JSON result object per line, so the output of several
+// benchmarks can be collected with `>>`. Results are matched by suite and
+// name. Exits with status 1 when a result is slower than the threshold
+// (percent) or makes more allocations per op than before.
+import fs from 'fs';
+
+const args = process.argv.slice(2);
+const files = [];
+let threshold = 10;
+for (let i = 0; i < args.length; i++) {
+  if (args[i] === '--threshold') {
+    threshold = Number(args[++i]);
+  } else {
+    files.push(args[i]);
+  }
+}
+
+if (files.length !== 2 || !Number.isFinite(threshold)) {
+  console.error('Usage: node bench/compare.js base.json head.json [--threshold 10]');
+  process.exit(2);
+}
+
+function load(file) {
+  const results = new Map();
+  for (const line of fs.readFileSync(file, 'utf8').split('\n')) {
+    if (!line.trim().startsWith('{')) continue;
+    const run = JSON.parse(line);
+    for (const r of run.results) {
+      results.set(`${run.suite}: ${r.name}`, r);
+    }
+  }
+  return results;
+}
+
+const base = load(files[0]);
+const head = load(files[1]);
+let regressions = 0;
+
+for (const [key, h] of head) {
+  const b = base.get(key);
+  if (!b) {
+    console.log(`${key.padEnd(44)} ${h.nsPerOp.toFixed(1).padStart(10)} ns/op  (new)`);
+    continue;
+  }
+  const delta = ((h.nsPerOp - b.nsPerOp) / b.nsPerOp) * 100;
+  const moreAllocs =
+    typeof h.allocsPerOp === 'number' &&
+    typeof b.allocsPerOp === 'number' &&
+    h.allocsPerOp > b.allocsPerOp + 0.01;
+  const slower = delta > threshold;
+  if (slower || moreAllocs) regressions++;
+  const allocs =
+    typeof h.allocsPerOp === 'number' && typeof b.allocsPerOp === 'number'
+      ? `  allocs ${b.allocsPerOp.toFixed(2)} -> ${h.allocsPerOp.toFixed(2)}`
+      : '';
+  console.log(
+    `${key.padEnd(44)} ${b.nsPerOp.toFixed(1).padStart(10)} -> ` +
+      `${h.nsPerOp.toFixed(1).padStart(10)} ns/op ${delta >= 0 ? '+' : ''}${delta.toFixed(1)}%` +
+      `${allocs}${slower || moreAllocs ? '  REGRESSION' : ''}`
+  );
+}
+for (const key of base.keys()) {
+  if (!head.has(key)) console.log(`${key.padEnd(44)} (missing in ${files[1]})`);
+}
+
+process.exit(regressions > 0 ? 1 : 0);
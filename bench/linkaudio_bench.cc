@@ -0,0 +1,86 @@
+// Micro-benchmarks for the LinkAudio hot paths used by AbletonLinkAudioWrapper
+// and its sink/source wrappers, measured without the N-API layer (see
+// bench/napi-bench.js for the JS side). Build and run with:
+//
+//   node-gyp rebuild -- -Dbuild_benchmarks=1
+//   ./build/Release/abletonlink_audio_bench [iterations] [--json]
+
+#include "bench.h"
+
+#include "abletonlink_nodeid.h"
+
+#include <ableton/LinkAudio.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace {
+constexpr std::size_t kFrames = 512;
+constexpr std::size_t kChannels = 2;
+constexpr uint32_t kSampleRate = 48000;
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto options = bench::ParseOptions(argc, argv, 200000);
+    const auto iterations = options.iterations;
+    bench::Reporter reporter("linkaudio", options);
+
+    ableton::LinkAudio link(120.0, "bench");
+    link.enable(true);
+    link.enableLinkAudio(true);
+    volatile double sink = 0.0;
+
+    reporter.Add(bench::Measure("captureAppSessionState", iterations, [&]() {
+        const auto state = link.captureAppSessionState();
+        sink = state.tempo();
+    }));
+    reporter.Add(bench::Measure("captureAudioSessionState", iterations, [&]() {
+        const auto state = link.captureAudioSessionState();
+        sink = state.tempo();
+    }));
+
+    ableton::link::NodeIdArray bytes{};
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(0x11 * (i + 1));
+    }
+    const ableton::link::NodeId id(bytes);
+    reporter.Add(bench::Measure("NodeIdToHexString", iterations, [&]() {
+        sink = static_cast<double>(NodeIdToHexString(id).size());
+    }));
+    const auto hex = NodeIdToHexString(id);
+    reporter.Add(bench::Measure("ParseNodeIdString", iterations, [&]() {
+        ableton::link::NodeId parsed{};
+        sink = ParseNodeIdString(hex, parsed) ? 1.0 : 0.0;
+    }));
+
+    // The source callback copies every received buffer into a new Node Buffer
+    // (Buffer::Copy); an owning heap copy is the native equivalent.
+    const std::vector<int16_t> received(kFrames * kChannels, 1);
+    const auto bufferBytes = static_cast<double>(received.size() * sizeof(int16_t));
+    reporter.Add(bench::Measure("source buffer copy", iterations, [&]() {
+        std::vector<int16_t> copy(received.begin(), received.end());
+        sink = copy[kFrames];
+    }, bufferBytes));
+
+    // Retain, fill and commit one buffer, as AbletonLinkAudioTransport does per
+    // render cycle. Commits without a subscribed peer still take the full path
+    // through the sink's buffer bookkeeping.
+    ableton::LinkAudioSink audioSink(link, "bench", kFrames * kChannels);
+    auto state = link.captureAudioSessionState();
+    double beat = 0.0;
+    reporter.Add(bench::Measure("retainBuffer + commit", iterations, [&]() {
+        ableton::LinkAudioSink::BufferHandle handle(audioSink);
+        if (!handle) {
+            return;
+        }
+        const auto samples = std::min(kFrames * kChannels, handle.maxNumSamples);
+        std::fill(handle.samples, handle.samples + samples, int16_t{0});
+        handle.commit(state, beat, 4.0, samples / kChannels, kChannels, kSampleRate);
+        beat += static_cast<double>(kFrames) / kSampleRate * 2.0;
+    }, bufferBytes));
+
+    reporter.Finish();
+    link.enableLinkAudio(false);
+    link.enable(false);
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,246 @@
+// In-process Link Audio loopback benchmark.
+//
+// Two AbletonLinkAudio peers run in this process: one publishes stereo test
+// buffers through AbletonLinkAudioSink, the other receives them through
+// AbletonLinkAudioSource. Every buffer carries a sequence number and the Link
+// clock time of its commit, so the receiver measures sink -> source latency,
+// jitter and loss without a second machine. For each buffer size the channel
+// count doubles until a trial loses more than --max-loss of its buffers or
+// its p99 latency exceeds --max-p99-ms.
+//
+//   node bench/loopback-bench.js [--buffers 128,256,512,1024]
+//     [--channels 1,2,4,8,16,32] [--seconds 3] [--sample-rate 48000]
+//     [--max-loss 0.01] [--max-p99-ms 50] [--json]
+import { createRequire } from 'module';
+import {
+  CHANNELS_PER_STREAM,
+  percentile,
+  readHeader,
+  sleep,
+  writeHeader,
+} from './loopback-common.js';
+
+const require = createRequire(import.meta.url);
+const addon = require('bindings')('abletonlink');
+
+function parseArgs(argv) {
+  const options = {
+    buffers: [128, 256, 512, 1024],
+    channels: [1, 2, 4, 8, 16, 32],
+    seconds: 3,
+    sampleRate: 48000,
+    maxLoss: 0.01,
+    maxP99Ms: 50,
+    json: false,
+  };
+  for (let i = 0; i < argv.length; i++) {
+    const value = argv[i + 1];
+    switch (argv[i]) {
+      case '--buffers':
+        options.buffers = value.split(',').map(Number);
+        i++;
+        break;
+      case '--channels':
+        options.channels = value.split(',').map(Number);
+        i++;
+        break;
+      case '--seconds':
+        options.seconds = Number(value);
+        i++;
+        break;
+      case '--sample-rate':
+        options.sampleRate = Number(value);
+        i++;
+        break;
+      case '--max-loss':
+        options.maxLoss = Number(value);
+        i++;
+        break;
+      case '--max-p99-ms':
+        options.maxP99Ms = Number(value);
+        i++;
+        break;
+      case '--json':
+        options.json = true;
+        break;
+      default:
+        console.error(`Unknown option ${argv[i]}`);
+        process.exit(2);
+    }
+  }
+  return options;
+}
+
+async function waitForChannels(rx, names, timeoutMs = 5000) {
+  const start = Date.now();
+  while (Date.now() - start < timeoutMs) {
+    const found = rx.findChannels({ peer: 'loopback-tx' }).filter((c) => names.has(c.name));
+    if (found.length === names.size) return found;
+    await sleep(50);
+  }
+  throw new Error(`Timed out waiting for ${names.size} loopback channels`);
+}
+
+async function runTrial(tx, rx, bufferFrames, numChannels, options, trialId) {
+  const names = new Set();
+  const sinks = [];
+  for (let i = 0; i < numChannels; i++) {
+    const name = `loop-${trialId}-${i}`;
+    names.add(name);
+    sinks.push(new addon.AbletonLinkAudioSink(tx, name, bufferFrames * CHANNELS_PER_STREAM));
+  }
+
+  const sent = new Array(numChannels).fill(0);
+  // Buffers that never left the sink: no buffer to retain, or commit failed.
+  let sinkDrops = 0;
+  const received = sinks.map(() => ({
+    seqs: new Set(),
+    latencies: [],
+    lastLatency: null,
+    jitter: 0,
+  }));
+  let measureFrom = Infinity;
+  let measureTo = Infinity;
+
+  const channels = await waitForChannels(rx, names);
+  const sources = channels.map((channel) => {
+    const index = Number(channel.name.split('-').pop());
+    const stats = received[index];
+    return new addon.AbletonLinkAudioSource(rx, channel.id, ({ samples }) => {
+      const arrival = rx.getClockTime() * 1e6;
+      const words = new Uint16Array(samples.buffer, samples.byteOffset, samples.length / 2);
+      const header = readHeader(words);
+      if (!header || header.seq < measureFrom || header.seq >= measureTo) return;
+      if (stats.seqs.has(header.seq)) return;
+      stats.seqs.add(header.seq);
+      const latency = (arrival - header.micros) / 1000;
+      stats.latencies.push(latency);
+      if (stats.lastLatency !== null) {
+        // RFC 3550 style interarrival jitter.
+        stats.jitter += (Math.abs(latency - stats.lastLatency) - stats.jitter) / 16;
+      }
+      stats.lastLatency = latency;
+    });
+  });
+
+  const period = bufferFrames / options.sampleRate;
+  const warmupBuffers = Math.ceil(0.5 / period);
+  const totalBuffers = warmupBuffers + Math.ceil(options.seconds / period);
+  measureFrom = warmupBuffers;
+  measureTo = totalBuffers;
+
+  let seq = 0;
+  let late = 0;
+  let nextSend = tx.getClockTime();
+  await new Promise((resolve) => {
+    const pump = () => {
+      const now = tx.getClockTime();
+      while (seq < totalBuffers && now >= nextSend) {
+        if (now - nextSend > period) late++;
+        const state = tx.captureAppSessionState();
+        const beats = state.beatAtTime(nextSend, 4);
+        const measured = seq >= measureFrom;
+        for (let i = 0; i < numChannels; i++) {
+          const handle = sinks[i].retainBuffer();
+          if (!handle || !handle.isValid()) {
+            if (measured) sinkDrops++;
+            continue;
+          }
+          const out = handle.samples();
+          const words = new Uint16Array(out.buffer, out.byteOffset, out.length / 2);
+          words.fill(0);
+          writeHeader(words, seq, tx.getClockTime() * 1e6);
+          const ok = handle.commit(
+            state,
+            beats,
+            4,
+            bufferFrames,
+            CHANNELS_PER_STREAM,
+            options.sampleRate
+          );
+          if (measured && ok) sent[i]++;
+          else if (measured) sinkDrops++;
+        }
+        seq++;
+        nextSend += period;
+      }
+      if (seq >= totalBuffers) resolve();
+      else setImmediate(pump);
+    };
+    pump();
+  });
+  await sleep(300);
+  for (const source of sources) source.close();
+  // Withdraw this trial's channels so later trials do not run alongside them.
+  for (const sink of sinks) sink.close();
+
+  const latencies = received.flatMap((r) => r.latencies).sort((a, b) => a - b);
+  const totalSent = sent.reduce((a, b) => a + b, 0);
+  const totalReceived = received.reduce((a, r) => a + r.seqs.size, 0);
+  const attempted = totalSent + sinkDrops;
+  const loss = attempted > 0 ? Math.max(0, 1 - totalReceived / attempted) : 1;
+  const mean = latencies.reduce((a, b) => a + b, 0) / Math.max(1, latencies.length);
+  const p99 = percentile(latencies, 99);
+  return {
+    bufferFrames,
+    channels: numChannels,
+    sent: totalSent,
+    received: totalReceived,
+    sinkDrops,
+    loss,
+    lateSends: late,
+    latencyMs: {
+      p50: percentile(latencies, 50),
+      p90: percentile(latencies, 90),
+      p99,
+      max: latencies[latencies.length - 1] ?? NaN,
+      mean,
+    },
+    jitterMs: received.reduce((a, r) => a + r.jitter, 0) / numChannels,
+    throughputMBps:
+      (totalReceived * bufferFrames * CHANNELS_PER_STREAM * 2) / options.seconds / 1e6,
+    pass: loss <= options.maxLoss && p99 <= options.maxP99Ms,
+  };
+}
+
+const options = parseArgs(process.argv.slice(2));
+const tx = new addon.AbletonLinkAudio(120, 'loopback-tx');
+const rx = new addon.AbletonLinkAudio(120, 'loopback-rx');
+for (const link of [tx, rx]) {
+  link.enable(true);
+  link.enableLinkAudio(true);
+}
+
+const results = [];
+const maxChannels = {};
+let trialId = 0;
+try {
+  for (const bufferFrames of options.buffers) {
+    maxChannels[bufferFrames] = 0;
+    for (const numChannels of options.channels) {
+      const result = await runTrial(tx, rx, bufferFrames, numChannels, options, trialId++);
+      results.push(result);
+      if (!options.json) {
+        const l = result.latencyMs;
+        console.log(
+          `buffer ${String(bufferFrames).padStart(5)}  ` +
+            `channels ${String(numChannels).padStart(3)}  ` +
+            `p50 ${l.p50.toFixed(2)} p90 ${l.p90.toFixed(2)} p99 ${l.p99.toFixed(2)} ` +
+            `max ${l.max.toFixed(2)} ms  jitter ${result.jitterMs.toFixed(3)} ms  ` +
+            `loss ${(result.loss * 100).toFixed(2)}%  ${result.pass ? 'ok' : 'FAIL'}`
+        );
+      }
+      if (!result.pass) break;
+      maxChannels[bufferFrames] = numChannels;
+    }
+  }
+} finally {
+  tx.close();
+  rx.close();
+}
+
+if (options.json) {
+  console.log(JSON.stringify({ suite: 'loopback', options, results, maxChannels }));
+} else {
+  console.log('max sustainable channels per buffer size:', maxChannels);
+}
@@ -0,0 +1,36 @@
+// Helpers shared by the Link Audio loopback benchmarks. Every test buffer
+// starts with a header carrying a sequence number and the Link clock time of
+// its commit, so a receiver can measure latency and loss.
+
+export const CHANNELS_PER_STREAM = 2;
+export const MAGIC = 0x4c4b;
+// Header words: magic, sequence (2 words), commit time in µs (4 words).
+export const HEADER_WORDS = 7;
+
+export const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+export function percentile(sorted, p) {
+  if (sorted.length === 0) return NaN;
+  const index = Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1);
+  return sorted[Math.max(0, index)];
+}
+
+export function writeHeader(words, seq, micros) {
+  words[0] = MAGIC;
+  words[1] = seq & 0xffff;
+  words[2] = (seq >>> 16) & 0xffff;
+  let t = BigInt(Math.round(micros));
+  for (let i = 3; i < HEADER_WORDS; i++) {
+    words[i] = Number(t & 0xffffn);
+    t >>= 16n;
+  }
+}
+
+export function readHeader(words) {
+  if (words.length < HEADER_WORDS || words[0] !== MAGIC) return null;
+  let t = 0n;
+  for (let i = HEADER_WORDS - 1; i >= 3; i--) {
+    t = (t << 16n) | BigInt(words[i]);
+  }
+  return { seq: (words[1] | (words[2] << 16)) >>> 0, micros: Number(t) };
+}
@@ -0,0 +1,85 @@
+// N-API side of the hot-path benchmarks: the wrapper calls measured from JS,
+// including argument checks, object creation and the JS <-> native hop.
+// Native-only costs are covered by bench/linkaudio_bench.cc.
+//
+//   node --expose-gc bench/napi-bench.js [iterations] [--json]
+//
+// heapBytesPerOp is the JS heap growth over the timed loop divided by the
+// iteration count; it is approximate and reads low if a GC runs mid-loop.
+import { createRequire } from 'module';
+
+const require = createRequire(import.meta.url);
+const addon = require('bindings')('abletonlink');
+
+const args = process.argv.slice(2);
+const json = args.includes('--json');
+const iterations = Number(args.find((a) => a !== '--json') ?? 200000);
+
+const FRAMES = 512;
+const CHANNELS = 2;
+
+function measure(name, fn, bytesPerOp = 0) {
+  for (let i = 0; i < iterations / 10; i++) fn();
+  globalThis.gc?.();
+  const heapBefore = process.memoryUsage().heapUsed;
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < iterations; i++) fn();
+  const ns = Number(process.hrtime.bigint() - start);
+  const heapAfter = process.memoryUsage().heapUsed;
+  const nsPerOp = ns / iterations;
+  return {
+    name,
+    nsPerOp,
+    allocsPerOp: null,
+    heapBytesPerOp: Math.max(0, heapAfter - heapBefore) / iterations,
+    opsPerSec: nsPerOp > 0 ? 1e9 / nsPerOp : 0,
+    bytesPerOp,
+  };
+}
+
+const link = new addon.AbletonLinkAudio(120, 'napi-bench');
+link.enable(true);
+link.enableLinkAudio(true);
+const out = new Float64Array(5);
+const state = link.captureAppSessionState();
+const sink = new addon.AbletonLinkAudioSink(link, 'napi-bench', FRAMES * CHANNELS);
+const abl = new addon.AbletonLink(120);
+
+let beat = 0;
+const results = [
+  measure('getClockTime', () => link.getClockTime()),
+  measure('getState (object)', () => link.getState(4)),
+  measure('getState (Float64Array)', () => link.getState(4, out)),
+  measure('captureAppSessionState', () => link.captureAppSessionState()),
+  measure('captureAppSessionStateInto', () => link.captureAppSessionStateInto(state)),
+  measure('channels', () => link.channels()),
+  measure(
+    'retainBuffer + commit',
+    () => {
+      const handle = sink.retainBuffer();
+      if (!handle || !handle.isValid()) return;
+      handle.samples().fill(0);
+      handle.commit(state, beat, 4, FRAMES, CHANNELS, 48000);
+      beat += (FRAMES / 48000) * 2;
+    },
+    FRAMES * CHANNELS * 2
+  ),
+  measure('AbletonLink getBeat', () => abl.getBeat()),
+];
+
+if (json) {
+  console.log(JSON.stringify({ suite: 'napi', iterations, results }));
+} else {
+  console.log(`napi, iterations: ${iterations}`);
+  for (const r of results) {
+    const rate = r.bytesPerOp > 0 ? ` ${((r.bytesPerOp * r.opsPerSec) / 1e6).toFixed(1)} MB/s` : '';
+    console.log(
+      `${r.name.padEnd(32)} ${r.nsPerOp.toFixed(1).padStart(10)} ns/op ` +
+        `${r.heapBytesPerOp.toFixed(1).padStart(8)} heap B/op ` +
+        `${r.opsPerSec.toFixed(0).padStart(12)} ops/s${rate}`
+    );
+  }
+}
+
+link.close();
+abl.close();
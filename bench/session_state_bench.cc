@@ -0,0 +1,45 @@
+// Micro-benchmark for the abl_link session state capture used by AbletonLinkWrapper.
+//
+// Compares the previous per-call pattern (create, capture, destroy) with the
+// preallocated per-instance state the wrapper now reuses. Build and run with:
+//
+//   node-gyp rebuild -- -Dbuild_benchmarks=1
+//   ./build/Release/abletonlink_bench [iterations] [--json]
+
+#include "bench.h"
+
+#include <abl_link.h>
+
+int main(int argc, char** argv) {
+    const auto options = bench::ParseOptions(argc, argv, 1000000);
+    const auto iterations = options.iterations;
+    bench::Reporter reporter("session_state", options);
+
+    abl_link link = abl_link_create(120.0);
+    volatile double sink = 0.0;
+
+    const auto perCall = bench::Measure("getBeat (create/destroy)", iterations, [&]() {
+        abl_link_session_state state = abl_link_create_session_state();
+        abl_link_capture_app_session_state(link, state);
+        sink = abl_link_beat_at_time(state, abl_link_clock_micros(link), 1.0);
+        abl_link_destroy_session_state(state);
+    });
+
+    abl_link_session_state reused = abl_link_create_session_state();
+    const auto preallocated = bench::Measure("getBeat (preallocated)", iterations, [&]() {
+        abl_link_capture_app_session_state(link, reused);
+        sink = abl_link_beat_at_time(reused, abl_link_clock_micros(link), 1.0);
+    });
+    abl_link_destroy_session_state(reused);
+
+    reporter.Add(perCall);
+    reporter.Add(preallocated);
+    if (!reporter.Json()) {
+        std::printf("speedup: %.2fx\n", perCall.nsPerOp / preallocated.nsPerOp);
+    }
+    reporter.Finish();
+
+    abl_link_destroy(link);
+    (void)sink;
+    return 0;
+}
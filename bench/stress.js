@@ -0,0 +1,280 @@
+// Scale/stress run for Link Audio: --peers AbletonLinkAudio instances in one
+// process, each publishing --sinks channels and subscribing to --sources
+// channels published by the other peers. Every interval it reports CPU per
+// published channel, memory growth, end-to-end and callback latency, callback
+// queue depth and drop rates, so slow leaks and degradation over a long run
+// are visible. Peers discover each other over the local network stack, so it
+// runs headless in a plain Linux container.
+//
+//   node bench/stress.js [--peers 10] [--sinks 5] [--sources 5] [--seconds 60]
+//     [--interval 5] [--buffer-frames 256] [--sample-rate 48000] [--json]
+//
+// With --json each interval and the final summary are printed as one JSON
+// object per line (`type` is 'interval' or 'summary').
+import { createRequire } from 'module';
+import {
+  CHANNELS_PER_STREAM,
+  percentile,
+  readHeader,
+  sleep,
+  writeHeader,
+} from './loopback-common.js';
+
+const require = createRequire(import.meta.url);
+const addon = require('bindings')('abletonlink');
+
+function parseArgs(argv) {
+  const options = {
+    peers: 10,
+    sinks: 5,
+    sources: 5,
+    seconds: 60,
+    interval: 5,
+    bufferFrames: 256,
+    sampleRate: 48000,
+    json: false,
+  };
+  const numeric = {
+    '--peers': 'peers',
+    '--sinks': 'sinks',
+    '--sources': 'sources',
+    '--seconds': 'seconds',
+    '--interval': 'interval',
+    '--buffer-frames': 'bufferFrames',
+    '--sample-rate': 'sampleRate',
+  };
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === '--json') {
+      options.json = true;
+    } else if (numeric[argv[i]]) {
+      options[numeric[argv[i]]] = Number(argv[++i]);
+    } else {
+      console.error(`Unknown option ${argv[i]}`);
+      process.exit(2);
+    }
+  }
+  if (options.peers < 2) {
+    console.error('--peers must be at least 2');
+    process.exit(2);
+  }
+  return options;
+}
+
+// Subscription k of peer i: the other peers in turn, then their next sink.
+function subscriptionTargets(i, options) {
+  const targets = [];
+  for (let k = 0; k < options.sources; k++) {
+    const peer = (i + 1 + (k % (options.peers - 1))) % options.peers;
+    const sink = Math.floor(k / (options.peers - 1)) % options.sinks;
+    targets.push({ peer, sink, name: `stress-${peer}-${sink}` });
+  }
+  return targets;
+}
+
+async function waitForChannels(link, names, timeoutMs = 15000) {
+  const start = Date.now();
+  while (Date.now() - start < timeoutMs) {
+    const found = link.channels().filter((c) => names.has(c.name));
+    if (found.length === names.size) return found;
+    await sleep(100);
+  }
+  throw new Error(`Timed out waiting for ${names.size} channels`);
+}
+
+const options = parseArgs(process.argv.slice(2));
+const period = options.bufferFrames / options.sampleRate;
+
+const peers = [];
+for (let i = 0; i < options.peers; i++) {
+  const link = new addon.AbletonLinkAudio(120, `stress-${i}`);
+  link.enable(true);
+  link.enableLinkAudio(true);
+  const sinks = [];
+  for (let s = 0; s < options.sinks; s++) {
+    sinks.push({
+      sink: new addon.AbletonLinkAudioSink(
+        link,
+        `stress-${i}-${s}`,
+        options.bufferFrames * CHANNELS_PER_STREAM
+      ),
+      sent: 0,
+    });
+  }
+  peers.push({ link, sinks, subscriptions: [] });
+}
+const sinkByName = new Map();
+peers.forEach((p, i) => p.sinks.forEach((s, j) => sinkByName.set(`stress-${i}-${j}`, s)));
+
+// Buffers committed before this sequence number are warm-up and not counted.
+let measureFrom = Infinity;
+for (const [i, peer] of peers.entries()) {
+  const targets = subscriptionTargets(i, options);
+  const channels = await waitForChannels(peer.link, new Set(targets.map((t) => t.name)));
+  for (const channel of channels) {
+    const sub = {
+      name: channel.name,
+      // Buffers arrive in order per channel; a high-water mark keeps the
+      // duplicate check from growing with the run length.
+      lastSeq: -1,
+      received: 0,
+      latencies: [],
+    };
+    sub.source = new addon.AbletonLinkAudioSource(peer.link, channel.id, ({ samples }) => {
+      const arrival = peer.link.getClockTime() * 1e6;
+      const words = new Uint16Array(samples.buffer, samples.byteOffset, samples.length / 2);
+      const header = readHeader(words);
+      if (!header || header.seq < measureFrom || header.seq <= sub.lastSeq) return;
+      sub.lastSeq = header.seq;
+      sub.received++;
+      sub.latencies.push((arrival - header.micros) / 1000);
+    });
+    peer.subscriptions.push(sub);
+  }
+}
+
+const publisher = peers[0].link;
+const totalSinks = options.peers * options.sinks;
+const totalBuffers = Math.ceil((options.seconds + 1) / period);
+measureFrom = Math.ceil(1 / period);
+
+let seq = 0;
+let late = 0;
+let nextSend = publisher.getClockTime();
+let running = true;
+const pump = () => {
+  const now = publisher.getClockTime();
+  while (seq < totalBuffers && now >= nextSend) {
+    if (now - nextSend > period) late++;
+    for (const peer of peers) {
+      const state = peer.link.captureAppSessionState();
+      const beats = state.beatAtTime(nextSend, 4);
+      for (const entry of peer.sinks) {
+        const handle = entry.sink.retainBuffer();
+        if (!handle || !handle.isValid()) continue;
+        const out = handle.samples();
+        const words = new Uint16Array(out.buffer, out.byteOffset, out.length / 2);
+        words.fill(0);
+        writeHeader(words, seq, peer.link.getClockTime() * 1e6);
+        const frames = options.bufferFrames;
+        const ok = handle.commit(state, beats, 4, frames, CHANNELS_PER_STREAM, options.sampleRate);
+        if (ok && seq >= measureFrom) entry.sent++;
+      }
+    }
+    seq++;
+    nextSend += period;
+  }
+  if (seq >= totalBuffers) running = false;
+  else setImmediate(pump);
+};
+pump();
+
+// Sources see a sink's buffers only while subscribed, so expected counts are
+// taken per subscription from the sink it follows.
+function snapshot(previous) {
+  const subs = peers.flatMap((p) => p.subscriptions);
+  let expected = 0;
+  let received = 0;
+  const latencies = [];
+  for (const sub of subs) {
+    const sent = sinkByName.get(sub.name).sent;
+    expected += sent - (previous?.sent.get(sub.name) ?? 0);
+    received += sub.received - (previous?.received.get(sub.name) ?? 0);
+    latencies.push(...sub.latencies);
+    sub.latencies = [];
+  }
+  latencies.sort((a, b) => a - b);
+
+  let queueDepth = 0;
+  let dropped = 0;
+  let callbackP99Us = 0;
+  for (const sub of subs) {
+    const { buffers } = sub.source.getStats();
+    queueDepth += buffers.queueDepth;
+    dropped += buffers.dropped;
+    callbackP99Us = Math.max(callbackP99Us, buffers.latency.p99Us);
+  }
+  return {
+    at: process.hrtime.bigint(),
+    cpu: process.cpuUsage(),
+    memory: process.memoryUsage(),
+    sent: new Map(subs.map((s) => [s.name, sinkByName.get(s.name).sent])),
+    received: new Map(subs.map((s) => [s.name, s.received])),
+    expected,
+    receivedDelta: received,
+    latencies,
+    queueDepth,
+    dropped,
+    callbackP99Us,
+  };
+}
+
+const intervals = [];
+let previous = snapshot(null);
+const first = previous;
+const startedAt = Date.now();
+while (running || Date.now() - startedAt < options.seconds * 1000) {
+  await sleep(options.interval * 1000);
+  const current = snapshot(previous);
+  const elapsedUs = Number(current.at - previous.at) / 1000;
+  const cpuUs =
+    current.cpu.user - previous.cpu.user + (current.cpu.system - previous.cpu.system);
+  const interval = {
+    type: 'interval',
+    t: (Date.now() - startedAt) / 1000,
+    cpuPercent: (cpuUs / elapsedUs) * 100,
+    cpuPercentPerChannel: (cpuUs / elapsedUs / totalSinks) * 100,
+    rssMB: current.memory.rss / 1e6,
+    heapUsedMB: current.memory.heapUsed / 1e6,
+    externalMB: current.memory.external / 1e6,
+    latencyMs: {
+      p50: percentile(current.latencies, 50),
+      p99: percentile(current.latencies, 99),
+      max: current.latencies[current.latencies.length - 1] ?? NaN,
+    },
+    callbackP99Us: current.callbackP99Us,
+    queueDepth: current.queueDepth,
+    callbacksDropped: current.dropped,
+    loss: current.expected > 0 ? Math.max(0, 1 - current.receivedDelta / current.expected) : 0,
+    lateSends: late,
+  };
+  intervals.push(interval);
+  if (options.json) {
+    console.log(JSON.stringify(interval));
+  } else {
+    console.log(
+      `t=${interval.t.toFixed(0).padStart(4)}s  cpu ${interval.cpuPercent.toFixed(1)}% ` +
+        `(${interval.cpuPercentPerChannel.toFixed(2)}%/ch)  rss ${interval.rssMB.toFixed(1)} MB  ` +
+        `p99 ${interval.latencyMs.p99.toFixed(2)} ms  queue ${interval.queueDepth}  ` +
+        `loss ${(interval.loss * 100).toFixed(2)}%`
+    );
+  }
+  previous = current;
+}
+
+await sleep(300);
+const last = snapshot(previous);
+const subs = peers.flatMap((p) => p.subscriptions);
+const totalExpected = subs.reduce((a, s) => a + sinkByName.get(s.name).sent, 0);
+const totalReceived = subs.reduce((a, s) => a + s.received, 0);
+const minutes = options.seconds / 60;
+const p99s = intervals.map((i) => i.latencyMs.p99).filter(Number.isFinite);
+const summary = {
+  type: 'summary',
+  options,
+  channels: totalSinks,
+  subscriptions: subs.length,
+  loss: totalExpected > 0 ? Math.max(0, 1 - totalReceived / totalExpected) : 1,
+  lateSends: late,
+  meanCpuPercentPerChannel:
+    intervals.reduce((a, i) => a + i.cpuPercentPerChannel, 0) / Math.max(1, intervals.length),
+  rssGrowthMBPerMin: (last.memory.rss - first.memory.rss) / 1e6 / minutes,
+  heapGrowthMBPerMin: (last.memory.heapUsed - first.memory.heapUsed) / 1e6 / minutes,
+  worstP99Ms: p99s.length > 0 ? Math.max(...p99s) : NaN,
+  callbacksDropped: last.dropped,
+};
+console.log(options.json ? JSON.stringify(summary) : summary);
+
+for (const peer of peers) {
+  for (const sub of peer.subscriptions) sub.source.close();
+  peer.link.close();
+}
@@ -1,14 +1,29 @@
 {
+  "variables": {
+    "build_benchmarks%": 0
+  },
   "targets": [
     {
       "target_name": "abletonlink",
       "sources": [
         "src/wrapper/abletonlink.cc",
+        "src/wrapper/abletonlink_archive.cc",
         "src/wrapper/abletonlink_audio.cc",
+        "src/wrapper/abletonlink_decode.cc",
+        "src/wrapper/abletonlink_midiclock.cc",
+        "src/wrapper/abletonlink_mixbus.cc",
+        "src/wrapper/abletonlink_publisher.cc",
+        "src/wrapper/abletonlink_scheduler.cc",
+        "src/wrapper/abletonlink_spectrum.cc",
+        "src/wrapper/abletonlink_tempo.cc",
+        "src/wrapper/abletonlink_thread_policy.cc",
+        "src/wrapper/abletonlink_trace.cc",
+        "src/wrapper/abletonlink_transport.cc",
         "link/extensions/abl_link/src/abl_link.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
+        "include",
         "link/include",
         "link/extensions/abl_link/include",
         "link/modules/asio-standalone/asio/include"
@@ -55,5 +70,101 @@
         }]
       ]
     }
+  ],
+  "conditions": [
+    ["build_benchmarks==1", {
+      "targets": [
+        {
+          "target_name": "abletonlink_bench",
+          "type": "executable",
+          "sources": [
+            "bench/session_state_bench.cc",
+            "link/extensions/abl_link/src/abl_link.cpp"
+          ],
+          "include_dirs": [
+            "link/include",
+            "link/extensions/abl_link/include",
+            "link/modules/asio-standalone/asio/include"
+          ],
+          "cflags!": [ "-fno-exceptions" ],
+          "cflags_cc!": [ "-fno-exceptions" ],
+          "cflags_cc": [ "-std=c++17" ],
+          "defines": [ "ASIO_STANDALONE=1" ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+                "CLANG_CXX_LIBRARY": "libc++",
+                "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+                "MACOSX_DEPLOYMENT_TARGET": "10.11"
+              },
+              "defines": [ "LINK_PLATFORM_MACOSX=1" ]
+            }],
+            ["OS=='win'", {
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "ExceptionHandling": 1,
+                  "AdditionalOptions": [ "/std:c++17" ]
+                }
+              },
+              "defines": [
+                "LINK_PLATFORM_WINDOWS=1",
+                "_WIN32_WINNT=0x0601"
+              ]
+            }],
+            ["OS=='linux'", {
+              "cflags_cc": [ "-std=c++17", "-pthread" ],
+              "ldflags": [ "-pthread" ],
+              "defines": [ "LINK_PLATFORM_LINUX=1" ]
+            }]
+          ]
+        },
+        {
+          "target_name": "abletonlink_audio_bench",
+          "type": "executable",
+          "sources": [
+            "bench/linkaudio_bench.cc"
+          ],
+          "include_dirs": [
+            "src/wrapper",
+            "link/include",
+            "link/extensions/abl_link/include",
+            "link/modules/asio-standalone/asio/include"
+          ],
+          "cflags!": [ "-fno-exceptions" ],
+          "cflags_cc!": [ "-fno-exceptions" ],
+          "cflags_cc": [ "-std=c++17" ],
+          "defines": [ "ASIO_STANDALONE=1" ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+                "CLANG_CXX_LIBRARY": "libc++",
+                "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+                "MACOSX_DEPLOYMENT_TARGET": "10.11"
+              },
+              "defines": [ "LINK_PLATFORM_MACOSX=1" ]
+            }],
+            ["OS=='win'", {
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "ExceptionHandling": 1,
+                  "AdditionalOptions": [ "/std:c++17" ]
+                }
+              },
+              "defines": [
+                "LINK_PLATFORM_WINDOWS=1",
+                "_WIN32_WINNT=0x0601"
+              ]
+            }],
+            ["OS=='linux'", {
+              "cflags_cc": [ "-std=c++17", "-pthread" ],
+              "ldflags": [ "-pthread" ],
+              "defines": [ "LINK_PLATFORM_LINUX=1" ]
+            }]
+          ]
+        }
+      ]
+    }]
   ]
 }
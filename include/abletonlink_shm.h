@@ -0,0 +1,177 @@
+/*
+ * Reader for the Link state published by AbletonLinkStatePublisher.
+ *
+ * Header-only C99 (also valid C++). Link with -lrt on older glibc. Include it
+ * before other system headers, or define _POSIX_C_SOURCE yourself, when
+ * building with -std=c99.
+ *
+ *     const lkshm_state* shm = lkshm_open("/ableton-link");
+ *     lkshm_snapshot s;
+ *     if (shm && lkshm_read(shm, &s) == 0) {
+ *         double beat = lkshm_beat_at(&s, lkshm_now_us(&s));
+ *     }
+ *     lkshm_close(shm);
+ *
+ * Segment layout (128 bytes, native byte order, all offsets in bytes):
+ *
+ *     0   uint32  magic            0x4D534B4C ("LKSM" in little-endian memory)
+ *     4   uint32  version          LKSHM_VERSION
+ *     8   uint32  size             sizeof(lkshm_state)
+ *     12  uint32  reserved
+ *     16  uint64  sequence         seqlock counter, odd while being written
+ *     24  int64   time_us          Link clock time of the snapshot
+ *     32  int64   clock_offset_us  Link clock minus LKSHM_CLOCK, in us
+ *     40  double  tempo            BPM
+ *     48  double  beat             beat at time_us for quantum
+ *     56  double  quantum
+ *     64  int64   time_for_is_playing_us
+ *     72  uint32  is_playing
+ *     76  uint32  num_peers
+ *     80  uint32  active           0 once the publisher has closed
+ *     84  uint32  reserved
+ *     88  40 bytes reserved
+ *
+ * The publisher rewrites bytes 24-87 under the seqlock every intervalMs
+ * (default 2 ms). Between updates the timeline is linear, so
+ * beat(t) = beat + (t - time_us) * tempo / 60e6.
+ *
+ * A publisher that crashes never clears active. Readers should treat a
+ * snapshot whose lkshm_age_us() stays well above intervalMs as stale.
+ */
+#ifndef ABLETONLINK_SHM_H
+#define ABLETONLINK_SHM_H
+
+/* shm_open, clock_gettime and ftruncate are POSIX, not ISO C. */
+#if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LKSHM_MAGIC 0x4D534B4Cu
+#define LKSHM_VERSION 1u
+
+/* lkshm_read results */
+#define LKSHM_OK 0
+#define LKSHM_CLOSED (-1)
+#define LKSHM_BUSY (-2)
+
+/* Attempts lkshm_read makes before giving up on an odd or changing
+ * sequence. A snapshot copy takes nanoseconds; this only runs out when the
+ * publisher died or stalled mid-write. */
+#ifndef LKSHM_READ_RETRIES
+#define LKSHM_READ_RETRIES 100000
+#endif
+
+/* Local clock the offset is relative to; it ticks with the Link clock. */
+#if defined(__APPLE__)
+#define LKSHM_CLOCK CLOCK_UPTIME_RAW
+#elif defined(CLOCK_MONOTONIC_RAW)
+#define LKSHM_CLOCK CLOCK_MONOTONIC_RAW
+#else
+#define LKSHM_CLOCK CLOCK_MONOTONIC
+#endif
+
+typedef struct lkshm_snapshot {
+    int64_t time_us;
+    int64_t clock_offset_us;
+    double tempo;
+    double beat;
+    double quantum;
+    int64_t time_for_is_playing_us;
+    uint32_t is_playing;
+    uint32_t num_peers;
+    uint32_t active;
+    uint32_t reserved;
+} lkshm_snapshot;
+
+typedef struct lkshm_state {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t reserved;
+    uint64_t sequence;
+    lkshm_snapshot snapshot;
+    uint64_t reserved_tail[5];
+} lkshm_state;
+
+static inline int64_t lkshm_clock_us(void) {
+    struct timespec ts;
+    clock_gettime(LKSHM_CLOCK, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + (int64_t)ts.tv_nsec / 1000;
+}
+
+/* Maps a published segment read-only. Returns NULL if it is missing or
+ * incompatible. */
+static inline const lkshm_state* lkshm_open(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    void* map = mmap(NULL, sizeof(lkshm_state), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    const lkshm_state* state = (const lkshm_state*)map;
+    if (state->magic != LKSHM_MAGIC || state->version != LKSHM_VERSION ||
+        state->size != sizeof(lkshm_state)) {
+        munmap(map, sizeof(lkshm_state));
+        return NULL;
+    }
+    return state;
+}
+
+static inline void lkshm_close(const lkshm_state* state) {
+    if (state) {
+        munmap((void*)state, sizeof(lkshm_state));
+    }
+}
+
+/* Copies a consistent snapshot. Returns LKSHM_OK; LKSHM_CLOSED if the
+ * publisher has closed (reopen the segment by name to follow a new one); or
+ * LKSHM_BUSY if no consistent copy was seen within LKSHM_READ_RETRIES, in
+ * which case *out is unspecified. */
+static inline int lkshm_read(const lkshm_state* state, lkshm_snapshot* out) {
+    long attempt;
+    for (attempt = 0; attempt < LKSHM_READ_RETRIES; ++attempt) {
+        uint64_t begin = __atomic_load_n(&state->sequence, __ATOMIC_ACQUIRE);
+        if (begin & 1u) {
+            continue;
+        }
+        memcpy(out, (const void*)&state->snapshot, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&state->sequence, __ATOMIC_RELAXED) == begin) {
+            return out->active ? LKSHM_OK : LKSHM_CLOSED;
+        }
+    }
+    return LKSHM_BUSY;
+}
+
+/* Current Link clock time in this process. */
+static inline int64_t lkshm_now_us(const lkshm_snapshot* s) {
+    return lkshm_clock_us() + s->clock_offset_us;
+}
+
+/* How long ago the snapshot was published. */
+static inline int64_t lkshm_age_us(const lkshm_snapshot* s) {
+    return lkshm_now_us(s) - s->time_us;
+}
+
+static inline double lkshm_beat_at(const lkshm_snapshot* s, int64_t time_us) {
+    return s->beat + (double)(time_us - s->time_us) * s->tempo / 60e6;
+}
+
+/* quantum should divide the published quantum. */
+static inline double lkshm_phase_at(const lkshm_snapshot* s, int64_t time_us, double quantum) {
+    double beat = lkshm_beat_at(s, time_us);
+    double phase = beat - quantum * (double)(int64_t)(beat / quantum);
+    return phase < 0.0 ? phase + quantum : phase;
+}
+
+#endif /* ABLETONLINK_SHM_H */
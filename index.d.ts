@@ -79,6 +79,22 @@ export declare class AbletonLink {
    */
   getTimeForBeat(beat: number, quantum: number): number;
 
+  /**
+   * Capture tempo, beat, phase, peers and playing state from a single session
+   * state snapshot, so all values are mutually consistent.
+   * @param quantum The quantum used for the phase
+   * @param out Optional Float64Array (length >= 5) to write into, laid out as
+   *   [tempo, beat, phase, peers, playing (0 or 1)]; see `LinkStateIndex`
+   * @returns A LinkState object, or `out` when it was provided
+   */
+  getState(quantum: number): LinkState;
+  getState(quantum: number, out: Float64Array): Float64Array;
+
+  /**
+   * Callback and allocation counters; see `LinkStats`
+   */
+  getStats(): LinkStats;
+
   /**
    * Close the Link instance and release resources
    */
@@ -99,20 +115,32 @@ export declare class AbletonLink {
   /**
    * Set a callback to be notified when the number of peers changes
    * @param callback Function called with the new peer count
+   * @param options See CallbackOptions
    */
-  setNumPeersCallback(callback: (numPeers: number) => void): void;
+  setNumPeersCallback(
+    callback: (numPeers: number, changes?: number) => void,
+    options?: CallbackOptions
+  ): void;
 
   /**
    * Set a callback to be notified when the tempo changes
    * @param callback Function called with the new tempo in BPM
+   * @param options See CallbackOptions
    */
-  setTempoCallback(callback: (tempo: number) => void): void;
+  setTempoCallback(
+    callback: (tempo: number, changes?: number) => void,
+    options?: CallbackOptions
+  ): void;
 
   /**
    * Set a callback to be notified when the play/stop state changes
    * @param callback Function called with the new playing state
+   * @param options See CallbackOptions
    */
-  setStartStopCallback(callback: (isPlaying: boolean) => void): void;
+  setStartStopCallback(
+    callback: (isPlaying: boolean, changes?: number) => void,
+    options?: CallbackOptions
+  ): void;
 
   /**
    * Request a specific beat to occur at a specific time with quantization
@@ -177,6 +205,27 @@ export interface LinkAudioChannel {
   peerName: string;
 }
 
+/**
+ * Channel changes passed to a channelsChanged callback registered with
+ * { diff: true }, relative to the previous diff
+ */
+export interface LinkAudioChannelDiff {
+  added: LinkAudioChannel[];
+  removed: LinkAudioChannel[];
+  /** Channels whose name or peer name changed */
+  renamed: LinkAudioChannel[];
+}
+
+/**
+ * Lookup criteria for findChannels(); all given fields must match
+ */
+export interface LinkAudioChannelQuery {
+  id?: LinkAudioId;
+  name?: string;
+  /** Peer ID or peer name */
+  peer?: string;
+}
+
 /**
  * LinkAudio buffer info for received audio
  */
@@ -219,6 +268,65 @@ export declare class AbletonLinkAudioSink {
   requestMaxNumSamples(numSamples: number): void;
   maxNumSamples(): number;
   retainBuffer(): AbletonLinkAudioSinkBufferHandle | null;
+  getStats(): LinkAudioSinkStats;
+  /**
+   * Release the sink. Its channel leaves the session once transports, mix
+   * buses and retained buffer handles using it are released as well.
+   */
+  close(): void;
+}
+
+export interface AbletonLinkAudioTransportOptions {
+  /** Launch quantum in beats (default 4) */
+  quantum?: number;
+  /** Frames committed per buffer (default 512) */
+  framesPerBuffer?: number;
+  /** How far ahead of the Link clock buffers are committed (default 20) */
+  leadMs?: number;
+  /** Loop the clip while the session plays (default true) */
+  loop?: boolean;
+}
+
+export interface AbletonLinkAudioTransportStatus {
+  running: boolean;
+  playing: boolean;
+  launchBeat: number;
+  /** Link clock time (seconds) of the first clip sample */
+  launchTime: number;
+  /** Link clock time (seconds) output is silenced from, null while playing */
+  stopTime: number | null;
+  framesCommitted: number;
+  buffersDropped: number;
+}
+
+/**
+ * Native quantized transport for a sink. Follows the session play state and
+ * starts the clip at the exact sample of the next quantum boundary, stopping
+ * at the sample the session stops.
+ */
+export declare class AbletonLinkAudioTransport {
+  constructor(
+    link: AbletonLinkAudio,
+    sink: AbletonLinkAudioSink,
+    options?: AbletonLinkAudioTransportOptions
+  );
+  setClip(samples: Int16Array, numChannels: number, sampleRate: number): void;
+  start(): void;
+  stop(): void;
+  status(): AbletonLinkAudioTransportStatus;
+  close(): void;
+}
+
+export interface AbletonLinkAudioSourceOptions {
+  /**
+   * Delay each buffer to its beat time plus the largest latency among the
+   * aligned sources of the same AbletonLinkAudio, so they arrive together
+   */
+  align?: boolean;
+  /** Smallest latency this source asks its alignment group for (default 0) */
+  targetLatencyMs?: number;
+  /** Quantum used to place buffers on the local timeline (default 4) */
+  quantum?: number;
 }
 
 /**
@@ -228,9 +336,306 @@ export declare class AbletonLinkAudioSource {
   constructor(
     link: AbletonLinkAudio,
     channelId: LinkAudioId,
-    callback: (buffer: { samples: Buffer; info: AbletonLinkAudioBufferInfo }) => void
+    callback: (buffer: { samples: Buffer; info: AbletonLinkAudioBufferInfo }) => void,
+    options?: AbletonLinkAudioSourceOptions
   );
   id(): LinkAudioId | null;
+  getStats(): LinkAudioSourceStats;
+  close(): void;
+}
+
+export interface LinkAudioArchiveInfo {
+  numChannels: number;
+  sampleRate: number;
+  /** Quantum the beat positions were computed with */
+  quantum: number;
+  numBlocks: number;
+  numFrames: number;
+  /** Beat range covered by the archive, null while it is empty */
+  firstBeat: number | null;
+  lastBeat: number | null;
+}
+
+export interface AbletonLinkAudioArchiveWriterStatus extends LinkAudioArchiveInfo {
+  recording: boolean;
+  path: string;
+  bytesWritten: number;
+  /** Buffers lost to a full queue or a failed write */
+  buffersDropped: number;
+  /** Buffers with no beat position in this session or a different format */
+  buffersSkipped: number;
+  writeFailed: boolean;
+}
+
+/**
+ * Records a channel's PCM and beat positions to a seekable archive. The
+ * index is written by close(), which also runs when the writer is collected.
+ */
+export declare class AbletonLinkAudioArchiveWriter {
+  constructor(
+    link: AbletonLinkAudio,
+    channelId: LinkAudioId,
+    path: string,
+    options?: { quantum?: number }
+  );
+  status(): AbletonLinkAudioArchiveWriterStatus;
+  close(): void;
+}
+
+export interface AbletonLinkAudioArchivePlayerOptions {
+  /** Launch quantum in beats (default: the archive's quantum) */
+  quantum?: number;
+  /** Frames committed per buffer (default 512) */
+  framesPerBuffer?: number;
+  /** How far ahead of the Link clock buffers are committed (default 20) */
+  leadMs?: number;
+}
+
+export interface AbletonLinkAudioArchivePlayerStatus {
+  running: boolean;
+  playing: boolean;
+  /** True once playback has run past the last block */
+  ended: boolean;
+  /** Session beat the seek position was launched at */
+  launchBeat: number;
+  launchTime: number;
+  /** Archive beat of the next frame to play */
+  position: number | null;
+  framesCommitted: number;
+  buffersDropped: number;
+  /** Re-seeks after playback drifted from the session by more than a buffer */
+  resyncs: number;
+}
+
+/**
+ * Streams an archive into a sink, aligned to the live session's beat
+ * timeline. seek() is a binary search of the on-disk index; start() launches
+ * the seek position on the next quantum boundary.
+ */
+export declare class AbletonLinkAudioArchivePlayer {
+  constructor(
+    link: AbletonLinkAudio,
+    sink: AbletonLinkAudioSink,
+    path: string,
+    options?: AbletonLinkAudioArchivePlayerOptions
+  );
+  info(): LinkAudioArchiveInfo;
+  /** Returns the first archive beat that will sound, or null past the end */
+  seek(beat: number): number | null;
+  start(): void;
+  stop(): void;
+  status(): AbletonLinkAudioArchivePlayerStatus;
+  close(): void;
+}
+
+export interface AbletonLinkAudioMixBusOptions {
+  /** Bus channels, 1 or 2 (default 2) */
+  numChannels?: number;
+  /** Bus and input sample rate (default 48000) */
+  sampleRate?: number;
+  /** Clip launch quantum in beats (default 4) */
+  quantum?: number;
+  /** Frames committed per buffer (default 512) */
+  framesPerBuffer?: number;
+  /** How far ahead of the Link clock buffers are committed (default 20) */
+  leadMs?: number;
+}
+
+export interface AbletonLinkAudioMixBusInputOptions {
+  /** Linear gain (default 1) */
+  gain?: number;
+  /** -1 (left) to 1 (right), default 0 */
+  pan?: number;
+}
+
+export interface AbletonLinkAudioMixBusInputStatus {
+  id: number;
+  type: 'clip' | 'stream';
+  numChannels: number;
+  gain: number;
+  pan: number;
+  /** Streams only: frames written but not yet mixed */
+  bufferedFrames?: number;
+  /** Streams only: buffers that ran out of written frames */
+  underruns?: number;
+}
+
+export interface AbletonLinkAudioMixBusStatus {
+  running: boolean;
+  framesCommitted: number;
+  buffersDropped: number;
+  /** Output samples saturated to the int16 range */
+  clippedSamples: number;
+  inputs: AbletonLinkAudioMixBusInputStatus[];
+  /** Removed inputs still fading out */
+  removingInputs: number;
+}
+
+/**
+ * Sums clips and JS-fed streams into a sink from a native thread, with
+ * per-input gain and pan ramps. Mono inputs use equal-power panning; stereo
+ * inputs use balance.
+ */
+export declare class AbletonLinkAudioMixBus {
+  constructor(
+    link: AbletonLinkAudio,
+    sink: AbletonLinkAudioSink,
+    options?: AbletonLinkAudioMixBusOptions
+  );
+  /** Adds a clip that launches on the next quantum boundary. Returns its id */
+  addClip(
+    samples: Int16Array,
+    numChannels: number,
+    options?: AbletonLinkAudioMixBusInputOptions & { loop?: boolean }
+  ): number;
+  /** Adds an input fed by write(). Returns its id */
+  addStream(
+    numChannels: number,
+    options?: AbletonLinkAudioMixBusInputOptions & { capacityFrames?: number }
+  ): number;
+  /** Queues interleaved frames on a stream. Returns the number of frames accepted */
+  write(id: number, samples: Int16Array): number;
+  setGain(id: number, gain: number, rampMs?: number): boolean;
+  setPan(id: number, pan: number, rampMs?: number): boolean;
+  /** Fades an input out over rampMs (default 10) and removes it */
+  removeInput(id: number, rampMs?: number): boolean;
+  start(): void;
+  stop(): void;
+  status(): AbletonLinkAudioMixBusStatus;
+  close(): void;
+}
+
+export interface AbletonLinkAudioTempoTrackerOptions {
+  /** Quantum used to place beats on the session timeline (default 4) */
+  quantum?: number;
+  /** Tempo search range (default 70-180) */
+  minBpm?: number;
+  maxBpm?: number;
+  /** How quickly old onsets are forgotten, in seconds (default 8) */
+  halfLifeSec?: number;
+  /** How often the estimate is evaluated and reported (default 500) */
+  intervalMs?: number;
+  /** Commit confident estimates to the session tempo (default false) */
+  commit?: boolean;
+  /** Confidence required before committing (default 0.5) */
+  minConfidence?: number;
+}
+
+export interface LinkAudioTempoEstimate {
+  /** Estimated tempo, or null until enough audio has been heard */
+  tempo: number | null;
+  /** 0 to 1: how periodic the onsets are at that tempo */
+  confidence: number;
+  /** Link clock time in seconds, as getClockTime(), of the most recent detected beat */
+  beatTime: number | null;
+  /** Session beat at beatTime */
+  beat: number | null;
+  /** Offset of the detected beat from the nearest session beat, -0.5 to 0.5 */
+  phase: number | null;
+}
+
+export interface AbletonLinkAudioTempoTrackerStatus extends LinkAudioTempoEstimate {
+  running: boolean;
+  commitEnabled: boolean;
+  buffersAnalyzed: number;
+  onsetFrames: number;
+  /** Tempo changes committed to the session */
+  commits: number;
+}
+
+/**
+ * Estimates the tempo and beat phase of a received channel from its onsets,
+ * analyzing each buffer natively as it arrives. Optionally proposes the
+ * estimate to the session as its tempo.
+ */
+export declare class AbletonLinkAudioTempoTracker {
+  constructor(
+    link: AbletonLinkAudio,
+    channelId: string,
+    callback?: ((estimate: LinkAudioTempoEstimate & { committed: boolean }) => void) | null,
+    options?: AbletonLinkAudioTempoTrackerOptions
+  );
+  status(): AbletonLinkAudioTempoTrackerStatus;
+  setCommitEnabled(enabled: boolean): void;
+  close(): void;
+}
+
+export interface TempoEstimateOptions {
+  /** Tempo search range (default 70-180) */
+  minBpm?: number;
+  maxBpm?: number;
+  /** How quickly old onsets are forgotten, in seconds (default 8) */
+  halfLifeSec?: number;
+}
+
+export interface OfflineTempoEstimate {
+  /** Estimated tempo, or null if the audio is too short or has no onsets */
+  tempo: number | null;
+  /** 0 to 1: how periodic the onsets are at that tempo */
+  confidence: number;
+  /** The most recent detected beat, in seconds from the first sample */
+  beatTime: number | null;
+}
+
+/**
+ * Estimates the tempo and beat position of interleaved int16 audio with the
+ * detector AbletonLinkAudioTempoTracker uses. Onsets are sampled at about
+ * 100 Hz, so expect tempo within a few tenths of a BPM and beats within 10 ms.
+ */
+export declare function estimateTempo(
+  samples: Int16Array,
+  numChannels: number,
+  sampleRate: number,
+  options?: TempoEstimateOptions
+): OfflineTempoEstimate;
+
+export interface AbletonLinkAudioSpectrumAnalyzerOptions {
+  /** Power of two from 64 to 32768 (default 2048) */
+  fftSize?: number;
+  window?: 'hann' | 'hamming' | 'blackman' | 'rectangular';
+  /** Fraction of each FFT frame shared with the next, 0 to <1 (default 0.5) */
+  overlap?: number;
+  /** Number of log-spaced bands (default 32) */
+  bands?: number;
+  /** Band range (default 20-20000, limited to Nyquist) */
+  minHz?: number;
+  maxHz?: number;
+  /** Spectra delivered per second (default 60) */
+  rateHz?: number;
+  /**
+   * Band power in dB (default) or linear magnitude. A full-scale sine reads
+   * 0 dB (1) in a band wide enough to hold the window's main lobe.
+   */
+  scale?: 'db' | 'linear';
+}
+
+export interface AbletonLinkAudioSpectrumAnalyzerStatus {
+  running: boolean;
+  /** Channel sample rate, or null before the first buffer */
+  sampleRate: number | null;
+  fftSize: number;
+  bands: number;
+  buffersAnalyzed: number;
+  framesAnalyzed: number;
+  spectraDelivered: number;
+}
+
+/**
+ * Computes log-band spectra of a received channel natively. Each delivered
+ * spectrum averages every FFT frame since the previous one.
+ */
+export declare class AbletonLinkAudioSpectrumAnalyzer {
+  constructor(
+    link: AbletonLinkAudio,
+    channelId: string,
+    callback?: ((bands: Float32Array) => void) | null,
+    options?: AbletonLinkAudioSpectrumAnalyzerOptions
+  );
+  /** Latest spectrum, or null before the first FFT frame */
+  getSpectrum(): Float32Array | null;
+  /** bands + 1 band edges in Hz */
+  bandFrequencies(): Float32Array;
+  status(): AbletonLinkAudioSpectrumAnalyzerStatus;
   close(): void;
 }
 
@@ -286,22 +691,79 @@ export declare class AbletonLinkAudio {
   ): void;
   timeForIsPlaying(): number;
   getClockTime(): number;
+  getState(quantum: number): LinkState;
+  getState(quantum: number, out: Float64Array): Float64Array;
+  getStats(): LinkAudioStats;
 
   isLinkAudioEnabled(): boolean;
   enableLinkAudio(enabled: boolean): void;
   setPeerName(name: string): void;
+  /**
+   * Called with no arguments whenever the channel list changes. With
+   * `{ diff: true }` it receives the added, removed and renamed channels
+   * instead, and notifications that change nothing are dropped.
+   */
   setChannelsChangedCallback(callback: () => void): void;
+  setChannelsChangedCallback(
+    callback: (diff: LinkAudioChannelDiff) => void,
+    options: { diff: true }
+  ): void;
   channels(): LinkAudioChannel[];
+  findChannels(query: LinkAudioChannelQuery): LinkAudioChannel[];
   callOnLinkThread(callback: () => void): void;
+  /**
+   * Queue a hop through the Link thread on the instance's persistent task
+   * queue. Resolves, in submission order, with the return value of `callback`
+   * (run on the JS thread once the Link thread has reached the task).
+   */
+  runOnLinkThread<T = void>(callback?: () => T): Promise<T>;
+  /**
+   * Publish this instance for worker threads and return its key. Workers call
+   * AbletonLinkAudio.attach(key) to get a handle to the same Link peer.
+   */
+  share(): string;
+  /**
+   * Handle to an instance shared by another thread. Sinks, sources and session
+   * state calls go to the shared peer; Link callbacks stay with the owner.
+   * The peer leaves the session once the owner and all handles are closed.
+   */
+  static attach(key: string): AbletonLinkAudio;
+  isAttached(): boolean;
 
   captureAppSessionState(): AbletonLinkAudioSessionState;
   commitAppSessionState(sessionState: AbletonLinkAudioSessionState): void;
   captureAudioSessionState(): AbletonLinkAudioSessionState;
   commitAudioSessionState(sessionState: AbletonLinkAudioSessionState): void;
+  /**
+   * Overwrite an existing session state in place instead of allocating a new one.
+   * @returns The same session state object
+   */
+  captureAppSessionStateInto(
+    sessionState: AbletonLinkAudioSessionState
+  ): AbletonLinkAudioSessionState;
+  captureAudioSessionStateInto(
+    sessionState: AbletonLinkAudioSessionState
+  ): AbletonLinkAudioSessionState;
 
-  setNumPeersCallback(callback: (numPeers: number) => void): void;
-  setTempoCallback(callback: (tempo: number) => void): void;
-  setStartStopCallback(callback: (isPlaying: boolean) => void): void;
+  setNumPeersCallback(
+    callback: (numPeers: number, changes?: number) => void,
+    options?: CallbackOptions
+  ): void;
+  setTempoCallback(
+    callback: (tempo: number, changes?: number) => void,
+    options?: CallbackOptions
+  ): void;
+  setStartStopCallback(
+    callback: (isPlaying: boolean, changes?: number) => void,
+    options?: CallbackOptions
+  ): void;
+  /**
+   * Receive every peer, tempo, start/stop and channel notification through a
+   * single batched stream of [type, timeSec, value] triplets (see LinkEventType).
+   * timeSec is the Link clock time the event was recorded at. Pass null to stop.
+   * The on* helpers share the same stream and are unaffected by this call.
+   */
+  setEventCallback(callback: ((events: Float64Array) => void) | null): void;
 
   close(): void;
 
@@ -318,12 +780,132 @@ export declare class AbletonLinkAudio {
   }): Promise<{ enabled: boolean; peers: number; startStopOk: boolean }>;
 }
 
+/**
+ * Native Link-clock scheduler. A dedicated thread sleeps on the Link clock and
+ * delivers due events in batches as a Float64Array of [id, timeSec, beat]
+ * triplets (beat is NaN for time-domain events).
+ */
+export declare class AbletonLinkScheduler {
+  constructor(
+    link: AbletonLink | AbletonLinkAudio,
+    dispatch: (events: Float64Array) => void,
+    options?: { coarseMs?: number }
+  );
+  now(): number;
+  /**
+   * Schedule an event at a Link clock time
+   * @param timeSec Link clock time in seconds
+   * @param periodSec Repeat period in seconds (0 for a one-shot event)
+   * @returns Event id passed back to the dispatch callback
+   */
+  scheduleAt(timeSec: number, periodSec?: number): number;
+  /**
+   * Schedule an event at a session beat. Its deadline is re-derived natively
+   * whenever the tempo or timeline changes.
+   * @param beat Beat position, phase-aligned to quantum
+   * @param quantum The quantum for the beat position
+   * @param periodBeats Repeat period in beats (0 for a one-shot event)
+   */
+  scheduleAtBeat(beat: number, quantum: number, periodBeats?: number): number;
+  /**
+   * Schedule an event on every multiple of periodBeats, from the next boundary
+   * @param quantum Defaults to periodBeats
+   */
+  scheduleEveryBeats(periodBeats: number, quantum?: number): number;
+  cancel(id: number): void;
+  start(): void;
+  stop(): void;
+  close(): void;
+}
+
+/**
+ * 24-PPQN MIDI clock driven by the Link timeline. Pulses and start, stop,
+ * continue and song-position messages are sent from a native thread at their
+ * Link times, as raw bytes to `fd` and/or as batches of [timeSec, status, value]
+ * triplets to the callback (value is the song position for 0xF2, else 0).
+ */
+export declare class AbletonLinkMidiClock {
+  constructor(
+    link: AbletonLink | AbletonLinkAudio,
+    onEvents: ((events: Float64Array) => void) | null,
+    options?: {
+      /**
+       * File descriptor (pipe, FIFO, device) that receives raw MIDI bytes. It is
+       * non-blocking while the clock runs and restored by stop(); messages that
+       * do not fit are dropped whole.
+       */
+      fd?: number;
+      /** Quantum used to place the beat grid (default 4) */
+      quantum?: number;
+      coarseMs?: number;
+      /** Keep sending clock pulses while the session is stopped (default true) */
+      clockWhileStopped?: boolean;
+    }
+  );
+  start(): void;
+  stop(): void;
+  isRunning(): boolean;
+  /** Messages written to and dropped at `fd` */
+  status(): { running: boolean; written: number; dropped: number };
+  close(): void;
+}
+
+export interface AbletonLinkStatePublisherStatus {
+  /** Segment name, with its leading '/' */
+  name: string;
+  active: boolean;
+  /** Seqlock counter; two per published snapshot */
+  sequence: number;
+}
+
+/**
+ * Publishes the timeline and transport state into a POSIX shared-memory
+ * segment (/dev/shm on Linux) for other local processes. The binary layout and
+ * a header-only C reader are in include/abletonlink_shm.h. Not available on
+ * Windows. Throws if another publisher is still updating a segment of the same
+ * name; closed or stale segments are taken over.
+ */
+export declare class AbletonLinkStatePublisher {
+  constructor(
+    link: AbletonLink | AbletonLinkAudio,
+    name: string,
+    options?: {
+      /** Quantum the published beat is aligned to (default 4) */
+      quantum?: number;
+      /** Publish period (default 2) */
+      intervalMs?: number;
+    }
+  );
+  status(): AbletonLinkStatePublisherStatus;
+  /** Marks the segment inactive and unlinks it */
+  close(): void;
+}
+
 export interface WavFileData {
   samples: Int16Array;
   numChannels: number;
   sampleRate: number;
 }
 
+export interface DecodeOptions {
+  /** TPDF dither when reducing sources wider than 16 bits (default false) */
+  dither?: boolean;
+}
+
+export interface DecodedAudio extends WavFileData {
+  /** Bits per sample in the file */
+  bitsPerSample: number;
+  sampleFormat: 'int' | 'float';
+  container: 'wav' | 'aiff';
+}
+
+/**
+ * Decode a WAV (8/16/24/32-bit integer, 32/64-bit float, including
+ * WAVE_FORMAT_EXTENSIBLE) or AIFF/AIFF-C file to interleaved int16 samples.
+ * Float input is clamped to [-1, 1]; wider integer input is rounded.
+ */
+export declare function decodeAudio(data: Uint8Array, options?: DecodeOptions): DecodedAudio;
+
 export interface WavSinkPlayer {
   sink: AbletonLinkAudioSink;
   wav: WavFileData;
@@ -351,6 +933,8 @@ export interface WavPlayerOptions {
   adaptiveLeadMaxSec?: number;
   adaptiveLeadStepSec?: number;
   adaptiveFailWindowMs?: number;
+  /** Use the native AbletonLinkScheduler thread instead of JS timers */
+  nativeScheduler?: boolean;
 }
 
 export interface LinkTimeScheduler {
@@ -372,10 +956,24 @@ export interface LinkTimeScheduler {
   stop(): void;
 }
 
+export interface NativeLinkTimeScheduler extends LinkTimeScheduler {
+  scheduleAtBeat(
+    beat: number,
+    quantum: number,
+    fn: (timeSec: number, beat: number) => void
+  ): { cancel(): void };
+  scheduleEveryBeats(
+    beats: number,
+    fn: (timeSec: number, beat: number) => void,
+    options?: { quantum?: number }
+  ): { cancel(): void };
+  close(): void;
+}
+
 export declare const linkAudioUtils: {
-  parseWav(buffer: Buffer): WavFileData;
-  readWavFile(filePath: string): Promise<WavFileData>;
-  readWavFileSync(filePath: string): WavFileData;
+  parseWav(buffer: Buffer, options?: DecodeOptions): WavFileData;
+  readWavFile(filePath: string, options?: DecodeOptions): Promise<WavFileData>;
+  readWavFileSync(filePath: string, options?: DecodeOptions): WavFileData;
   sleep(ms: number, signal?: AbortSignal): Promise<void>;
   sleepUntilLinkTime(
     link: AbletonLinkAudio,
@@ -397,6 +995,10 @@ export declare const linkAudioUtils: {
     link: AbletonLinkAudio,
     options?: { coarseMs?: number }
   ): LinkTimeScheduler };
+  NativeLinkTimeScheduler: { new (
+    link: AbletonLink | AbletonLinkAudio,
+    options?: { coarseMs?: number }
+  ): NativeLinkTimeScheduler };
   DEFAULT_WAV_OPTIONS: Required<WavPlayerOptions>;
   createWavSinkPlayer(
     link: AbletonLinkAudio,
@@ -418,7 +1020,7 @@ export interface LinkState {
   tempo: number;
   /** Current beat position */
   beat: number;
-  /** Current phase for 4-beat quantum */
+  /** Current phase for the requested quantum */
   phase: number;
   /** Number of connected peers */
   peers: number;
@@ -426,6 +1028,176 @@ export interface LinkState {
   playing: boolean;
 }
 
+/**
+ * Log2 histogram of latencies in microseconds. `buckets[i]` counts values in
+ * [2^(i-1), 2^i); percentiles are bucket upper bounds.
+ */
+export interface LatencyHistogram {
+  count: number;
+  meanUs: number;
+  maxUs: number;
+  p50Us: number;
+  p90Us: number;
+  p99Us: number;
+  buckets: number[];
+}
+
+/**
+ * Counters for one native-to-JS callback path. `posted` is lower than `fired`
+ * when notifications are coalesced or batched; `queueDepth` is posted minus
+ * delivered. Latency runs from queueing on the native thread to the JS call.
+ */
+export interface CallbackStats {
+  fired: number;
+  posted: number;
+  delivered: number;
+  dropped: number;
+  queueDepth: number;
+  latency: LatencyHistogram;
+}
+
+export interface LinkStats {
+  callbacks: { numPeers: CallbackStats; tempo: CallbackStats; startStop: CallbackStats };
+  /** Calls that wrote into a caller-owned object instead of allocating one */
+  allocationsAvoided: number;
+}
+
+export interface LinkAudioStats {
+  callbacks: {
+    numPeers: CallbackStats;
+    tempo: CallbackStats;
+    startStop: CallbackStats;
+    channels: CallbackStats;
+    events: CallbackStats;
+  };
+  allocationsAvoided: number;
+}
+
+export interface LinkAudioSinkStats {
+  buffersRetained: number;
+  retainFailures: number;
+  commits: number;
+  commitFailures: number;
+  bytesCommitted: number;
+  /** Commits per second since the previous getStats() call */
+  buffersPerSec: number;
+}
+
+export interface LinkAudioSourceStats {
+  buffers: CallbackStats;
+  /** Bytes copied into JS Buffers */
+  bytesCopied: number;
+  /** Buffers delivered per second since the previous getStats() call */
+  buffersPerSec: number;
+  /**
+   * Arrival time minus the local time of each buffer's first beat. Values are
+   * null until a buffer from the local session arrives
+   */
+  latency: {
+    count: number;
+    lastMs: number | null;
+    smoothedMs: number | null;
+    jitterMs: number | null;
+  };
+  /** Null unless created with { align: true } */
+  alignment: {
+    /** Common delay from beat time to delivery */
+    targetMs: number;
+    buffersDelayed: number;
+    /** Buffers that arrived after their aligned delivery time */
+    buffersLate: number;
+  } | null;
+}
+
+/**
+ * Offsets of each LinkState field in the Float64Array filled by getState()
+ */
+export declare const LinkStateIndex: {
+  readonly tempo: 0;
+  readonly beat: 1;
+  readonly phase: 2;
+  readonly peers: 3;
+  readonly playing: 4;
+  readonly length: 5;
+};
+
+/**
+ * Event type codes in the AbletonLinkAudio event stream. Values are the peer
+ * count, the tempo, 1/0 for playing/stopped, and 0 for channel changes.
+ */
+export declare const LinkEventType: {
+  readonly peers: 0;
+  readonly tempo: 1;
+  readonly startStop: 2;
+  readonly channels: 3;
+};
+
+/**
+ * MIDI status bytes reported by AbletonLinkMidiClock
+ */
+export declare const MidiClockStatus: {
+  readonly clock: 0xf8;
+  readonly start: 0xfa;
+  readonly continue: 0xfb;
+  readonly stop: 0xfc;
+  readonly songPosition: 0xf2;
+};
+
+/**
+ * Scheduling applied to the addon's native threads (Link, scheduler,
+ * transport, MIDI clock). Linux only.
+ */
+export interface ThreadPolicyOptions {
+  policy?: 'fifo' | 'rr' | 'other';
+  /** Real-time priority for 'fifo' and 'rr', clamped to the system range */
+  priority?: number;
+  /** CPU indices the threads may run on; an empty array allows every CPU */
+  cpuAffinity?: number[];
+  /** Lock the process's memory with mlockall (false unlocks it) */
+  mlock?: boolean;
+}
+
+export interface ThreadPolicyReport {
+  supported: boolean;
+  /** One entry per live thread; threads keep default scheduling on error */
+  threads: { name: string; ok: boolean; errors: string[] }[];
+  mlock: { ok: boolean; error?: string } | null;
+}
+
+/**
+ * Apply a scheduling policy to the addon's running threads and to threads
+ * started later. Missing permissions are reported rather than thrown.
+ */
+export declare function setThreadPolicy(options: ThreadPolicyOptions): ThreadPolicyReport;
+
+/**
+ * Start recording native hot-path spans (source buffers, callback queueing and
+ * JS callbacks, sink retain/commit, session captures). Clears earlier events.
+ */
+export declare function startTrace(): void;
+
+/**
+ * Stop recording. Recorded events stay available to dumpTrace().
+ */
+export declare function stopTrace(): void;
+
+/**
+ * Recorded events as Chrome trace event JSON, loadable in Perfetto or
+ * chrome://tracing. Each thread keeps its most recent 32768 events.
+ */
+export declare function dumpTrace(): string;
+
+/**
+ * Options for the tempo, peer and start/stop callbacks
+ */
+export interface CallbackOptions {
+  /**
+   * Deliver only the latest value. The Link thread never blocks on JS and at
+   * most one call is pending; `changes` counts the updates it stands for.
+   */
+  coalesce?: boolean;
+}
+
 /**
  * Callback for peer count changes
  */
@@ -12,6 +12,21 @@ export const AbletonLinkAudioSink = addon.AbletonLinkAudioSink;
 export const AbletonLinkAudioSinkBufferHandle = addon.AbletonLinkAudioSinkBufferHandle;
 export const AbletonLinkAudioSource = addon.AbletonLinkAudioSource;
 export const AbletonLinkAudioBufferInfo = addon.AbletonLinkAudioBufferInfo;
+export const AbletonLinkScheduler = addon.AbletonLinkScheduler;
+export const AbletonLinkAudioTransport = addon.AbletonLinkAudioTransport;
+export const AbletonLinkMidiClock = addon.AbletonLinkMidiClock;
+export const AbletonLinkAudioArchiveWriter = addon.AbletonLinkAudioArchiveWriter;
+export const AbletonLinkAudioArchivePlayer = addon.AbletonLinkAudioArchivePlayer;
+export const AbletonLinkAudioMixBus = addon.AbletonLinkAudioMixBus;
+export const AbletonLinkAudioTempoTracker = addon.AbletonLinkAudioTempoTracker;
+export const AbletonLinkAudioSpectrumAnalyzer = addon.AbletonLinkAudioSpectrumAnalyzer;
+export const AbletonLinkStatePublisher = addon.AbletonLinkStatePublisher;
+export const setThreadPolicy = addon.setThreadPolicy;
+export const startTrace = addon.startTrace;
+export const stopTrace = addon.stopTrace;
+export const dumpTrace = addon.dumpTrace;
+export const decodeAudio = addon.decodeAudio;
+export const estimateTempo = addon.estimateTempo;
 export { linkAudioUtils };
 
 export interface LinkState {
@@ -22,19 +37,123 @@ export interface LinkState {
   playing: boolean;
 }
 
+export const LinkStateIndex = {
+  tempo: 0,
+  beat: 1,
+  phase: 2,
+  peers: 3,
+  playing: 4,
+  length: 5,
+} as const;
+
+export const MidiClockStatus = {
+  clock: 0xf8,
+  start: 0xfa,
+  continue: 0xfb,
+  stop: 0xfc,
+  songPosition: 0xf2,
+} as const;
+
+export const LinkEventType = {
+  peers: 0,
+  tempo: 1,
+  startStop: 2,
+  channels: 3,
+} as const;
+
 export default addon.AbletonLink;
 
+type LinkEventHandler = (value: number, timeSec: number) => void;
+
+interface LinkEventStream {
+  user: ((events: Float64Array) => void) | null;
+  byType: Map<number, Set<LinkEventHandler>>;
+  installed: boolean;
+}
+
+// The native class has a single event callback slot. It is shared between
+// setEventCallback() and the on* helpers, and only held while either needs it.
+function linkEventStream(link: any): LinkEventStream {
+  if (!link.__eventStream) {
+    link.__eventStream = { user: null, byType: new Map(), installed: false };
+  }
+  return link.__eventStream;
+}
+
+function updateLinkEventStream(link: any) {
+  const stream = linkEventStream(link);
+  let wanted = stream.user !== null;
+  for (const handlers of stream.byType.values()) {
+    wanted = wanted || handlers.size > 0;
+  }
+  if (wanted === stream.installed) return;
+  link.__setNativeEventCallback(
+    wanted
+      ? (events: Float64Array) => {
+          stream.user?.(events);
+          for (let i = 0; i + 2 < events.length; i += 3) {
+            const handlers = stream.byType.get(events[i]);
+            if (!handlers) continue;
+            for (const h of handlers) {
+              h(events[i + 2], events[i + 1]);
+            }
+          }
+        }
+      : null
+  );
+  stream.installed = wanted;
+}
+
+// Subscribes to the native batched event stream when the class provides one.
+// Returns null so callers can fall back to the per-type callbacks.
+function subscribeLinkEvent(link: any, type: number, handler: LinkEventHandler) {
+  if (typeof link.__setNativeEventCallback !== 'function') return null;
+  const stream = linkEventStream(link);
+  let handlers = stream.byType.get(type);
+  if (!handlers) {
+    handlers = new Set();
+    stream.byType.set(type, handlers);
+  }
+  handlers.add(handler);
+  updateLinkEventStream(link);
+  return () => {
+    handlers.delete(handler);
+    updateLinkEventStream(link);
+  };
+}
+
+function addEventStream(LinkClass: any) {
+  const native = LinkClass?.prototype?.setEventCallback;
+  if (typeof native !== 'function') return;
+  LinkClass.prototype.__setNativeEventCallback = native;
+  LinkClass.prototype.setEventCallback = function setEventCallback(
+    cb: ((events: Float64Array) => void) | null
+  ) {
+    if (cb !== null && typeof cb !== 'function') {
+      // Let the native method report the argument error.
+      return native.call(this, cb);
+    }
+    linkEventStream(this).user = cb;
+    updateLinkEventStream(this);
+  };
+}
+
 function addLinkHelpers(LinkClass: any) {
   if (!LinkClass || !LinkClass.prototype) return;
 
   LinkClass.prototype.onTempoChange = function onTempoChange(cb: (tempo: number) => void) {
+    const unsubscribe = subscribeLinkEvent(this, LinkEventType.tempo, cb);
+    if (unsubscribe) return unsubscribe;
     if (!this.__tempoHandlers) {
       this.__tempoHandlers = new Set();
-      this.setTempoCallback((tempo: number) => {
-        for (const handler of this.__tempoHandlers) {
-          handler(tempo);
-        }
-      });
+      this.setTempoCallback(
+        (tempo: number) => {
+          for (const handler of this.__tempoHandlers) {
+            handler(tempo);
+          }
+        },
+        { coalesce: true }
+      );
     }
     this.__tempoHandlers.add(cb);
     return () => this.__tempoHandlers.delete(cb);
@@ -43,13 +162,18 @@ function addLinkHelpers(LinkClass: any) {
   LinkClass.prototype.onPeersChange = function onPeersChange(
     cb: (numPeers: number) => void
   ) {
+    const unsubscribe = subscribeLinkEvent(this, LinkEventType.peers, cb);
+    if (unsubscribe) return unsubscribe;
     if (!this.__peersHandlers) {
       this.__peersHandlers = new Set();
-      this.setNumPeersCallback((numPeers: number) => {
-        for (const handler of this.__peersHandlers) {
-          handler(numPeers);
-        }
-      });
+      this.setNumPeersCallback(
+        (numPeers: number) => {
+          for (const handler of this.__peersHandlers) {
+            handler(numPeers);
+          }
+        },
+        { coalesce: true }
+      );
     }
     this.__peersHandlers.add(cb);
     return () => this.__peersHandlers.delete(cb);
@@ -58,6 +182,10 @@ function addLinkHelpers(LinkClass: any) {
   LinkClass.prototype.onStartStop = function onStartStop(
     cb: (isPlaying: boolean) => void
   ) {
+    const unsubscribe = subscribeLinkEvent(this, LinkEventType.startStop, (value: number) =>
+      cb(value !== 0)
+    );
+    if (unsubscribe) return unsubscribe;
     if (!this.__startStopHandlers) {
       this.__startStopHandlers = new Set();
       this.setStartStopCallback((isPlaying: boolean) => {
@@ -110,5 +238,6 @@ function addLinkHelpers(LinkClass: any) {
   };
 }
 
+addEventStream(addon.AbletonLinkAudio);
 addLinkHelpers(addon.AbletonLink);
 addLinkHelpers(addon.AbletonLinkAudio);
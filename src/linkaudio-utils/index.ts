@@ -1,5 +1,5 @@
-import { parseWav, readWavFile, readWavFileSync, type WavFileData } from './wav.ts'
-import { sleep, sleepUntilLinkTime, LinkTimeScheduler } from './scheduler.ts'
+import { parseWav, readWavFile, readWavFileSync, type DecodeOptions, type WavFileData } from './wav.ts'
+import { sleep, sleepUntilLinkTime, LinkTimeScheduler, NativeLinkTimeScheduler } from './scheduler.ts'
 import { waitForChannel } from './channel.ts'
 import { createSourceIterator } from './source.ts'
 import {
@@ -10,7 +10,13 @@ import {
   type WavSinkPlayer,
 } from './player.ts'
 
-function callOnLinkThreadAsync(link: { callOnLinkThread: (cb: () => void) => void }) {
+function callOnLinkThreadAsync(link: {
+  callOnLinkThread: (cb: () => void) => void
+  runOnLinkThread?: () => Promise<unknown>
+}) {
+  if (typeof link.runOnLinkThread === 'function') {
+    return link.runOnLinkThread().then(() => undefined)
+  }
   return new Promise<void>((resolve) => {
     link.callOnLinkThread(() => resolve())
   })
@@ -23,12 +29,14 @@ export {
   sleep,
   sleepUntilLinkTime,
   LinkTimeScheduler,
+  NativeLinkTimeScheduler,
   waitForChannel,
   createSourceIterator,
   DEFAULT_WAV_OPTIONS,
   createWavSinkPlayer,
   playWav,
   callOnLinkThreadAsync,
+  type DecodeOptions,
   type WavFileData,
   type WavPlayerOptions,
   type WavSinkPlayer,
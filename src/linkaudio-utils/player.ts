@@ -1,7 +1,7 @@
 import path from 'path';
 // import { createRequire } from 'module';
 import { readWavFileSync,type WavFileData } from './wav.ts';
-import { LinkTimeScheduler } from './scheduler.ts';
+import { LinkTimeScheduler, NativeLinkTimeScheduler } from './scheduler.ts';
 import bindings from 'bindings'
 // const require = createRequire(import.meta.url);
 // const bindings = require('bindings') as (name: string) => any;
@@ -10,7 +10,7 @@ const addon = bindings('abletonlink') as any;
 export interface WavSinkPlayer {
   sink: any;
   wav: WavFileData;
-  scheduler: LinkTimeScheduler;
+  scheduler: LinkTimeScheduler | NativeLinkTimeScheduler;
   start: () => void;
   stop: () => void;
 }
@@ -34,6 +34,7 @@ export interface WavPlayerOptions {
   adaptiveLeadMaxSec?: number;
   adaptiveLeadStepSec?: number;
   adaptiveFailWindowMs?: number;
+  nativeScheduler?: boolean;
 }
 
 export const DEFAULT_WAV_OPTIONS: Required<WavPlayerOptions> = {
@@ -55,6 +56,7 @@ export const DEFAULT_WAV_OPTIONS: Required<WavPlayerOptions> = {
   adaptiveLeadMaxSec: 0.08,
   adaptiveLeadStepSec: 0.005,
   adaptiveFailWindowMs: 1000,
+  nativeScheduler: false,
 };
 
 export function createWavSinkPlayer(
@@ -71,9 +73,9 @@ export function createWavSinkPlayer(
   );
 
   const bufferSeconds = opts.framesPerBuffer / wav.sampleRate;
-  const scheduler = new LinkTimeScheduler(link, {
-    coarseMs: opts.schedulerCoarseMs ?? 2,
-  });
+  const scheduler = opts.nativeScheduler
+    ? new NativeLinkTimeScheduler(link, { coarseMs: opts.schedulerCoarseMs ?? 2 })
+    : new LinkTimeScheduler(link, { coarseMs: opts.schedulerCoarseMs ?? 2 });
 
   let targetLeadSec = opts.targetLeadSec ?? 0.02;
   let lowWaterSec = opts.lowWaterSec ?? 0.01;
@@ -89,6 +91,16 @@ export function createWavSinkPlayer(
   let periodic: { cancel: () => void } | null = null;
   let lastFailTimeMs = 0;
 
+  let sessionState: any = null;
+
+  function captureSessionState() {
+    if (sessionState && typeof link.captureAppSessionStateInto === 'function') {
+      return link.captureAppSessionStateInto(sessionState);
+    }
+    sessionState = link.captureAppSessionState();
+    return sessionState;
+  }
+
   let tempoCache = opts.tempo ?? referenceTempo;
   let unsubscribeTempo: (() => void) | null = null;
   if (typeof link?.onTempoChange === 'function') {
@@ -128,7 +140,7 @@ export function createWavSinkPlayer(
     const handle = sink.retainBuffer();
     if (!handle || !handle.isValid()) return false;
 
-    const sessionState = link.captureAppSessionState();
+    const sessionState = captureSessionState();
     const beatsAtBufferBegin = sessionState.beatAtTime(nextSendTime, opts.quantum);
 
     const out = handle.samples();
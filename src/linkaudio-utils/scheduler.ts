@@ -1,3 +1,6 @@
+import bindings from 'bindings'
+const addon = bindings('abletonlink') as any;
+
 export function sleep(ms: number, signal?: AbortSignal): Promise<void> {
   if (ms <= 0) return Promise.resolve();
   return new Promise((resolve, reject) => {
@@ -49,9 +52,14 @@ export class LinkTimeScheduler {
 
   private _insert(ev: { time: number; fn: (time: number) => void; cancelled: boolean }) {
     const q = this._queue;
-    let i = q.findIndex((e) => e.time > ev.time);
-    if (i === -1) i = q.length;
-    q.splice(i, 0, ev);
+    let lo = 0;
+    let hi = q.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >>> 1;
+      if (q[mid].time > ev.time) hi = mid;
+      else lo = mid + 1;
+    }
+    q.splice(lo, 0, ev);
   }
 
   scheduleAt(timeSec: number, fn: (time: number) => void) {
@@ -165,3 +173,103 @@ export class LinkTimeScheduler {
     }
   }
 }
+
+/**
+ * Same interface as LinkTimeScheduler, backed by the native AbletonLinkScheduler:
+ * a dedicated thread sleeps on the Link clock and hands due events to JS in
+ * batches, so no event-loop timers or spinning are involved.
+ */
+export class NativeLinkTimeScheduler {
+  private native: any;
+  private _handlers = new Map<
+    number,
+    { fn: (time: number, beat: number) => void; periodic: boolean }
+  >();
+
+  constructor(link: object, { coarseMs = 2 }: { coarseMs?: number } = {}) {
+    this.native = new addon.AbletonLinkScheduler(
+      link,
+      (events: Float64Array) => this._dispatch(events),
+      { coarseMs }
+    );
+  }
+
+  now(): number {
+    return this.native.now();
+  }
+
+  private _dispatch(events: Float64Array) {
+    // Native batch layout: [id, timeSec, beat] per event (beat is NaN for time events).
+    for (let i = 0; i + 2 < events.length; i += 3) {
+      const id = events[i];
+      const handler = this._handlers.get(id);
+      if (!handler) continue;
+      if (!handler.periodic) this._handlers.delete(id);
+      try {
+        handler.fn(events[i + 1], events[i + 2]);
+      } catch {
+        // swallow errors in scheduler callback
+      }
+    }
+  }
+
+  private _track(id: number, periodic: boolean, fn: (time: number, beat: number) => void) {
+    this._handlers.set(id, { fn, periodic });
+    return {
+      cancel: () => {
+        this._handlers.delete(id);
+        this.native.cancel(id);
+      },
+    };
+  }
+
+  scheduleAt(timeSec: number, fn: (time: number) => void) {
+    return this._track(this.native.scheduleAt(timeSec, 0), false, fn);
+  }
+
+  /**
+   * Fire when the session timeline reaches `beat` (phase-aligned to `quantum`).
+   * The deadline follows tempo and timeline changes natively.
+   */
+  scheduleAtBeat(beat: number, quantum: number, fn: (time: number, beat: number) => void) {
+    return this._track(this.native.scheduleAtBeat(beat, quantum), false, fn);
+  }
+
+  /**
+   * Fire on every multiple of `beats`, starting at the next boundary.
+   */
+  scheduleEveryBeats(
+    beats: number,
+    fn: (time: number, beat: number) => void,
+    { quantum = beats }: { quantum?: number } = {}
+  ) {
+    return this._track(this.native.scheduleEveryBeats(beats, quantum), true, fn);
+  }
+
+  scheduleIn(delaySec: number, fn: (time: number) => void) {
+    return this.scheduleAt(this.now() + delaySec, fn);
+  }
+
+  scheduleEvery(
+    periodSec: number,
+    fn: (time: number) => void,
+    { startAt = null }: { startAt?: number | null } = {}
+  ) {
+    const id = this.native.scheduleAt(startAt ?? this.now() + periodSec, periodSec);
+    return this._track(id, true, fn);
+  }
+
+  start() {
+    this.native.start();
+  }
+
+  stop() {
+    this.native.stop();
+    this._handlers.clear();
+  }
+
+  close() {
+    this.stop();
+    this.native.close();
+  }
+}
@@ -1,4 +1,6 @@
 import fs from 'fs';
+import bindings from 'bindings'
+const addon = bindings('abletonlink') as any;
 
 export interface WavFileData {
   samples: Int16Array;
@@ -6,12 +8,33 @@ export interface WavFileData {
   sampleRate: number;
 }
 
-export function parseWav(buffer: Buffer): WavFileData {
+export interface DecodeOptions {
+  /** TPDF dither when reducing sources wider than 16 bits (default false) */
+  dither?: boolean;
+}
+
+// Other encodings, AIFF, and data that cannot be viewed in place go through
+// the native decoder, which converts straight into a new Int16Array.
+function decodeNative(buffer: Buffer, options: DecodeOptions): WavFileData {
+  const decoded = addon.decodeAudio(buffer, options);
+  return {
+    samples: decoded.samples,
+    numChannels: decoded.numChannels,
+    sampleRate: decoded.sampleRate,
+  };
+}
+
+/**
+ * Decode a WAV or AIFF file to int16. 16-bit PCM WAV data is returned as a
+ * view of `buffer`; 8/24/32-bit integer, 32/64-bit float and AIFF data is
+ * converted natively.
+ */
+export function parseWav(buffer: Buffer, options: DecodeOptions = {}): WavFileData {
   if (
     buffer.toString('ascii', 0, 4) !== 'RIFF' ||
     buffer.toString('ascii', 8, 12) !== 'WAVE'
   ) {
-    throw new Error('Invalid WAV file');
+    return decodeNative(buffer, options);
   }
 
   let offset = 12;
@@ -48,8 +71,13 @@ export function parseWav(buffer: Buffer): WavFileData {
   if (!fmt || dataOffset < 0) {
     throw new Error('WAV missing fmt or data chunk');
   }
-  if (fmt.audioFormat !== 1 || fmt.bitsPerSample !== 16) {
-    throw new Error('Only PCM 16-bit WAV is supported');
+  if (
+    fmt.audioFormat !== 1 ||
+    fmt.bitsPerSample !== 16 ||
+    (buffer.byteOffset + dataOffset) % 2 !== 0 ||
+    dataOffset + dataSize > buffer.length
+  ) {
+    return decodeNative(buffer, options);
   }
 
   const samples = new Int16Array(
@@ -65,12 +93,15 @@ export function parseWav(buffer: Buffer): WavFileData {
   };
 }
 
-export async function readWavFile(filePath: string): Promise<WavFileData> {
+export async function readWavFile(
+  filePath: string,
+  options: DecodeOptions = {}
+): Promise<WavFileData> {
   const buffer = await fs.promises.readFile(filePath);
-  return parseWav(buffer);
+  return parseWav(buffer, options);
 }
 
-export function readWavFileSync(filePath: string): WavFileData {
+export function readWavFileSync(filePath: string, options: DecodeOptions = {}): WavFileData {
   const buffer = fs.readFileSync(filePath);
-  return parseWav(buffer);
+  return parseWav(buffer, options);
 }
@@ -1,22 +1,55 @@
 #include "abletonlink.h"
+#include "abletonlink_addon.h"
+#include "abletonlink_archive.h"
 #include "abletonlink_audio.h"
+#include "abletonlink_decode.h"
+#include "abletonlink_midiclock.h"
+#include "abletonlink_mixbus.h"
+#include "abletonlink_publisher.h"
+#include "abletonlink_scheduler.h"
+#include "abletonlink_spectrum.h"
+#include "abletonlink_state.h"
+#include "abletonlink_tempo.h"
+#include "abletonlink_thread_policy.h"
+#include "abletonlink_trace.h"
+#include "abletonlink_transport.h"
 #include <chrono>
 
 namespace {
-struct SessionStateHandle {
-    SessionStateHandle() : state(abl_link_create_session_state()) {}
-    ~SessionStateHandle() { abl_link_destroy_session_state(state); }
-    SessionStateHandle(const SessionStateHandle&) = delete;
-    SessionStateHandle& operator=(const SessionStateHandle&) = delete;
-    SessionStateHandle(SessionStateHandle&&) = delete;
-    SessionStateHandle& operator=(SessionStateHandle&&) = delete;
-
-    abl_link_session_state state;
+class AblLinkTimeline : public LinkTimeline {
+public:
+    explicit AblLinkTimeline(abl_link link)
+        : link_(link), state_(abl_link_create_session_state()) {}
+    ~AblLinkTimeline() override { abl_link_destroy_session_state(state_); }
+    AblLinkTimeline(const AblLinkTimeline&) = delete;
+    AblLinkTimeline& operator=(const AblLinkTimeline&) = delete;
+
+    std::chrono::microseconds Now() const override {
+        return std::chrono::microseconds(abl_link_clock_micros(link_));
+    }
+    void Capture() override { abl_link_capture_app_session_state(link_, state_); }
+    double Tempo() const override { return abl_link_tempo(state_); }
+    double BeatAtTime(std::chrono::microseconds time, double quantum) const override {
+        return abl_link_beat_at_time(state_, time.count(), quantum);
+    }
+    std::chrono::microseconds TimeAtBeat(double beat, double quantum) const override {
+        return std::chrono::microseconds(abl_link_time_at_beat(state_, beat, quantum));
+    }
+    bool IsPlaying() const override { return abl_link_is_playing(state_); }
+    std::chrono::microseconds TimeForIsPlaying() const override {
+        return std::chrono::microseconds(
+            static_cast<int64_t>(abl_link_time_for_is_playing(state_)));
+    }
+    std::size_t NumPeers() const override {
+        return static_cast<std::size_t>(abl_link_num_peers(link_));
+    }
+
+private:
+    abl_link link_;
+    abl_link_session_state state_;
 };
 } // namespace
 
-Napi::FunctionReference AbletonLinkWrapper::constructor;
-
 Napi::Object AbletonLinkWrapper::Init(Napi::Env env, Napi::Object exports) {
     Napi::HandleScope scope(env);
 
@@ -34,6 +67,8 @@ Napi::Object AbletonLinkWrapper::Init(Napi::Env env, Napi::Object exports) {
         InstanceMethod("isStartStopSyncEnabled", &AbletonLinkWrapper::IsStartStopSyncEnabled),
         InstanceMethod("forceBeatAtTime", &AbletonLinkWrapper::ForceBeatAtTime),
         InstanceMethod("getTimeForBeat", &AbletonLinkWrapper::GetTimeForBeat),
+        InstanceMethod("getState", &AbletonLinkWrapper::GetState),
+        InstanceMethod("getStats", &AbletonLinkWrapper::GetStats),
         InstanceMethod("close", &AbletonLinkWrapper::Close),
         InstanceMethod("requestBeatAtTime", &AbletonLinkWrapper::RequestBeatAtTime),
         InstanceMethod("requestBeatAtStartPlayingTime", &AbletonLinkWrapper::RequestBeatAtStartPlayingTime),
@@ -44,8 +79,7 @@ Napi::Object AbletonLinkWrapper::Init(Napi::Env env, Napi::Object exports) {
         InstanceMethod("setStartStopCallback", &AbletonLinkWrapper::SetStartStopCallback),
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    AddonData(env).link = Napi::Persistent(func);
 
     exports.Set("AbletonLink", func);
     return exports;
@@ -63,12 +97,28 @@ AbletonLinkWrapper::AbletonLinkWrapper(const Napi::CallbackInfo& info)
 
     double initialTempo = info[0].As<Napi::Number>().DoubleValue();
     link_ = abl_link_create(initialTempo);
+    sessionState_ = abl_link_create_session_state();
 }
 
 AbletonLinkWrapper::~AbletonLinkWrapper() {
     CloseInternal();
 }
 
+bool AbletonLinkWrapper::IsInstance(const Napi::Object& object) {
+    return object.InstanceOf(AddonData(object.Env()).link.Value());
+}
+
+std::unique_ptr<LinkTimeline> AbletonLinkWrapper::CreateTimeline() {
+    if (link_.impl == nullptr) {
+        return nullptr;
+    }
+    return std::make_unique<AblLinkTimeline>(link_);
+}
+
+LinkDependents& AbletonLinkWrapper::Dependents() {
+    return dependents_;
+}
+
 Napi::Value AbletonLinkWrapper::Enable(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
@@ -91,9 +141,8 @@ Napi::Value AbletonLinkWrapper::IsEnabled(const Napi::CallbackInfo& info) {
 Napi::Value AbletonLinkWrapper::GetTempo(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
-    double tempo = abl_link_tempo(sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
+    double tempo = abl_link_tempo(sessionState_);
     
     return Napi::Number::New(env, tempo);
 }
@@ -108,18 +157,16 @@ void AbletonLinkWrapper::SetTempo(const Napi::CallbackInfo& info) {
 
     double tempo = info[0].As<Napi::Number>().DoubleValue();
     
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
-    abl_link_set_tempo(sessionState.state, tempo, getCurrentTimeMicros());
-    abl_link_commit_app_session_state(link_, sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
+    abl_link_set_tempo(sessionState_, tempo, getCurrentTimeMicros());
+    abl_link_commit_app_session_state(link_, sessionState_);
 }
 
 Napi::Value AbletonLinkWrapper::GetBeat(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
-    double beat = abl_link_beat_at_time(sessionState.state, getCurrentTimeMicros(), 1.0);
+    abl_link_capture_app_session_state(link_, sessionState_);
+    double beat = abl_link_beat_at_time(sessionState_, getCurrentTimeMicros(), 1.0);
     
     return Napi::Number::New(env, beat);
 }
@@ -134,10 +181,9 @@ Napi::Value AbletonLinkWrapper::GetPhase(const Napi::CallbackInfo& info) {
 
     double quantum = info[0].As<Napi::Number>().DoubleValue();
     
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
     double phase =
-        abl_link_phase_at_time(sessionState.state, getCurrentTimeMicros(), quantum);
+        abl_link_phase_at_time(sessionState_, getCurrentTimeMicros(), quantum);
     
     return Napi::Number::New(env, phase);
 }
@@ -157,19 +203,17 @@ void AbletonLinkWrapper::SetIsPlaying(const Napi::CallbackInfo& info) {
 
     bool isPlaying = info[0].As<Napi::Boolean>().Value();
     
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
     abl_link_set_is_playing(
-        sessionState.state, isPlaying, static_cast<uint64_t>(getCurrentTimeMicros()));
-    abl_link_commit_app_session_state(link_, sessionState.state);
+        sessionState_, isPlaying, static_cast<uint64_t>(getCurrentTimeMicros()));
+    abl_link_commit_app_session_state(link_, sessionState_);
 }
 
 Napi::Value AbletonLinkWrapper::IsPlaying(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
-    bool isPlaying = abl_link_is_playing(sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
+    bool isPlaying = abl_link_is_playing(sessionState_);
     
     return Napi::Boolean::New(env, isPlaying);
 }
@@ -205,10 +249,9 @@ void AbletonLinkWrapper::ForceBeatAtTime(const Napi::CallbackInfo& info) {
     
     auto timeMicros = static_cast<uint64_t>(timeInSeconds * 1000000.0);
 
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
-    abl_link_force_beat_at_time(sessionState.state, beat, timeMicros, quantum);
-    abl_link_commit_app_session_state(link_, sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
+    abl_link_force_beat_at_time(sessionState_, beat, timeMicros, quantum);
+    abl_link_commit_app_session_state(link_, sessionState_);
 }
 
 Napi::Value AbletonLinkWrapper::GetTimeForBeat(const Napi::CallbackInfo& info) {
@@ -222,14 +265,47 @@ Napi::Value AbletonLinkWrapper::GetTimeForBeat(const Napi::CallbackInfo& info) {
     double beat = info[0].As<Napi::Number>().DoubleValue();
     double quantum = info[1].As<Napi::Number>().DoubleValue();
     
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
-    auto time = abl_link_time_at_beat(sessionState.state, beat, quantum);
+    abl_link_capture_app_session_state(link_, sessionState_);
+    auto time = abl_link_time_at_beat(sessionState_, beat, quantum);
 
     double timeInSeconds = static_cast<double>(time) / 1000000.0;
     return Napi::Number::New(env, timeInSeconds);
 }
 
+Napi::Value AbletonLinkWrapper::GetState(const Napi::CallbackInfo& info) {
+    double quantum = 0.0;
+    if (!ParseLinkStateArgs(info, quantum)) {
+        return info.Env().Null();
+    }
+
+    abl_link_capture_app_session_state(link_, sessionState_);
+    const auto now = getCurrentTimeMicros();
+
+    LinkStateSnapshot snapshot;
+    snapshot.tempo = abl_link_tempo(sessionState_);
+    snapshot.beat = abl_link_beat_at_time(sessionState_, now, 1.0);
+    snapshot.phase = abl_link_phase_at_time(sessionState_, now, quantum);
+    snapshot.numPeers = static_cast<double>(abl_link_num_peers(link_));
+    snapshot.isPlaying = abl_link_is_playing(sessionState_);
+    if (info.Length() > 1 && !info[1].IsUndefined()) {
+        allocationsAvoided_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return LinkStateToValue(info, snapshot);
+}
+
+Napi::Value AbletonLinkWrapper::GetStats(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    auto callbacks = Napi::Object::New(env);
+    callbacks.Set("numPeers", numPeersStats_.ToObject(env));
+    callbacks.Set("tempo", tempoStats_.ToObject(env));
+    callbacks.Set("startStop", startStopStats_.ToObject(env));
+    auto result = Napi::Object::New(env);
+    result.Set("callbacks", callbacks);
+    result.Set("allocationsAvoided",
+               static_cast<double>(allocationsAvoided_.load(std::memory_order_relaxed)));
+    return result;
+}
+
 void AbletonLinkWrapper::Close(const Napi::CallbackInfo& info) {
     CloseInternal();
 }
@@ -239,18 +315,23 @@ void AbletonLinkWrapper::CloseInternal() {
         return;
     }
 
+    dependents_.CloseAll();
+
     {
         std::lock_guard<std::mutex> lock(callbackMutex_);
         if (numPeersCallback_) {
             numPeersCallback_.Abort();
+            numPeersStats_.Aborted();
             numPeersCallback_.Release();
         }
         if (tempoCallback_) {
             tempoCallback_.Abort();
+            tempoStats_.Aborted();
             tempoCallback_.Release();
         }
         if (startStopCallback_) {
             startStopCallback_.Abort();
+            startStopStats_.Aborted();
             startStopCallback_.Release();
         }
     }
@@ -261,6 +342,8 @@ void AbletonLinkWrapper::CloseInternal() {
     abl_link_enable(link_, false);
     abl_link_destroy(link_);
     link_.impl = nullptr;
+    abl_link_destroy_session_state(sessionState_);
+    sessionState_.impl = nullptr;
 }
 
 int64_t AbletonLinkWrapper::getCurrentTimeMicros() const {
@@ -282,10 +365,9 @@ void AbletonLinkWrapper::RequestBeatAtTime(const Napi::CallbackInfo& info) {
     
     auto timeMicros = static_cast<int64_t>(timeInSeconds * 1000000.0);
 
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
-    abl_link_request_beat_at_time(sessionState.state, beat, timeMicros, quantum);
-    abl_link_commit_app_session_state(link_, sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
+    abl_link_request_beat_at_time(sessionState_, beat, timeMicros, quantum);
+    abl_link_commit_app_session_state(link_, sessionState_);
 }
 
 void AbletonLinkWrapper::RequestBeatAtStartPlayingTime(const Napi::CallbackInfo& info) {
@@ -299,10 +381,9 @@ void AbletonLinkWrapper::RequestBeatAtStartPlayingTime(const Napi::CallbackInfo&
     double beat = info[0].As<Napi::Number>().DoubleValue();
     double quantum = info[1].As<Napi::Number>().DoubleValue();
     
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
-    abl_link_request_beat_at_start_playing_time(sessionState.state, beat, quantum);
-    abl_link_commit_app_session_state(link_, sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
+    abl_link_request_beat_at_start_playing_time(sessionState_, beat, quantum);
+    abl_link_commit_app_session_state(link_, sessionState_);
 }
 
 void AbletonLinkWrapper::SetIsPlayingAndRequestBeatAtTime(const Napi::CallbackInfo& info) {
@@ -320,20 +401,18 @@ void AbletonLinkWrapper::SetIsPlayingAndRequestBeatAtTime(const Napi::CallbackIn
     
     auto timeMicros = static_cast<uint64_t>(timeInSeconds * 1000000.0);
 
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
     abl_link_set_is_playing_and_request_beat_at_time(
-        sessionState.state, isPlaying, timeMicros, beat, quantum);
-    abl_link_commit_app_session_state(link_, sessionState.state);
+        sessionState_, isPlaying, timeMicros, beat, quantum);
+    abl_link_commit_app_session_state(link_, sessionState_);
 }
 
 // Transport timing
 Napi::Value AbletonLinkWrapper::TimeForIsPlaying(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    SessionStateHandle sessionState;
-    abl_link_capture_app_session_state(link_, sessionState.state);
-    auto time = abl_link_time_for_is_playing(sessionState.state);
+    abl_link_capture_app_session_state(link_, sessionState_);
+    auto time = abl_link_time_for_is_playing(sessionState_);
     
     double timeInSeconds = static_cast<double>(time) / 1000000.0;
     return Napi::Number::New(env, timeInSeconds);
@@ -364,6 +443,7 @@ void AbletonLinkWrapper::SetNumPeersCallback(const Napi::CallbackInfo& info) {
         1
     );
     numPeersCallback_.Unref(env);
+    numPeersLatest_ = ParseCoalesceOption(info, 1);
     
     // Set the callback on the Link instance
     abl_link_set_num_peers_callback(link_, &AbletonLinkWrapper::NumPeersCallback, this);
@@ -393,6 +473,7 @@ void AbletonLinkWrapper::SetTempoCallback(const Napi::CallbackInfo& info) {
         1
     );
     tempoCallback_.Unref(env);
+    tempoLatest_ = ParseCoalesceOption(info, 1);
     
     // Set the callback on the Link instance
     abl_link_set_tempo_callback(link_, &AbletonLinkWrapper::TempoCallback, this);
@@ -422,6 +503,7 @@ void AbletonLinkWrapper::SetStartStopCallback(const Napi::CallbackInfo& info) {
         1
     );
     startStopCallback_.Unref(env);
+    startStopLatest_ = ParseCoalesceOption(info, 1);
     
     // Set the callback on the Link instance
     abl_link_set_start_stop_callback(
@@ -430,29 +512,49 @@ void AbletonLinkWrapper::SetStartStopCallback(const Napi::CallbackInfo& info) {
 
 // Callback handlers
 void AbletonLinkWrapper::handleNumPeersCallback(std::size_t numPeers) {
+    numPeersStats_.Fired();
     std::lock_guard<std::mutex> lock(callbackMutex_);
-    if (numPeersCallback_) {
-        numPeersCallback_.BlockingCall([numPeers](Napi::Env env, Napi::Function callback) {
-            callback.Call({Napi::Number::New(env, static_cast<double>(numPeers))});
-        });
+    if (numPeersCallback_ && numPeersLatest_) {
+        PostCoalesced(
+            numPeersCallback_, numPeersLatest_, static_cast<double>(numPeers),
+            [](Napi::Env env, double value) { return Napi::Number::New(env, value); },
+            &numPeersStats_);
+    } else if (numPeersCallback_) {
+        PostCounted(numPeersCallback_, numPeersStats_,
+                    [numPeers](Napi::Env env, Napi::Function callback) {
+                        callback.Call({Napi::Number::New(env, static_cast<double>(numPeers))});
+                    });
     }
 }
 
 void AbletonLinkWrapper::handleTempoCallback(double tempo) {
+    tempoStats_.Fired();
     std::lock_guard<std::mutex> lock(callbackMutex_);
-    if (tempoCallback_) {
-        tempoCallback_.BlockingCall([tempo](Napi::Env env, Napi::Function callback) {
+    if (tempoCallback_ && tempoLatest_) {
+        PostCoalesced(
+            tempoCallback_, tempoLatest_, tempo,
+            [](Napi::Env env, double value) { return Napi::Number::New(env, value); },
+            &tempoStats_);
+    } else if (tempoCallback_) {
+        PostCounted(tempoCallback_, tempoStats_, [tempo](Napi::Env env, Napi::Function callback) {
             callback.Call({Napi::Number::New(env, tempo)});
         });
     }
 }
 
 void AbletonLinkWrapper::handleStartStopCallback(bool isPlaying) {
+    startStopStats_.Fired();
     std::lock_guard<std::mutex> lock(callbackMutex_);
-    if (startStopCallback_) {
-        startStopCallback_.BlockingCall([isPlaying](Napi::Env env, Napi::Function callback) {
-            callback.Call({Napi::Boolean::New(env, isPlaying)});
-        });
+    if (startStopCallback_ && startStopLatest_) {
+        PostCoalesced(
+            startStopCallback_, startStopLatest_, isPlaying ? 1.0 : 0.0,
+            [](Napi::Env env, double value) { return Napi::Boolean::New(env, value != 0.0); },
+            &startStopStats_);
+    } else if (startStopCallback_) {
+        PostCounted(startStopCallback_, startStopStats_,
+                    [isPlaying](Napi::Env env, Napi::Function callback) {
+                        callback.Call({Napi::Boolean::New(env, isPlaying)});
+                    });
     }
 }
 
@@ -496,6 +598,17 @@ void AbletonLinkWrapper::NoopStartStopCallback(bool isPlaying, void* context) {
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
     AbletonLinkWrapper::Init(env, exports);
     InitAbletonLinkAudio(env, exports);
+    InitAbletonLinkScheduler(env, exports);
+    InitAbletonLinkTransport(env, exports);
+    InitAbletonLinkMidiClock(env, exports);
+    InitAbletonLinkArchive(env, exports);
+    InitAbletonLinkMixBus(env, exports);
+    InitAbletonLinkTempo(env, exports);
+    InitAbletonLinkSpectrum(env, exports);
+    InitAbletonLinkStatePublisher(env, exports);
+    InitAbletonLinkThreadPolicy(env, exports);
+    InitAbletonLinkTrace(env, exports);
+    InitAbletonLinkDecode(env, exports);
     return exports;
 }
 
@@ -1,9 +1,14 @@
 #ifndef ABLETONLINK_H
 #define ABLETONLINK_H
 
+#include "abletonlink_coalesce.h"
+#include "abletonlink_stats.h"
+#include "abletonlink_timeline.h"
 #include <napi.h>
 #include <abl_link.h>
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <mutex>
 
 class AbletonLinkWrapper : public Napi::ObjectWrap<AbletonLinkWrapper> {
@@ -12,11 +17,19 @@ public:
     AbletonLinkWrapper(const Napi::CallbackInfo& info);
     ~AbletonLinkWrapper();
 
+    static bool IsInstance(const Napi::Object& object);
+
+    // Timeline for a native worker thread; see abletonlink_timeline.h.
+    std::unique_ptr<LinkTimeline> CreateTimeline();
+    LinkDependents& Dependents();
+
 private:
-    static Napi::FunctionReference constructor;
-    
     // Link instance
     abl_link link_{};
+
+    // Capture target reused by every method. Methods only run on the JS thread,
+    // so a single per-instance state avoids a create/destroy pair per call.
+    abl_link_session_state sessionState_{};
     
     // Methods
     Napi::Value Enable(const Napi::CallbackInfo& info);
@@ -32,6 +45,8 @@ private:
     Napi::Value IsStartStopSyncEnabled(const Napi::CallbackInfo& info);
     void ForceBeatAtTime(const Napi::CallbackInfo& info);
     Napi::Value GetTimeForBeat(const Napi::CallbackInfo& info);
+    Napi::Value GetState(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
     void Close(const Napi::CallbackInfo& info);
     
     // Quantized launch methods
@@ -66,6 +81,19 @@ private:
     Napi::ThreadSafeFunction numPeersCallback_;
     Napi::ThreadSafeFunction tempoCallback_;
     Napi::ThreadSafeFunction startStopCallback_;
+    // Set when the matching callback was registered with { coalesce: true }.
+    std::shared_ptr<CoalescedSlot> numPeersLatest_;
+    std::shared_ptr<CoalescedSlot> tempoLatest_;
+    std::shared_ptr<CoalescedSlot> startStopLatest_;
+
+    // getStats() counters, updated from the Link thread without locking.
+    CallbackStats numPeersStats_{"numPeers"};
+    CallbackStats tempoStats_{"tempo"};
+    CallbackStats startStopStats_{"startStop"};
+    // getState() calls that wrote into a caller-owned Float64Array.
+    std::atomic<uint64_t> allocationsAvoided_{0};
+
+    LinkDependents dependents_;
 
     void CloseInternal();
 };
@@ -0,0 +1,37 @@
+#ifndef ABLETONLINK_ADDON_H
+#define ABLETONLINK_ADDON_H
+
+#include <napi.h>
+
+// Per-environment addon state. The module is initialized once for the main
+// thread and once per worker thread, so class constructors live in the env's
+// instance data rather than in statics shared by every environment.
+struct AbletonLinkAddonData {
+    Napi::FunctionReference link;
+    Napi::FunctionReference linkAudio;
+    Napi::FunctionReference sessionState;
+    Napi::FunctionReference sinkBufferHandle;
+    Napi::FunctionReference sink;
+    Napi::FunctionReference bufferInfo;
+    Napi::FunctionReference source;
+    Napi::FunctionReference scheduler;
+    Napi::FunctionReference transport;
+    Napi::FunctionReference midiClock;
+    Napi::FunctionReference archiveWriter;
+    Napi::FunctionReference archivePlayer;
+    Napi::FunctionReference mixBus;
+    Napi::FunctionReference tempoTracker;
+    Napi::FunctionReference spectrumAnalyzer;
+    Napi::FunctionReference statePublisher;
+};
+
+inline AbletonLinkAddonData& AddonData(Napi::Env env) {
+    auto* data = env.GetInstanceData<AbletonLinkAddonData>();
+    if (!data) {
+        data = new AbletonLinkAddonData();
+        env.SetInstanceData(data);
+    }
+    return *data;
+}
+
+#endif // ABLETONLINK_ADDON_H
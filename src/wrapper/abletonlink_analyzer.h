@@ -0,0 +1,133 @@
+#ifndef ABLETONLINK_ANALYZER_H
+#define ABLETONLINK_ANALYZER_H
+
+#include "abletonlink_audio.h"
+#include "abletonlink_nodeid.h"
+
+#include <napi.h>
+#include <ableton/LinkAudio.hpp>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Shell shared by the wrappers that analyze a received channel on their own
+// LinkAudioSource: the (link, channelId, callback, options) arguments, the
+// source, a worker thread and a JS callback with at most one dispatch queued.
+// The owner's mutex, condition variable and running flag are shared so its
+// worker loop can use them directly.
+class ChannelAnalyzer {
+public:
+    ChannelAnalyzer(std::mutex& mutex, std::condition_variable& wake, bool& running)
+        : mutex_(mutex), wake_(wake), running_(running) {}
+
+    // Checks the arguments, calls parseOptions for the owner's options and
+    // validation, then takes the LinkAudio instance. Returns false once a
+    // JS exception has been thrown.
+    template <typename ParseOptions>
+    bool Open(const Napi::CallbackInfo& info, const char* dispatchName,
+              ParseOptions parseOptions) {
+        if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsString() ||
+            (info.Length() > 2 && !info[2].IsFunction() && !info[2].IsNull() &&
+             !info[2].IsUndefined())) {
+            Napi::TypeError::New(info.Env(),
+                                 "LinkAudio instance, channelId (string), and optional "
+                                 "callback (function) expected")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        auto linkObject = info[0].As<Napi::Object>();
+        if (!AbletonLinkAudioWrapper::IsInstance(linkObject)) {
+            Napi::TypeError::New(info.Env(), "AbletonLinkAudio expected")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        if (!ParseNodeIdString(info[1].As<Napi::String>().Utf8Value(), channelId_)) {
+            Napi::TypeError::New(info.Env(), "Invalid channelId string")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        if (!parseOptions()) {
+            return false;
+        }
+
+        auto* link = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(linkObject);
+        link_ = link->LinkAudioRef();
+        if (!link_) {
+            Napi::Error::New(info.Env(), "AbletonLinkAudio is closed")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        if (info.Length() > 2 && info[2].IsFunction()) {
+            dispatch_ = Napi::ThreadSafeFunction::New(
+                info.Env(), info[2].As<Napi::Function>(), dispatchName, 0, 1);
+            dispatch_.Unref(info.Env());
+        }
+        linkRef_ = Napi::Persistent(linkObject);
+        linkRef_.SuppressDestruct();
+        return true;
+    }
+
+    // Starts run on the worker thread, then subscribes onBuffer to the
+    // channel on the Link thread.
+    template <typename Run, typename OnBuffer>
+    void Start(Run run, OnBuffer onBuffer) {
+        running_ = true;
+        thread_ = std::thread(run);
+        source_ = std::make_shared<ableton::LinkAudioSource>(
+            *link_, channelId_, [onBuffer](auto handle) { onBuffer(handle); });
+    }
+
+    // Queues dispatch on the JS thread unless one is already queued. Called
+    // with the owner's mutex held; dispatch must call Dispatched() under it.
+    template <typename Dispatch>
+    void Post(Dispatch dispatch) {
+        if (!dispatch_ || dispatchPending_) {
+            return;
+        }
+        dispatchPending_ = true;
+        if (dispatch_.NonBlockingCall(dispatch) != napi_ok) {
+            dispatchPending_ = false;
+        }
+    }
+
+    void Dispatched() { dispatchPending_ = false; }
+
+    ableton::LinkAudio& Link() { return *link_; }
+
+    void Close() {
+        // Stop callbacks before the thread so no buffer arrives after it exits.
+        source_.reset();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (dispatch_) {
+            dispatch_.Abort();
+            dispatch_.Release();
+            dispatch_ = Napi::ThreadSafeFunction();
+        }
+        link_.reset();
+        linkRef_.Reset();
+    }
+
+private:
+    std::mutex& mutex_;
+    std::condition_variable& wake_;
+    bool& running_;
+
+    ableton::ChannelId channelId_{};
+    std::shared_ptr<ableton::LinkAudio> link_;
+    std::shared_ptr<ableton::LinkAudioSource> source_;
+    Napi::ObjectReference linkRef_;
+    Napi::ThreadSafeFunction dispatch_;
+    std::thread thread_;
+    // Guarded by the owner's mutex.
+    bool dispatchPending_ = false;
+};
+
+#endif // ABLETONLINK_ANALYZER_H
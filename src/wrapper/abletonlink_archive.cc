@@ -0,0 +1,971 @@
+#include "abletonlink_archive.h"
+#include "abletonlink_addon.h"
+#include "abletonlink_audio.h"
+#include "abletonlink_nodeid.h"
+#include "abletonlink_thread_policy.h"
+#include "abletonlink_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr char kMagic[4] = {'L', 'K', 'A', 'R'};
+constexpr uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 64;
+constexpr std::size_t kEntrySize = 40;
+// Index entries encoded per write when the writer closes.
+constexpr std::size_t kEntriesPerWrite = 4096;
+// Buffers waiting for the writer thread before new ones are dropped.
+constexpr std::size_t kMaxPendingBuffers = 1024;
+constexpr double kBeatEpsilon = 1e-6;
+
+void PutLE32(uint8_t* p, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void PutLE64(uint8_t* p, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void PutDouble(uint8_t* p, double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    PutLE64(p, bits);
+}
+
+uint32_t GetLE32(const uint8_t* p) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+uint64_t GetLE64(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+double GetDouble(const uint8_t* p) {
+    const auto bits = GetLE64(p);
+    double value = 0.0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void EncodeHeader(const ArchiveHeader& header, uint8_t* p) {
+    std::memset(p, 0, kHeaderSize);
+    std::memcpy(p, kMagic, 4);
+    PutLE32(p + 4, kVersion);
+    PutLE32(p + 8, header.numChannels);
+    PutLE32(p + 12, header.sampleRate);
+    PutDouble(p + 16, header.quantum);
+    PutLE64(p + 24, header.numBlocks);
+    PutLE64(p + 32, header.indexOffset);
+    PutLE64(p + 40, header.numFrames);
+    PutDouble(p + 48, header.firstBeat);
+    PutDouble(p + 56, header.lastBeat);
+}
+
+bool DecodeHeader(const uint8_t* p, ArchiveHeader& header, std::string& error) {
+    if (std::memcmp(p, kMagic, 4) != 0) {
+        error = "Not a Link Audio archive";
+        return false;
+    }
+    if (GetLE32(p + 4) != kVersion) {
+        error = "Unsupported archive version";
+        return false;
+    }
+    header.numChannels = GetLE32(p + 8);
+    header.sampleRate = GetLE32(p + 12);
+    header.quantum = GetDouble(p + 16);
+    header.numBlocks = GetLE64(p + 24);
+    header.indexOffset = GetLE64(p + 32);
+    header.numFrames = GetLE64(p + 40);
+    header.firstBeat = GetDouble(p + 48);
+    header.lastBeat = GetDouble(p + 56);
+    if (header.indexOffset < kHeaderSize) {
+        error = "Archive was not closed and has no index";
+        return false;
+    }
+    if (header.numBlocks > 0 && (header.numChannels == 0 || header.sampleRate == 0)) {
+        error = "Archive header is corrupt";
+        return false;
+    }
+    return true;
+}
+
+void EncodeBlock(const ArchiveBlock& block, uint8_t* p) {
+    PutDouble(p, block.beginBeats);
+    PutDouble(p + 8, block.endBeats);
+    PutDouble(p + 16, block.tempo);
+    PutLE64(p + 24, block.dataOffset);
+    PutLE32(p + 32, block.numFrames);
+    PutLE32(p + 36, 0);
+}
+
+void DecodeBlock(const uint8_t* p, ArchiveBlock& block) {
+    block.beginBeats = GetDouble(p);
+    block.endBeats = GetDouble(p + 8);
+    block.tempo = GetDouble(p + 16);
+    block.dataOffset = GetLE64(p + 24);
+    block.numFrames = GetLE32(p + 32);
+}
+
+bool SeekFile(std::FILE* file, uint64_t offset) {
+#if defined(_WIN32)
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+bool FileSize(std::FILE* file, uint64_t& size) {
+#if defined(_WIN32)
+    if (_fseeki64(file, 0, SEEK_END) != 0) {
+        return false;
+    }
+    const auto end = _ftelli64(file);
+#else
+    if (fseeko(file, 0, SEEK_END) != 0) {
+        return false;
+    }
+    const auto end = ftello(file);
+#endif
+    if (end < 0) {
+        return false;
+    }
+    size = static_cast<uint64_t>(end);
+    return true;
+}
+
+Napi::Object HeaderToObject(Napi::Env env, const ArchiveHeader& header, uint64_t numBlocks) {
+    auto obj = Napi::Object::New(env);
+    obj.Set("numChannels", static_cast<double>(header.numChannels));
+    obj.Set("sampleRate", static_cast<double>(header.sampleRate));
+    obj.Set("quantum", header.quantum);
+    obj.Set("numBlocks", static_cast<double>(numBlocks));
+    obj.Set("numFrames", static_cast<double>(header.numFrames));
+    if (numBlocks == 0) {
+        obj.Set("firstBeat", env.Null());
+        obj.Set("lastBeat", env.Null());
+    } else {
+        obj.Set("firstBeat", header.firstBeat);
+        obj.Set("lastBeat", header.lastBeat);
+    }
+    return obj;
+}
+} // namespace
+
+Napi::Object AbletonLinkAudioArchiveWriterWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "AbletonLinkAudioArchiveWriter", {
+        InstanceMethod("status", &AbletonLinkAudioArchiveWriterWrapper::Status),
+        InstanceMethod("close", &AbletonLinkAudioArchiveWriterWrapper::Close),
+    });
+
+    AddonData(env).archiveWriter = Napi::Persistent(func);
+    exports.Set("AbletonLinkAudioArchiveWriter", func);
+    return exports;
+}
+
+AbletonLinkAudioArchiveWriterWrapper::AbletonLinkAudioArchiveWriterWrapper(
+    const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<AbletonLinkAudioArchiveWriterWrapper>(info) {
+    if (info.Length() < 3 || !info[0].IsObject() || !info[1].IsString() ||
+        !info[2].IsString()) {
+        Napi::TypeError::New(info.Env(),
+                             "LinkAudio instance, channelId (string), and path expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto linkObject = info[0].As<Napi::Object>();
+    if (!AbletonLinkAudioWrapper::IsInstance(linkObject)) {
+        Napi::TypeError::New(info.Env(), "AbletonLinkAudio expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    ableton::ChannelId channelId{};
+    if (!ParseNodeIdString(info[1].As<Napi::String>().Utf8Value(), channelId)) {
+        Napi::TypeError::New(info.Env(), "Invalid channelId string").ThrowAsJavaScriptException();
+        return;
+    }
+    if (info.Length() > 3 && info[3].IsObject()) {
+        auto options = info[3].As<Napi::Object>();
+        if (options.Get("quantum").IsNumber()) {
+            quantum_ = options.Get("quantum").As<Napi::Number>().DoubleValue();
+        }
+    }
+    if (!(quantum_ > 0.0)) {
+        Napi::TypeError::New(info.Env(), "Quantum must be positive")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto* link = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(linkObject);
+    link_ = link->LinkAudioRef();
+    if (!link_) {
+        Napi::Error::New(info.Env(), "AbletonLinkAudio is closed").ThrowAsJavaScriptException();
+        return;
+    }
+
+    path_ = info[2].As<Napi::String>().Utf8Value();
+    file_ = std::fopen(path_.c_str(), "wb");
+    if (!file_) {
+        link_.reset();
+        Napi::Error::New(info.Env(), "Could not open archive for writing: " + path_)
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    // The header is rewritten with the final counts on close.
+    uint8_t header[kHeaderSize];
+    header_.quantum = quantum_;
+    EncodeHeader(header_, header);
+    writeFailed_ = std::fwrite(header, 1, kHeaderSize, file_) != kHeaderSize;
+    dataOffset_ = kHeaderSize;
+
+    running_ = true;
+    thread_ = std::thread([this]() { Run(); });
+    source_ = std::make_shared<ableton::LinkAudioSource>(
+        *link_, channelId, [this](auto handle) { handleBuffer(handle); });
+    linkRef_ = Napi::Persistent(linkObject);
+    linkRef_.SuppressDestruct();
+}
+
+AbletonLinkAudioArchiveWriterWrapper::~AbletonLinkAudioArchiveWriterWrapper() {
+    CloseInternal();
+}
+
+Napi::Value AbletonLinkAudioArchiveWriterWrapper::Status(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto obj = HeaderToObject(info.Env(), header_, index_.size());
+    obj.Set("recording", running_);
+    obj.Set("path", path_);
+    obj.Set("bytesWritten", static_cast<double>(dataOffset_));
+    obj.Set("buffersDropped", static_cast<double>(buffersDropped_));
+    obj.Set("buffersSkipped", static_cast<double>(buffersSkipped_));
+    obj.Set("writeFailed", writeFailed_);
+    return obj;
+}
+
+void AbletonLinkAudioArchiveWriterWrapper::Close(const Napi::CallbackInfo& info) {
+    if (!CloseInternal()) {
+        Napi::Error::New(info.Env(), "Could not write archive: " + path_)
+            .ThrowAsJavaScriptException();
+    }
+}
+
+void AbletonLinkAudioArchiveWriterWrapper::handleBuffer(
+    const ableton::LinkAudioSource::BufferHandle& handle) {
+    TraceInstant("archive", "buffer");
+    const auto numSamples = handle.info.numFrames * handle.info.numChannels;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        if (queue_.size() >= kMaxPendingBuffers) {
+            ++buffersDropped_;
+            return;
+        }
+        Pending pending;
+        pending.info = handle.info;
+        if (!spare_.empty()) {
+            pending.samples = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        pending.samples.assign(handle.samples, handle.samples + numSamples);
+        queue_.push_back(std::move(pending));
+    }
+    wake_.notify_one();
+}
+
+void AbletonLinkAudioArchiveWriterWrapper::Run() {
+    TraceThreadName("archive-writer");
+    auto state = link_->captureAppSessionState();
+    std::vector<Pending> batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this]() { return !queue_.empty() || !running_; });
+        if (queue_.empty()) {
+            return;
+        }
+        batch.swap(queue_);
+        lock.unlock();
+
+        // Buffers are placed on the timeline as the writer sees it, so a
+        // tempo change lands with the batch that follows it.
+        state = link_->captureAppSessionState();
+        for (const auto& buffer : batch) {
+            WriteBuffer(buffer, state);
+        }
+
+        lock.lock();
+        for (auto& buffer : batch) {
+            spare_.push_back(std::move(buffer.samples));
+        }
+        batch.clear();
+    }
+}
+
+void AbletonLinkAudioArchiveWriterWrapper::WriteBuffer(
+    const Pending& buffer, const ableton::LinkAudio::SessionState& state) {
+    // Called on the writer thread, the only one that changes header_ and
+    // index_; they are written under mutex_ for status().
+    TraceSpan span("archive", "write");
+    const auto& info = buffer.info;
+    const auto begin = info.beginBeats(state, quantum_);
+    const auto end = info.endBeats(state, quantum_);
+    // Buffers from another session have no beat position here, and an archive
+    // holds a single format.
+    const bool placed = begin.has_value() && end.has_value() && info.numFrames > 0 &&
+                        info.numChannels > 0 &&
+                        (header_.numChannels == 0 ||
+                         (header_.numChannels == info.numChannels &&
+                          header_.sampleRate == info.sampleRate));
+    const auto numSamples = info.numFrames * info.numChannels;
+    // PCM is written in native byte order; every supported target is
+    // little-endian.
+    const bool written =
+        placed && !writeFailed_ &&
+        std::fwrite(buffer.samples.data(), sizeof(int16_t), numSamples, file_) == numSamples;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!placed) {
+        ++buffersSkipped_;
+        return;
+    }
+    if (!written) {
+        writeFailed_ = true;
+        ++buffersDropped_;
+        return;
+    }
+    if (index_.empty()) {
+        header_.numChannels = static_cast<uint32_t>(info.numChannels);
+        header_.sampleRate = static_cast<uint32_t>(info.sampleRate);
+        header_.firstBeat = *begin;
+        header_.lastBeat = *end;
+    }
+    header_.firstBeat = std::min(header_.firstBeat, *begin);
+    header_.lastBeat = std::max(header_.lastBeat, *end);
+    header_.numFrames += info.numFrames;
+    index_.push_back(ArchiveBlock{*begin, *end, info.tempo, dataOffset_,
+                                  static_cast<uint32_t>(info.numFrames)});
+    dataOffset_ += numSamples * sizeof(int16_t);
+}
+
+bool AbletonLinkAudioArchiveWriterWrapper::CloseInternal() {
+    // Stop callbacks first so the writer thread can drain what is queued.
+    source_.reset();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    link_.reset();
+    linkRef_.Reset();
+    if (!file_) {
+        return !writeFailed_;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Buffers normally arrive in beat order; sorting only moves blocks
+    // recorded across a timeline jump.
+    std::stable_sort(index_.begin(), index_.end(),
+                     [](const ArchiveBlock& a, const ArchiveBlock& b) {
+                         return a.beginBeats < b.beginBeats;
+                     });
+    header_.numBlocks = index_.size();
+    header_.indexOffset = dataOffset_;
+
+    bool ok = !writeFailed_ && SeekFile(file_, dataOffset_);
+    std::vector<uint8_t> encoded;
+    for (std::size_t i = 0; ok && i < index_.size(); i += kEntriesPerWrite) {
+        const auto count = std::min(kEntriesPerWrite, index_.size() - i);
+        encoded.resize(count * kEntrySize);
+        for (std::size_t j = 0; j < count; ++j) {
+            EncodeBlock(index_[i + j], encoded.data() + j * kEntrySize);
+        }
+        ok = std::fwrite(encoded.data(), 1, encoded.size(), file_) == encoded.size();
+    }
+    uint8_t header[kHeaderSize];
+    EncodeHeader(header_, header);
+    ok = ok && SeekFile(file_, 0) && std::fwrite(header, 1, kHeaderSize, file_) == kHeaderSize;
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    writeFailed_ = writeFailed_ || !ok;
+    return ok;
+}
+
+Napi::Object AbletonLinkAudioArchivePlayerWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "AbletonLinkAudioArchivePlayer", {
+        InstanceMethod("info", &AbletonLinkAudioArchivePlayerWrapper::Info),
+        InstanceMethod("seek", &AbletonLinkAudioArchivePlayerWrapper::Seek),
+        InstanceMethod("start", &AbletonLinkAudioArchivePlayerWrapper::Start),
+        InstanceMethod("stop", &AbletonLinkAudioArchivePlayerWrapper::Stop),
+        InstanceMethod("status", &AbletonLinkAudioArchivePlayerWrapper::Status),
+        InstanceMethod("close", &AbletonLinkAudioArchivePlayerWrapper::Close),
+    });
+
+    AddonData(env).archivePlayer = Napi::Persistent(func);
+    exports.Set("AbletonLinkAudioArchivePlayer", func);
+    return exports;
+}
+
+AbletonLinkAudioArchivePlayerWrapper::AbletonLinkAudioArchivePlayerWrapper(
+    const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<AbletonLinkAudioArchivePlayerWrapper>(info) {
+    if (info.Length() < 3 || !info[0].IsObject() || !info[1].IsObject() ||
+        !info[2].IsString()) {
+        Napi::TypeError::New(info.Env(), "LinkAudio instance, sink, and path expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto linkObject = info[0].As<Napi::Object>();
+    auto sinkObject = info[1].As<Napi::Object>();
+    if (!AbletonLinkAudioWrapper::IsInstance(linkObject) ||
+        !AbletonLinkAudioSinkWrapper::IsInstance(sinkObject)) {
+        Napi::TypeError::New(info.Env(), "AbletonLinkAudio and AbletonLinkAudioSink expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    const auto path = info[2].As<Napi::String>().Utf8Value();
+    auto* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        Napi::Error::New(info.Env(), "Could not open archive: " + path)
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    uint8_t header[kHeaderSize];
+    std::string error = "Archive is truncated";
+    if (std::fread(header, 1, kHeaderSize, file) != kHeaderSize ||
+        !DecodeHeader(header, header_, error)) {
+        std::fclose(file);
+        Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+        return;
+    }
+    // Index entries are checked against indexOffset as blocks load, so it is
+    // enough that the index itself lies within the file.
+    uint64_t fileSize = 0;
+    if (!FileSize(file, fileSize) || header_.indexOffset > fileSize ||
+        header_.numBlocks > (fileSize - header_.indexOffset) / kEntrySize) {
+        std::fclose(file);
+        Napi::Error::New(info.Env(), "Archive is truncated").ThrowAsJavaScriptException();
+        return;
+    }
+
+    quantum_ = header_.quantum;
+    if (info.Length() > 3 && info[3].IsObject()) {
+        auto options = info[3].As<Napi::Object>();
+        if (options.Get("quantum").IsNumber()) {
+            quantum_ = options.Get("quantum").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("framesPerBuffer").IsNumber()) {
+            framesPerBuffer_ = std::max<std::size_t>(
+                1, options.Get("framesPerBuffer").As<Napi::Number>().Uint32Value());
+        }
+        if (options.Get("leadMs").IsNumber()) {
+            const auto leadMs = options.Get("leadMs").As<Napi::Number>().DoubleValue();
+            lead_ = std::chrono::microseconds(
+                static_cast<long long>(std::max(0.0, leadMs) * 1000.0));
+        }
+    }
+    if (!(quantum_ > 0.0)) {
+        std::fclose(file);
+        Napi::TypeError::New(info.Env(), "Quantum must be positive")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto* sinkWrapper = Napi::ObjectWrap<AbletonLinkAudioSinkWrapper>::Unwrap(sinkObject);
+    if (!sinkWrapper->Sink()) {
+        std::fclose(file);
+        Napi::Error::New(info.Env(), "Sink is closed").ThrowAsJavaScriptException();
+        return;
+    }
+    auto* link = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(linkObject);
+    timeline_ = link->CreateTimeline();
+    if (!timeline_) {
+        std::fclose(file);
+        Napi::Error::New(info.Env(), "AbletonLinkAudio is closed")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    file_ = file;
+    fromBeat_ = header_.firstBeat;
+    link_ = &link->LinkAudio();
+    sink_ = sinkWrapper->Sink();
+    sinkStats_ = sinkWrapper->Stats();
+    state_ = std::make_unique<ableton::LinkAudio::SessionState>(
+        link_->captureAppSessionState());
+
+    linkRef_ = Napi::Persistent(linkObject);
+    linkRef_.SuppressDestruct();
+    sinkRef_ = Napi::Persistent(sinkObject);
+    sinkRef_.SuppressDestruct();
+
+    // The render thread must stop before the LinkAudio instance is destroyed.
+    dependents_ = &link->Dependents();
+    dependentId_ = dependents_->Add([this]() {
+        dependents_ = nullptr;
+        CloseInternal();
+    });
+}
+
+AbletonLinkAudioArchivePlayerWrapper::~AbletonLinkAudioArchivePlayerWrapper() {
+    CloseInternal();
+}
+
+Napi::Value AbletonLinkAudioArchivePlayerWrapper::Info(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return HeaderToObject(info.Env(), header_, header_.numBlocks);
+}
+
+Napi::Value AbletonLinkAudioArchivePlayerWrapper::Seek(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Beat expected").ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    const auto beat = info[0].As<Napi::Number>().DoubleValue();
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "Archive player is closed").ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    // Position the cursor now so the render thread starts without a search.
+    const bool found = SeekCursor(beat);
+    std::lock_guard<std::mutex> lock(mutex_);
+    fromBeat_ = beat;
+    relaunch_ = running_;
+    if (!found) {
+        return info.Env().Null();
+    }
+    // The first archive beat that will sound, later than beat in a gap.
+    return Napi::Number::New(info.Env(), std::max(beat, CursorBeat()));
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::Start(const Napi::CallbackInfo& info) {
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "Archive player is closed").ThrowAsJavaScriptException();
+        return;
+    }
+    double fromBeat = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (header_.numBlocks == 0) {
+            Napi::Error::New(info.Env(), "Archive is empty").ThrowAsJavaScriptException();
+            return;
+        }
+        if (running_) {
+            return;
+        }
+        fromBeat = fromBeat_;
+    }
+    // The launch plays from fromBeat_; load it here rather than on the render
+    // thread.
+    SeekCursor(fromBeat);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+        relaunch_ = true;
+    }
+    thread_ = std::thread([this]() { Run(); });
+    loader_ = std::thread([this]() { RunLoader(); });
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::Stop(const Napi::CallbackInfo& info) {
+    StopThread();
+}
+
+Napi::Value AbletonLinkAudioArchivePlayerWrapper::Status(const Napi::CallbackInfo& info) {
+    auto obj = Napi::Object::New(info.Env());
+    std::lock_guard<std::mutex> lock(mutex_);
+    obj.Set("running", running_);
+    obj.Set("playing", playing_ && !ended_);
+    obj.Set("ended", ended_);
+    obj.Set("launchBeat", launchBeat_);
+    obj.Set("launchTime", launchTime_.count() / 1000000.0);
+    if (cursorValid_) {
+        obj.Set("position", CursorBeat());
+    } else {
+        obj.Set("position", info.Env().Null());
+    }
+    obj.Set("framesCommitted", static_cast<double>(framesCommitted_));
+    obj.Set("buffersDropped", static_cast<double>(buffersDropped_));
+    obj.Set("resyncs", static_cast<double>(resyncs_));
+    return obj;
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::Close(const Napi::CallbackInfo& info) {
+    CloseInternal();
+}
+
+bool AbletonLinkAudioArchivePlayerWrapper::ReadBlock(uint64_t index, ArchiveBlock& block) {
+    uint8_t entry[kEntrySize];
+    if (!file_ || index >= header_.numBlocks ||
+        !SeekFile(file_, header_.indexOffset + index * kEntrySize) ||
+        std::fread(entry, 1, kEntrySize, file_) != kEntrySize) {
+        return false;
+    }
+    DecodeBlock(entry, block);
+    return true;
+}
+
+uint64_t AbletonLinkAudioArchivePlayerWrapper::FindBlock(double beat) {
+    // Binary search over the on-disk index: O(log n) reads of one entry.
+    uint64_t low = 0;
+    uint64_t high = header_.numBlocks;
+    ArchiveBlock block;
+    while (low < high) {
+        const auto mid = low + (high - low) / 2;
+        if (!ReadBlock(mid, block)) {
+            return high;
+        }
+        if (block.beginBeats <= beat) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool AbletonLinkAudioArchivePlayerWrapper::LoadBlock(uint64_t index, LoadedBlock& loaded) {
+    if (!ReadBlock(index, loaded.block)) {
+        return false;
+    }
+    // Blocks lie between the header and the index. Entries pointing elsewhere
+    // are corrupt and must not size the sample buffer.
+    const auto& block = loaded.block;
+    const uint64_t frameBytes = uint64_t{header_.numChannels} * sizeof(int16_t);
+    if (block.numFrames == 0 || block.dataOffset < kHeaderSize ||
+        block.dataOffset > header_.indexOffset ||
+        block.numFrames > (header_.indexOffset - block.dataOffset) / frameBytes) {
+        return false;
+    }
+    const auto numSamples = static_cast<std::size_t>(block.numFrames) * header_.numChannels;
+    loaded.samples.resize(numSamples);
+    if (!SeekFile(file_, block.dataOffset) ||
+        std::fread(loaded.samples.data(), sizeof(int16_t), numSamples, file_) != numSamples) {
+        return false;
+    }
+    loaded.index = index;
+    return true;
+}
+
+bool AbletonLinkAudioArchivePlayerWrapper::FindCursor(double beat, LoadedBlock& loaded,
+                                                      uint32_t& frame) {
+    TraceSpan span("archive", "seek");
+    frame = 0;
+    const auto next = FindBlock(beat);
+    if (next == 0) {
+        // Before the first block: the cursor waits at its first frame.
+        return LoadBlock(0, loaded);
+    }
+    if (!LoadBlock(next - 1, loaded)) {
+        return false;
+    }
+    const auto& block = loaded.block;
+    const auto length = block.endBeats - block.beginBeats;
+    const auto position =
+        length > 0.0 ? std::floor((beat - block.beginBeats) / length * block.numFrames) : 0.0;
+    if (position < block.numFrames) {
+        frame = static_cast<uint32_t>(position);
+        return true;
+    }
+    // In the gap after this block.
+    return next < header_.numBlocks && LoadBlock(next, loaded);
+}
+
+bool AbletonLinkAudioArchivePlayerWrapper::SeekCursor(double beat) {
+    LoadedBlock loaded;
+    uint32_t frame = 0;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        found = file_ && FindCursor(beat, loaded, frame);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    InstallCursor(found, loaded, frame);
+    return found;
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::InstallCursor(bool found, LoadedBlock& loaded,
+                                                         uint32_t frame) {
+    // Swapping keeps the old block's storage with the caller for reuse.
+    std::swap(cursor_, loaded);
+    cursorFrame_ = frame;
+    cursorValid_ = found;
+    ended_ = !found;
+    seekPending_ = false;
+    nextState_ = NextBlock::kPending;
+    ++generation_;
+    loaderWake_.notify_one();
+}
+
+bool AbletonLinkAudioArchivePlayerWrapper::MoveCursor(double beat) {
+    const auto& block = cursor_.block;
+    const auto length = block.endBeats - block.beginBeats;
+    if (!cursorValid_ || !(length > 0.0) || !(beat >= block.beginBeats)) {
+        return false;
+    }
+    const auto frame = std::floor((beat - block.beginBeats) / length * block.numFrames);
+    if (!(frame < block.numFrames)) {
+        return false;
+    }
+    cursorFrame_ = static_cast<uint32_t>(frame);
+    return true;
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::RequestSeek(double beat) {
+    cursorValid_ = false;
+    seekPending_ = true;
+    seekBeat_ = beat;
+    ++generation_;
+    loaderWake_.notify_one();
+}
+
+double AbletonLinkAudioArchivePlayerWrapper::CursorBeat() const {
+    const auto& block = cursor_.block;
+    return block.beginBeats + (block.endBeats - block.beginBeats) * cursorFrame_ / block.numFrames;
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::Run() {
+    ThreadPolicyScope policy("archive");
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto frameMicros = 1000000.0 / header_.sampleRate;
+    bool synced = false;
+    while (running_) {
+        const auto now = static_cast<double>(timeline_->Now().count());
+        if (!synced || bufferTime_ < now - framesPerBuffer_ * frameMicros) {
+            // First buffer, or the thread fell behind: restart the stream one
+            // lead ahead of the clock. The archive cursor follows the beat.
+            bufferTime_ = now + lead_.count();
+            synced = true;
+        }
+
+        const auto ahead = bufferTime_ - now;
+        if (ahead > lead_.count()) {
+            wake_.wait_for(lock, std::chrono::microseconds(
+                                     static_cast<long long>(ahead - lead_.count())));
+            continue;
+        }
+        RenderBuffer();
+    }
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::RunLoader() {
+    TraceThreadName("archive-loader");
+    LoadedBlock loaded;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        const bool prefetch = cursorValid_ && nextState_ == NextBlock::kPending &&
+                              cursor_.index + 1 < header_.numBlocks;
+        if (!seekPending_ && !prefetch) {
+            loaderWake_.wait(lock);
+            continue;
+        }
+        const bool seek = seekPending_;
+        const auto beat = seekBeat_;
+        const auto index = cursor_.index + 1;
+        const auto generation = generation_;
+        lock.unlock();
+
+        uint32_t frame = 0;
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> fileLock(fileMutex_);
+            found = file_ && (seek ? FindCursor(beat, loaded, frame) : LoadBlock(index, loaded));
+        }
+
+        lock.lock();
+        if (generation != generation_) {
+            // The cursor moved while reading; the next pass loads for it.
+            continue;
+        }
+        if (seek) {
+            InstallCursor(found, loaded, frame);
+        } else {
+            std::swap(next_, loaded);
+            nextState_ = found ? NextBlock::kReady : NextBlock::kMissing;
+        }
+    }
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::RenderBuffer() {
+    // Called with mutex_ held on the render thread, which never reads the
+    // file: blocks come from the loader thread.
+    TraceSpan span("archive", "render");
+    *state_ = link_->captureAppSessionState();
+    const auto sampleRate = header_.sampleRate;
+    const auto frameMicros = 1000000.0 / sampleRate;
+    const auto beginMicros = bufferTime_;
+    const auto bufferBegin =
+        std::chrono::microseconds(static_cast<long long>(std::llround(beginMicros)));
+    if (relaunch_) {
+        const auto startBeat = state_->beatAtTime(bufferBegin, quantum_);
+        launchBeat_ = std::ceil(startBeat / quantum_ - kBeatEpsilon) * quantum_;
+        launchTime_ = state_->timeAtBeat(launchBeat_, quantum_);
+        relaunch_ = false;
+        playing_ = true;
+        ended_ = false;
+        aligned_ = false;
+    }
+    bufferTime_ += framesPerBuffer_ * frameMicros;
+
+    ableton::LinkAudioSink::BufferHandle handle(*sink_);
+    sinkStats_->Retained(static_cast<bool>(handle));
+    const auto channels = header_.numChannels;
+    const auto numFrames =
+        handle ? std::min(framesPerBuffer_, handle.maxNumSamples / channels) : 0;
+    if (numFrames == 0) {
+        ++buffersDropped_;
+        return;
+    }
+
+    auto* out = handle.samples;
+    const auto frameBytes = channels * sizeof(int16_t);
+    std::size_t frame = 0;
+    if (playing_ && !ended_) {
+        const auto firstFrame = std::ceil((launchTime_.count() - beginMicros) / frameMicros);
+        frame = static_cast<std::size_t>(
+            std::min(static_cast<double>(numFrames), std::max(0.0, firstFrame)));
+        std::memset(out, 0, frame * frameBytes);
+    }
+    if (playing_ && !ended_ && frame < numFrames) {
+        // Archive beat that lines up with the first frame played here.
+        const auto frameTime = std::chrono::microseconds(
+            static_cast<long long>(std::llround(beginMicros + frame * frameMicros)));
+        const auto target = fromBeat_ + state_->beatAtTime(frameTime, quantum_) - launchBeat_;
+        const auto beatsPerFrame = state_->tempo() / 60.0 / sampleRate;
+        const auto tolerance = numFrames * beatsPerFrame;
+        // A cursor waiting at the start of a block (before the archive or
+        // across a gap) is expected to be ahead of the target.
+        const auto drift = cursorValid_ ? CursorBeat() - target : 0.0;
+        if (seekPending_) {
+            // Silent until the loader has positioned the cursor.
+        } else if (!cursorValid_ || drift < -tolerance ||
+                   (drift > tolerance && cursorFrame_ != 0)) {
+            if (cursorValid_ && aligned_) {
+                ++resyncs_;
+            }
+            if (!MoveCursor(target)) {
+                RequestSeek(target);
+            }
+        }
+        aligned_ = true;
+        if (cursorValid_ && beatsPerFrame > 0.0) {
+            const auto wait = (CursorBeat() - target) / beatsPerFrame;
+            if (wait >= 1.0) {
+                const auto silent = std::min(numFrames - frame, static_cast<std::size_t>(wait));
+                std::memset(out + frame * channels, 0, silent * frameBytes);
+                frame += silent;
+            }
+        }
+        while (cursorValid_ && frame < numFrames) {
+            const auto count =
+                std::min<std::size_t>(numFrames - frame, cursor_.block.numFrames - cursorFrame_);
+            std::memcpy(out + frame * channels,
+                        cursor_.samples.data() + static_cast<std::size_t>(cursorFrame_) * channels,
+                        count * frameBytes);
+            frame += count;
+            cursorFrame_ += static_cast<uint32_t>(count);
+            if (cursorFrame_ < cursor_.block.numFrames) {
+                continue;
+            }
+            if (nextState_ == NextBlock::kReady) {
+                std::swap(cursor_, next_);
+                cursorFrame_ = 0;
+                nextState_ = NextBlock::kPending;
+                loaderWake_.notify_one();
+            } else if (nextState_ == NextBlock::kPending &&
+                       cursor_.index + 1 < header_.numBlocks) {
+                // The loader has fallen behind; pick up at the next block.
+                RequestSeek(cursor_.block.endBeats);
+            } else {
+                cursorValid_ = false;
+                ended_ = true;
+            }
+        }
+    }
+    std::memset(out + frame * channels, 0, (numFrames - frame) * frameBytes);
+
+    const auto beatsAtBufferBegin = state_->beatAtTime(bufferBegin, quantum_);
+    const auto committed = handle.commit(*state_, beatsAtBufferBegin, quantum_, numFrames,
+                                         channels, sampleRate);
+    sinkStats_->Committed(committed, numFrames * frameBytes);
+    if (committed) {
+        framesCommitted_ += numFrames;
+    } else {
+        ++buffersDropped_;
+    }
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::StopThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        playing_ = false;
+    }
+    wake_.notify_all();
+    loaderWake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (loader_.joinable()) {
+        loader_.join();
+    }
+}
+
+void AbletonLinkAudioArchivePlayerWrapper::CloseInternal() {
+    StopThread();
+    if (dependents_) {
+        dependents_->Remove(dependentId_);
+        dependents_ = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        if (file_) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cursorValid_ = false;
+        cursor_ = LoadedBlock();
+        next_ = LoadedBlock();
+    }
+    sink_.reset();
+    sinkStats_.reset();
+    state_.reset();
+    timeline_.reset();
+    link_ = nullptr;
+    sinkRef_.Reset();
+    linkRef_.Reset();
+}
+
+Napi::Object InitAbletonLinkArchive(Napi::Env env, Napi::Object exports) {
+    AbletonLinkAudioArchiveWriterWrapper::Init(env, exports);
+    AbletonLinkAudioArchivePlayerWrapper::Init(env, exports);
+    return exports;
+}
@@ -0,0 +1,208 @@
+#ifndef ABLETONLINK_ARCHIVE_H
+#define ABLETONLINK_ARCHIVE_H
+
+#include "abletonlink_stats.h"
+#include "abletonlink_timeline.h"
+#include <napi.h>
+#include <ableton/LinkAudio.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Beat-indexed capture archives. All fields are little-endian.
+//
+//   header   64 bytes: "LKAR", version, numChannels, sampleRate, quantum,
+//            numBlocks, indexOffset, numFrames, firstBeat, lastBeat
+//   blocks   interleaved int16 PCM, one block per received buffer
+//   index    numBlocks entries of 40 bytes, sorted by beginBeats:
+//            beginBeats, endBeats, tempo, dataOffset, numFrames
+//
+// The index is written when the writer closes, so an archive that was never
+// closed cannot be opened. Readers binary-search the index on disk and only
+// hold the block being played and the one after it.
+struct ArchiveBlock {
+    double beginBeats = 0.0;
+    double endBeats = 0.0;
+    double tempo = 0.0;
+    uint64_t dataOffset = 0;
+    uint32_t numFrames = 0;
+};
+
+struct ArchiveHeader {
+    uint32_t numChannels = 0;
+    uint32_t sampleRate = 0;
+    double quantum = 4.0;
+    uint64_t numBlocks = 0;
+    uint64_t indexOffset = 0;
+    uint64_t numFrames = 0;
+    double firstBeat = 0.0;
+    double lastBeat = 0.0;
+};
+
+// Records a channel to an archive. Buffers are copied on the Link thread into
+// recycled storage and written by a dedicated thread, which maps them onto
+// the local session's beat timeline.
+class AbletonLinkAudioArchiveWriterWrapper
+    : public Napi::ObjectWrap<AbletonLinkAudioArchiveWriterWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    AbletonLinkAudioArchiveWriterWrapper(const Napi::CallbackInfo& info);
+    ~AbletonLinkAudioArchiveWriterWrapper();
+
+private:
+    struct Pending {
+        ableton::LinkAudioSource::BufferHandle::Info info{};
+        std::vector<int16_t> samples;
+    };
+
+    Napi::Value Status(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void handleBuffer(const ableton::LinkAudioSource::BufferHandle& handle);
+    void Run();
+    void WriteBuffer(const Pending& buffer, const ableton::LinkAudio::SessionState& state);
+    // Writes the index and header. Returns false if the archive is unusable.
+    bool CloseInternal();
+
+    std::shared_ptr<ableton::LinkAudio> link_;
+    std::shared_ptr<ableton::LinkAudioSource> source_;
+    Napi::ObjectReference linkRef_;
+    std::FILE* file_ = nullptr;
+    std::string path_;
+    double quantum_ = 4.0;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<Pending> queue_;
+    // Storage of written buffers, reused by later ones.
+    std::vector<std::vector<int16_t>> spare_;
+    bool running_ = false;
+    std::thread thread_;
+
+    // Writer thread state, read by status() under mutex_.
+    ArchiveHeader header_;
+    std::vector<ArchiveBlock> index_;
+    uint64_t dataOffset_ = 0;
+    uint64_t buffersDropped_ = 0;
+    uint64_t buffersSkipped_ = 0;
+    bool writeFailed_ = false;
+};
+
+// Streams an archive into a sink from a native thread. start() launches the
+// archive position set by seek() on the next quantum boundary of the live
+// session; after that each buffer is taken from the archive beat that lines
+// up with the session beat it is committed at. Audio is not time-stretched:
+// when the live tempo differs from the recorded one, playback re-seeks once
+// it drifts by more than a buffer. A loader thread reads blocks ahead of the
+// render thread and serves its re-seeks, so rendering never waits on the file.
+class AbletonLinkAudioArchivePlayerWrapper
+    : public Napi::ObjectWrap<AbletonLinkAudioArchivePlayerWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    AbletonLinkAudioArchivePlayerWrapper(const Napi::CallbackInfo& info);
+    ~AbletonLinkAudioArchivePlayerWrapper();
+
+private:
+    struct LoadedBlock {
+        uint64_t index = 0;
+        ArchiveBlock block;
+        std::vector<int16_t> samples;
+    };
+
+    // State of the block after the cursor's.
+    enum class NextBlock { kPending, kReady, kMissing };
+
+    Napi::Value Info(const Napi::CallbackInfo& info);
+    Napi::Value Seek(const Napi::CallbackInfo& info);
+    void Start(const Napi::CallbackInfo& info);
+    void Stop(const Napi::CallbackInfo& info);
+    Napi::Value Status(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    // Index and block access, with fileMutex_ held.
+    bool ReadBlock(uint64_t index, ArchiveBlock& block);
+    // Index of the first block that begins after beat.
+    uint64_t FindBlock(double beat);
+    bool LoadBlock(uint64_t index, LoadedBlock& loaded);
+    // Loads the block holding beat, or the next block when beat falls in a
+    // gap, and sets frame to the position of beat in it. Returns false past
+    // the end of the archive.
+    bool FindCursor(double beat, LoadedBlock& loaded, uint32_t& frame);
+
+    // Reads the block holding beat on the calling thread and moves the cursor
+    // there. Returns false past the end of the archive.
+    bool SeekCursor(double beat);
+    // Cursor changes, with mutex_ held.
+    void InstallCursor(bool found, LoadedBlock& loaded, uint32_t frame);
+    // Moves the cursor within its block. Returns false if beat is outside it.
+    bool MoveCursor(double beat);
+    // Hands a seek to the loader thread; the cursor is invalid until it is done.
+    void RequestSeek(double beat);
+    double CursorBeat() const;
+
+    void Run();
+    void RunLoader();
+    void RenderBuffer();
+    void StopThread();
+    void CloseInternal();
+
+    ableton::LinkAudio* link_ = nullptr;
+    std::shared_ptr<ableton::LinkAudioSink> sink_;
+    std::shared_ptr<SinkStats> sinkStats_;
+    std::unique_ptr<LinkTimeline> timeline_;
+    double quantum_ = 4.0;
+    std::size_t framesPerBuffer_ = 512;
+    std::chrono::microseconds lead_{20000};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable loaderWake_;
+    // Serializes reads of file_; never held together with mutex_.
+    std::mutex fileMutex_;
+    std::FILE* file_ = nullptr;
+    ArchiveHeader header_;
+    bool running_ = false;
+    std::thread thread_;
+    std::thread loader_;
+
+    // Playback state, guarded by mutex_. The cursor is the next archive frame
+    // to play: frame cursorFrame_ of cursor_.
+    std::unique_ptr<ableton::LinkAudio::SessionState> state_;
+    double bufferTime_ = 0.0;
+    double fromBeat_ = 0.0;
+    bool relaunch_ = false;
+    bool playing_ = false;
+    bool ended_ = false;
+    bool cursorValid_ = false;
+    // False from a launch until its first buffer has been lined up, so the
+    // initial seek is not counted as a resync.
+    bool aligned_ = false;
+    double launchBeat_ = 0.0;
+    std::chrono::microseconds launchTime_{0};
+    uint32_t cursorFrame_ = 0;
+    LoadedBlock cursor_;
+    LoadedBlock next_;
+    NextBlock nextState_ = NextBlock::kPending;
+    // Loader requests. generation_ changes whenever the cursor is moved to
+    // another block, so a load started before that is discarded.
+    bool seekPending_ = false;
+    double seekBeat_ = 0.0;
+    uint64_t generation_ = 0;
+    uint64_t framesCommitted_ = 0;
+    uint64_t buffersDropped_ = 0;
+    uint64_t resyncs_ = 0;
+
+    Napi::ObjectReference linkRef_;
+    Napi::ObjectReference sinkRef_;
+    LinkDependents* dependents_ = nullptr;
+    uint64_t dependentId_ = 0;
+};
+
+Napi::Object InitAbletonLinkArchive(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_ARCHIVE_H
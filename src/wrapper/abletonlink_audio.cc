@@ -1,40 +1,32 @@
 #include "abletonlink_audio.h"
+#include "abletonlink_addon.h"
+#include "abletonlink_nodeid.h"
+#include "abletonlink_state.h"
+#include "abletonlink_thread_policy.h"
+#include "abletonlink_trace.h"
 
 #include <algorithm>
-#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <future>
 #include <iomanip>
-#include <sstream>
 
 namespace {
-std::string NodeIdToHexString(const ableton::link::NodeId& id) {
-    std::ostringstream stream;
-    stream << id;
-    return stream.str();
+Napi::Object ChannelToObject(Napi::Env env, const LinkChannelEntry& channel) {
+    auto obj = Napi::Object::New(env);
+    obj.Set("id", channel.id);
+    obj.Set("name", channel.name);
+    obj.Set("peerId", channel.peerId);
+    obj.Set("peerName", channel.peerName);
+    return obj;
 }
 
-bool ParseNodeIdString(const std::string& input, ableton::link::NodeId& out) {
-    std::string hex = input;
-    if (hex.rfind("0x", 0) == 0 || hex.rfind("0X", 0) == 0) {
-        hex = hex.substr(2);
-    }
-    if (hex.size() != 16) {
-        return false;
-    }
-
-    ableton::link::NodeIdArray bytes{};
-    for (size_t i = 0; i < bytes.size(); ++i) {
-        const auto hi = hex[2 * i];
-        const auto lo = hex[2 * i + 1];
-        if (!std::isxdigit(static_cast<unsigned char>(hi)) ||
-            !std::isxdigit(static_cast<unsigned char>(lo))) {
-            return false;
-        }
-        const auto byte = std::stoul(hex.substr(2 * i, 2), nullptr, 16);
-        bytes[i] = static_cast<std::uint8_t>(byte);
+Napi::Array ChannelsToArray(Napi::Env env, const std::vector<LinkChannelEntry>& channels) {
+    auto result = Napi::Array::New(env, channels.size());
+    for (size_t i = 0; i < channels.size(); ++i) {
+        result.Set(i, ChannelToObject(env, channels[i]));
     }
-
-    out = ableton::link::NodeId(bytes);
-    return true;
+    return result;
 }
 
 Napi::Value OptionalToValue(Napi::Env env, const std::optional<double>& value) {
@@ -43,14 +35,48 @@ Napi::Value OptionalToValue(Napi::Env env, const std::optional<double>& value) {
     }
     return env.Null();
 }
-} // namespace
 
-Napi::FunctionReference AbletonLinkAudioSessionStateWrapper::constructor;
-Napi::FunctionReference AbletonLinkAudioWrapper::constructor;
-Napi::FunctionReference AbletonLinkAudioSinkWrapper::constructor;
-Napi::FunctionReference AbletonLinkAudioSinkBufferHandleWrapper::constructor;
-Napi::FunctionReference AbletonLinkAudioBufferInfoWrapper::constructor;
-Napi::FunctionReference AbletonLinkAudioSourceWrapper::constructor;
+// Instances published with share(), keyed for attach() from any thread. Only
+// weak references are held: the owner and attached handles keep Link alive.
+std::mutex sharedLinksMutex;
+std::unordered_map<std::string, std::weak_ptr<ableton::LinkAudio>> sharedLinks;
+uint64_t nextSharedLinkId = 1;
+
+// Link leaves the session when the last handle releases it.
+std::shared_ptr<ableton::LinkAudio> MakeLinkAudio(double bpm, const std::string& name) {
+    return std::shared_ptr<ableton::LinkAudio>(
+        new ableton::LinkAudio(bpm, name), [](ableton::LinkAudio* link) {
+            link->enableLinkAudio(false);
+            link->enable(false);
+            delete link;
+        });
+}
+
+class LinkAudioTimeline : public LinkTimeline {
+public:
+    explicit LinkAudioTimeline(ableton::LinkAudio& link)
+        : link_(link), state_(link.captureAppSessionState()) {}
+
+    std::chrono::microseconds Now() const override { return link_.clock().micros(); }
+    void Capture() override { state_ = link_.captureAppSessionState(); }
+    double Tempo() const override { return state_.tempo(); }
+    double BeatAtTime(std::chrono::microseconds time, double quantum) const override {
+        return state_.beatAtTime(time, quantum);
+    }
+    std::chrono::microseconds TimeAtBeat(double beat, double quantum) const override {
+        return state_.timeAtBeat(beat, quantum);
+    }
+    bool IsPlaying() const override { return state_.isPlaying(); }
+    std::chrono::microseconds TimeForIsPlaying() const override {
+        return state_.timeForIsPlaying();
+    }
+    std::size_t NumPeers() const override { return link_.numPeers(); }
+
+private:
+    ableton::LinkAudio& link_;
+    ableton::LinkAudio::SessionState state_;
+};
+} // namespace
 
 Napi::Object AbletonLinkAudioSessionStateWrapper::Init(Napi::Env env,
                                                        Napi::Object exports) {
@@ -78,8 +104,7 @@ Napi::Object AbletonLinkAudioSessionStateWrapper::Init(Napi::Env env,
             &AbletonLinkAudioSessionStateWrapper::SetIsPlayingAndRequestBeatAtTime),
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    AddonData(env).sessionState = Napi::Persistent(func);
     exports.Set("AbletonLinkAudioSessionState", func);
     return exports;
 }
@@ -87,7 +112,7 @@ Napi::Object AbletonLinkAudioSessionStateWrapper::Init(Napi::Env env,
 Napi::Object AbletonLinkAudioSessionStateWrapper::New(
     Napi::Env env, const ableton::LinkAudio::SessionState& state) {
     Napi::EscapableHandleScope scope(env);
-    auto obj = constructor.New({});
+    auto obj = AddonData(env).sessionState.New({});
     auto* wrapper = Napi::ObjectWrap<AbletonLinkAudioSessionStateWrapper>::Unwrap(obj);
     *wrapper->state_ = state;
     return scope.Escape(napi_value(obj)).ToObject();
@@ -279,6 +304,7 @@ Napi::Object AbletonLinkAudioWrapper::Init(Napi::Env env, Napi::Object exports)
                        &AbletonLinkAudioWrapper::SetIsPlayingAndRequestBeatAtTime),
         InstanceMethod("timeForIsPlaying", &AbletonLinkAudioWrapper::TimeForIsPlaying),
         InstanceMethod("getClockTime", &AbletonLinkAudioWrapper::GetClockTime),
+        InstanceMethod("getState", &AbletonLinkAudioWrapper::GetState),
         InstanceMethod("isLinkAudioEnabled",
                        &AbletonLinkAudioWrapper::IsLinkAudioEnabled),
         InstanceMethod("enableLinkAudio", &AbletonLinkAudioWrapper::EnableLinkAudio),
@@ -286,7 +312,13 @@ Napi::Object AbletonLinkAudioWrapper::Init(Napi::Env env, Napi::Object exports)
         InstanceMethod("setChannelsChangedCallback",
                        &AbletonLinkAudioWrapper::SetChannelsChangedCallback),
         InstanceMethod("channels", &AbletonLinkAudioWrapper::Channels),
+        InstanceMethod("findChannels", &AbletonLinkAudioWrapper::FindChannels),
         InstanceMethod("callOnLinkThread", &AbletonLinkAudioWrapper::CallOnLinkThread),
+        InstanceMethod("runOnLinkThread", &AbletonLinkAudioWrapper::RunOnLinkThread),
+        InstanceMethod("share", &AbletonLinkAudioWrapper::Share),
+        InstanceMethod("isAttached", &AbletonLinkAudioWrapper::IsAttached),
+        InstanceMethod("getStats", &AbletonLinkAudioWrapper::GetStats),
+        StaticMethod("attach", &AbletonLinkAudioWrapper::Attach),
         InstanceMethod("captureAppSessionState",
                        &AbletonLinkAudioWrapper::CaptureAppSessionState),
         InstanceMethod("commitAppSessionState",
@@ -295,23 +327,34 @@ Napi::Object AbletonLinkAudioWrapper::Init(Napi::Env env, Napi::Object exports)
                        &AbletonLinkAudioWrapper::CaptureAudioSessionState),
         InstanceMethod("commitAudioSessionState",
                        &AbletonLinkAudioWrapper::CommitAudioSessionState),
+        InstanceMethod("captureAppSessionStateInto",
+                       &AbletonLinkAudioWrapper::CaptureAppSessionStateInto),
+        InstanceMethod("captureAudioSessionStateInto",
+                       &AbletonLinkAudioWrapper::CaptureAudioSessionStateInto),
         InstanceMethod("setNumPeersCallback",
                        &AbletonLinkAudioWrapper::SetNumPeersCallback),
         InstanceMethod("setTempoCallback",
                        &AbletonLinkAudioWrapper::SetTempoCallback),
         InstanceMethod("setStartStopCallback",
                        &AbletonLinkAudioWrapper::SetStartStopCallback),
+        InstanceMethod("setEventCallback", &AbletonLinkAudioWrapper::SetEventCallback),
         InstanceMethod("close", &AbletonLinkAudioWrapper::Close),
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    AddonData(env).linkAudio = Napi::Persistent(func);
     exports.Set("AbletonLinkAudio", func);
     return exports;
 }
 
 AbletonLinkAudioWrapper::AbletonLinkAudioWrapper(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<AbletonLinkAudioWrapper>(info) {
+    if (info.Length() == 1 && info[0].IsExternal()) {
+        // Handle created by attach(); see Attach() below.
+        link_ = *info[0].As<Napi::External<std::shared_ptr<ableton::LinkAudio>>>().Data();
+        owner_ = false;
+        channelDirectory_ = std::make_unique<LinkChannelDirectory>(&NodeIdToHexString);
+        return;
+    }
     if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
         Napi::TypeError::New(info.Env(),
                              "Initial tempo (number) and peer name (string) expected")
@@ -320,17 +363,54 @@ AbletonLinkAudioWrapper::AbletonLinkAudioWrapper(const Napi::CallbackInfo& info)
     }
     const auto bpm = info[0].As<Napi::Number>().DoubleValue();
     const auto name = info[1].As<Napi::String>().Utf8Value();
-    link_ = std::make_unique<ableton::LinkAudio>(bpm, name);
+    link_ = MakeLinkAudio(bpm, name);
+    channelDirectory_ = std::make_unique<LinkChannelDirectory>(&NodeIdToHexString);
+    link_->setChannelsChangedCallback([this]() { handleChannelsChangedCallback(); });
+
+    // Let setThreadPolicy() reach Link's own thread.
+    std::weak_ptr<ableton::LinkAudio> weakLink = link_;
+    RegisterThreadPolicyExecutor("link", [weakLink](std::function<void()> fn) {
+        const auto link = weakLink.lock();
+        if (!link) {
+            return false;
+        }
+        link->callOnLinkThread(std::move(fn));
+        return true;
+    });
+    link_->callOnLinkThread([]() { TraceThreadName("link"); });
 }
 
 AbletonLinkAudioWrapper::~AbletonLinkAudioWrapper() {
     CloseInternal();
 }
 
+bool AbletonLinkAudioWrapper::IsInstance(const Napi::Object& object) {
+    return object.InstanceOf(AddonData(object.Env()).linkAudio.Value());
+}
+
 ableton::LinkAudio& AbletonLinkAudioWrapper::LinkAudio() {
     return *link_;
 }
 
+std::shared_ptr<ableton::LinkAudio> AbletonLinkAudioWrapper::LinkAudioRef() const {
+    return link_;
+}
+
+std::unique_ptr<LinkTimeline> AbletonLinkAudioWrapper::CreateTimeline() {
+    if (!link_) {
+        return nullptr;
+    }
+    return std::make_unique<LinkAudioTimeline>(*link_);
+}
+
+LinkDependents& AbletonLinkAudioWrapper::Dependents() {
+    return dependents_;
+}
+
+std::shared_ptr<ChannelAlignment> AbletonLinkAudioWrapper::Alignment() const {
+    return alignment_;
+}
+
 Napi::Value AbletonLinkAudioWrapper::Enable(const Napi::CallbackInfo& info) {
     if (info.Length() < 1 || !info[0].IsBoolean()) {
         Napi::TypeError::New(info.Env(), "Boolean expected").ThrowAsJavaScriptException();
@@ -504,6 +584,25 @@ Napi::Value AbletonLinkAudioWrapper::GetClockTime(const Napi::CallbackInfo& info
     return Napi::Number::New(info.Env(), micros / 1000000.0);
 }
 
+Napi::Value AbletonLinkAudioWrapper::GetState(const Napi::CallbackInfo& info) {
+    double quantum = 0.0;
+    if (!ParseLinkStateArgs(info, quantum)) {
+        return info.Env().Null();
+    }
+    const auto state = link_->captureAppSessionState();
+    const auto now = getCurrentTime();
+    LinkStateSnapshot snapshot;
+    snapshot.tempo = state.tempo();
+    snapshot.beat = state.beatAtTime(now, 1.0);
+    snapshot.phase = state.phaseAtTime(now, quantum);
+    snapshot.numPeers = static_cast<double>(link_->numPeers());
+    snapshot.isPlaying = state.isPlaying();
+    if (info.Length() > 1 && !info[1].IsUndefined()) {
+        allocationsAvoided_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return LinkStateToValue(info, snapshot);
+}
+
 Napi::Value AbletonLinkAudioWrapper::IsLinkAudioEnabled(
     const Napi::CallbackInfo& info) {
     return Napi::Boolean::New(info.Env(), link_->isLinkAudioEnabled());
@@ -533,13 +632,24 @@ void AbletonLinkAudioWrapper::SetChannelsChangedCallback(
             .ThrowAsJavaScriptException();
         return;
     }
+    if (!RequireOwner(info.Env())) {
+        return;
+    }
+
+    bool diff = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        const auto option = info[1].As<Napi::Object>().Get("diff");
+        diff = option.IsBoolean() && option.As<Napi::Boolean>().Value();
+    }
 
     std::lock_guard<std::mutex> lock(callbackMutex_);
     if (channelsChangedCallback_) {
         channelsChangedCallback_.Abort();
+        channelsStats_.Aborted();
         channelsChangedCallback_.Release();
     }
 
+    channelsDiff_ = diff;
     channelsChangedCallback_ = Napi::ThreadSafeFunction::New(
         info.Env(), info[0].As<Napi::Function>(), "ChannelsChangedCallback", 0, 1);
     channelsChangedCallback_.Unref(info.Env());
@@ -548,20 +658,65 @@ void AbletonLinkAudioWrapper::SetChannelsChangedCallback(
 }
 
 Napi::Value AbletonLinkAudioWrapper::Channels(const Napi::CallbackInfo& info) {
-    const auto channels = link_->channels();
-    auto result = Napi::Array::New(info.Env(), channels.size());
-    for (size_t i = 0; i < channels.size(); ++i) {
-        const auto& channel = channels[i];
-        auto obj = Napi::Object::New(info.Env());
-        obj.Set("id", NodeIdToHexString(channel.id));
-        obj.Set("name", channel.name);
-        obj.Set("peerId", NodeIdToHexString(channel.peerId));
-        obj.Set("peerName", channel.peerName);
-        result.Set(i, obj);
+    RefreshChannels();
+    return ChannelsToArray(info.Env(), channelDirectory_->Entries());
+}
+
+Napi::Value AbletonLinkAudioWrapper::FindChannels(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(info.Env(), "Query object ({ id, name, peer }) expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    RefreshChannels();
+
+    auto query = info[0].As<Napi::Object>();
+    const auto id = query.Get("id");
+    const auto name = query.Get("name");
+    const auto peer = query.Get("peer");
+    std::vector<const LinkChannelEntry*> matches;
+    if (id.IsString()) {
+        if (const auto* entry = channelDirectory_->FindById(id.As<Napi::String>().Utf8Value())) {
+            matches.push_back(entry);
+        }
+    } else if (name.IsString()) {
+        matches = channelDirectory_->FindByName(name.As<Napi::String>().Utf8Value());
+    } else if (peer.IsString()) {
+        matches = channelDirectory_->FindByPeer(peer.As<Napi::String>().Utf8Value());
+    } else {
+        for (const auto& entry : channelDirectory_->Entries()) {
+            matches.push_back(&entry);
+        }
+    }
+
+    // Remaining criteria narrow the indexed lookup.
+    const auto peerKey = peer.IsString() ? peer.As<Napi::String>().Utf8Value() : "";
+    const auto nameKey = name.IsString() ? name.As<Napi::String>().Utf8Value() : "";
+    auto result = Napi::Array::New(info.Env());
+    uint32_t count = 0;
+    for (const auto* entry : matches) {
+        if (name.IsString() && entry->name != nameKey) {
+            continue;
+        }
+        if (peer.IsString() && entry->peerId != peerKey && entry->peerName != peerKey) {
+            continue;
+        }
+        result.Set(count++, ChannelToObject(info.Env(), *entry));
     }
     return result;
 }
 
+void AbletonLinkAudioWrapper::RefreshChannels() {
+    if (!link_ || !channelDirectory_) {
+        return;
+    }
+    // Clear the flag before reading so a change during the read marks it again.
+    // Attached handles receive no change notifications and always re-read.
+    if (channelsDirty_.exchange(false) || !owner_) {
+        channelDirectory_->Refresh(link_->channels());
+    }
+}
+
 void AbletonLinkAudioWrapper::CallOnLinkThread(const Napi::CallbackInfo& info) {
     if (info.Length() < 1 || !info[0].IsFunction()) {
         Napi::TypeError::New(info.Env(), "Function expected")
@@ -569,21 +724,129 @@ void AbletonLinkAudioWrapper::CallOnLinkThread(const Napi::CallbackInfo& info) {
         return;
     }
 
-    auto tsfn = std::make_shared<Napi::ThreadSafeFunction>(
-        Napi::ThreadSafeFunction::New(
-            info.Env(), info[0].As<Napi::Function>(), "LinkThreadCall", 0, 1));
-    tsfn->Unref(info.Env());
+    LinkTask task;
+    task.callback = Napi::Persistent(info[0].As<Napi::Function>());
+    SubmitLinkTask(info.Env(), std::move(task));
+}
 
-    link_->callOnLinkThread([tsfn]() {
-        tsfn->BlockingCall([](Napi::Env env, Napi::Function callback) {
-            callback.Call({});
-        });
-        tsfn->Release();
-    });
+Napi::Value AbletonLinkAudioWrapper::RunOnLinkThread(const Napi::CallbackInfo& info) {
+    if (info.Length() > 0 && !info[0].IsFunction() && !info[0].IsUndefined()) {
+        Napi::TypeError::New(info.Env(), "Function expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+
+    LinkTask task;
+    if (info.Length() > 0 && info[0].IsFunction()) {
+        task.callback = Napi::Persistent(info[0].As<Napi::Function>());
+    }
+    task.deferred = std::make_unique<Napi::Promise::Deferred>(info.Env());
+    auto promise = task.deferred->Promise();
+    SubmitLinkTask(info.Env(), std::move(task));
+    return promise;
+}
+
+void AbletonLinkAudioWrapper::SubmitLinkTask(Napi::Env env, LinkTask task) {
+    if (!link_) {
+        auto error = Napi::Error::New(env, "AbletonLinkAudio is closed");
+        if (task.deferred) {
+            task.deferred->Reject(error.Value());
+        } else {
+            error.ThrowAsJavaScriptException();
+        }
+        return;
+    }
+    if (!linkTaskQueue_) {
+        linkTaskQueue_ = Napi::ThreadSafeFunction::New(
+            env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+            "LinkThreadTasks", 0, 1);
+        linkTaskQueue_.Unref(env);
+    }
+
+    const auto id = nextLinkTaskId_++;
+    linkTasks_.emplace(id, std::move(task));
+    if (linkTasks_.size() == 1) {
+        // Pending tasks keep the process alive, like a pending setImmediate.
+        linkTaskQueue_.Ref(env);
+    }
+    link_->callOnLinkThread([this, id]() { CompleteLinkTask(id); });
+}
+
+void AbletonLinkAudioWrapper::CompleteLinkTask(uint64_t id) {
+    std::lock_guard<std::mutex> lock(linkTaskMutex_);
+    if (linkTasksClosed_) {
+        return;
+    }
+    completedLinkTasks_.push_back(id);
+    if (linkTaskDispatchPending_) {
+        return;
+    }
+    linkTaskDispatchPending_ = true;
+    const auto status = linkTaskQueue_.NonBlockingCall(
+        [this](Napi::Env env, Napi::Function) { DrainLinkTasks(env); });
+    if (status != napi_ok) {
+        linkTaskDispatchPending_ = false;
+    }
+}
+
+void AbletonLinkAudioWrapper::DrainLinkTasks(Napi::Env env) {
+    std::vector<uint64_t> completed;
+    {
+        std::lock_guard<std::mutex> lock(linkTaskMutex_);
+        completed.swap(completedLinkTasks_);
+        linkTaskDispatchPending_ = false;
+    }
+
+    // callOnLinkThread callbacks that throw are rethrown once the batch is done,
+    // so one failing callback does not starve the rest.
+    Napi::Value firstError;
+    for (const auto id : completed) {
+        auto it = linkTasks_.find(id);
+        if (it == linkTasks_.end()) {
+            continue;
+        }
+        auto task = std::move(it->second);
+        linkTasks_.erase(it);
+
+        Napi::Value result = env.Undefined();
+        if (!task.callback.IsEmpty()) {
+            result = task.callback.Value().Call({});
+        }
+        if (env.IsExceptionPending()) {
+            auto error = env.GetAndClearPendingException();
+            if (task.deferred) {
+                task.deferred->Reject(error.Value());
+            } else if (firstError.IsEmpty()) {
+                firstError = error.Value();
+            }
+            continue;
+        }
+        if (task.deferred) {
+            task.deferred->Resolve(result);
+        }
+    }
+
+    if (linkTasks_.empty() && linkTaskQueue_) {
+        linkTaskQueue_.Unref(env);
+    }
+    if (!firstError.IsEmpty()) {
+        Napi::Error(env, firstError).ThrowAsJavaScriptException();
+    }
+}
+
+void AbletonLinkAudioWrapper::RejectLinkTasks(Napi::Env env) {
+    for (auto& entry : linkTasks_) {
+        if (entry.second.deferred) {
+            entry.second.deferred->Reject(
+                Napi::Error::New(env, "AbletonLinkAudio closed").Value());
+        }
+    }
+    linkTasks_.clear();
 }
 
 Napi::Value AbletonLinkAudioWrapper::CaptureAppSessionState(
     const Napi::CallbackInfo& info) {
+    TraceSpan span("session", "captureAppSessionState");
     return AbletonLinkAudioSessionStateWrapper::New(
         info.Env(), link_->captureAppSessionState());
 }
@@ -601,6 +864,7 @@ void AbletonLinkAudioWrapper::CommitAppSessionState(const Napi::CallbackInfo& in
 
 Napi::Value AbletonLinkAudioWrapper::CaptureAudioSessionState(
     const Napi::CallbackInfo& info) {
+    TraceSpan span("session", "captureAudioSessionState");
     return AbletonLinkAudioSessionStateWrapper::New(
         info.Env(), link_->captureAudioSessionState());
 }
@@ -616,22 +880,80 @@ void AbletonLinkAudioWrapper::CommitAudioSessionState(const Napi::CallbackInfo&
     link_->commitAudioSessionState(wrapper->State());
 }
 
+// The *Into variants overwrite a caller-owned session state in place so that
+// per-buffer loops do not create a new wrapper (and heap state) on every call.
+Napi::Value AbletonLinkAudioWrapper::CaptureAppSessionStateInto(
+    const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(info.Env(), "SessionState object expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    auto* wrapper = Napi::ObjectWrap<AbletonLinkAudioSessionStateWrapper>::Unwrap(
+        info[0].As<Napi::Object>());
+    if (wrapper == nullptr) {
+        return info.Env().Null();
+    }
+    TraceSpan span("session", "captureAppSessionStateInto");
+    wrapper->State() = link_->captureAppSessionState();
+    allocationsAvoided_.fetch_add(1, std::memory_order_relaxed);
+    return info[0];
+}
+
+Napi::Value AbletonLinkAudioWrapper::CaptureAudioSessionStateInto(
+    const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(info.Env(), "SessionState object expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    auto* wrapper = Napi::ObjectWrap<AbletonLinkAudioSessionStateWrapper>::Unwrap(
+        info[0].As<Napi::Object>());
+    if (wrapper == nullptr) {
+        return info.Env().Null();
+    }
+    TraceSpan span("session", "captureAudioSessionStateInto");
+    wrapper->State() = link_->captureAudioSessionState();
+    allocationsAvoided_.fetch_add(1, std::memory_order_relaxed);
+    return info[0];
+}
+
+Napi::Value AbletonLinkAudioWrapper::GetStats(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    auto callbacks = Napi::Object::New(env);
+    callbacks.Set("numPeers", numPeersStats_.ToObject(env));
+    callbacks.Set("tempo", tempoStats_.ToObject(env));
+    callbacks.Set("startStop", startStopStats_.ToObject(env));
+    callbacks.Set("channels", channelsStats_.ToObject(env));
+    callbacks.Set("events", eventStats_.ToObject(env));
+    auto result = Napi::Object::New(env);
+    result.Set("callbacks", callbacks);
+    result.Set("allocationsAvoided",
+               static_cast<double>(allocationsAvoided_.load(std::memory_order_relaxed)));
+    return result;
+}
+
 void AbletonLinkAudioWrapper::SetNumPeersCallback(const Napi::CallbackInfo& info) {
     if (info.Length() < 1 || !info[0].IsFunction()) {
         Napi::TypeError::New(info.Env(), "Function expected")
             .ThrowAsJavaScriptException();
         return;
     }
+    if (!RequireOwner(info.Env())) {
+        return;
+    }
 
     std::lock_guard<std::mutex> lock(callbackMutex_);
     if (numPeersCallback_) {
         numPeersCallback_.Abort();
+        numPeersStats_.Aborted();
         numPeersCallback_.Release();
     }
 
     numPeersCallback_ = Napi::ThreadSafeFunction::New(
         info.Env(), info[0].As<Napi::Function>(), "NumPeersCallback", 0, 1);
     numPeersCallback_.Unref(info.Env());
+    numPeersLatest_ = ParseCoalesceOption(info, 1);
 
     link_->setNumPeersCallback([this](std::size_t numPeers) {
         handleNumPeersCallback(numPeers);
@@ -644,16 +966,21 @@ void AbletonLinkAudioWrapper::SetTempoCallback(const Napi::CallbackInfo& info) {
             .ThrowAsJavaScriptException();
         return;
     }
+    if (!RequireOwner(info.Env())) {
+        return;
+    }
 
     std::lock_guard<std::mutex> lock(callbackMutex_);
     if (tempoCallback_) {
         tempoCallback_.Abort();
+        tempoStats_.Aborted();
         tempoCallback_.Release();
     }
 
     tempoCallback_ = Napi::ThreadSafeFunction::New(
         info.Env(), info[0].As<Napi::Function>(), "TempoCallback", 0, 1);
     tempoCallback_.Unref(info.Env());
+    tempoLatest_ = ParseCoalesceOption(info, 1);
 
     link_->setTempoCallback([this](double tempo) { handleTempoCallback(tempo); });
 }
@@ -664,24 +991,125 @@ void AbletonLinkAudioWrapper::SetStartStopCallback(const Napi::CallbackInfo& inf
             .ThrowAsJavaScriptException();
         return;
     }
+    if (!RequireOwner(info.Env())) {
+        return;
+    }
 
     std::lock_guard<std::mutex> lock(callbackMutex_);
     if (startStopCallback_) {
         startStopCallback_.Abort();
+        startStopStats_.Aborted();
         startStopCallback_.Release();
     }
 
     startStopCallback_ = Napi::ThreadSafeFunction::New(
         info.Env(), info[0].As<Napi::Function>(), "StartStopCallback", 0, 1);
     startStopCallback_.Unref(info.Env());
+    startStopLatest_ = ParseCoalesceOption(info, 1);
+
+    link_->setStartStopCallback([this](bool isPlaying) {
+        handleStartStopCallback(isPlaying);
+    });
+}
+
+void AbletonLinkAudioWrapper::SetEventCallback(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || (!info[0].IsFunction() && !info[0].IsNull())) {
+        Napi::TypeError::New(info.Env(), "Function or null expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    if (!RequireOwner(info.Env())) {
+        return;
+    }
 
+    {
+        std::lock_guard<std::mutex> lock(eventMutex_);
+        if (eventCallback_) {
+            eventCallback_.Abort();
+            eventStats_.Aborted();
+            eventCallback_.Release();
+            eventCallback_ = Napi::ThreadSafeFunction();
+        }
+        pendingEvents_.clear();
+        eventDispatchPending_ = false;
+        if (info[0].IsNull()) {
+            return;
+        }
+
+        eventCallback_ = Napi::ThreadSafeFunction::New(
+            info.Env(), info[0].As<Napi::Function>(), "LinkEventCallback", 0, 1);
+        eventCallback_.Unref(info.Env());
+    }
+
+    // Route every Link notification through the handlers, which feed both the
+    // event stream and any per-type callbacks.
+    link_->setNumPeersCallback([this](std::size_t numPeers) {
+        handleNumPeersCallback(numPeers);
+    });
+    link_->setTempoCallback([this](double tempo) { handleTempoCallback(tempo); });
     link_->setStartStopCallback([this](bool isPlaying) {
         handleStartStopCallback(isPlaying);
     });
+    link_->setChannelsChangedCallback([this]() { handleChannelsChangedCallback(); });
 }
 
 void AbletonLinkAudioWrapper::Close(const Napi::CallbackInfo& info) {
     CloseInternal();
+    RejectLinkTasks(info.Env());
+}
+
+Napi::Value AbletonLinkAudioWrapper::Share(const Napi::CallbackInfo& info) {
+    if (!link_) {
+        Napi::Error::New(info.Env(), "AbletonLinkAudio is closed").ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    if (!RequireOwner(info.Env())) {
+        return info.Env().Null();
+    }
+    if (shareKey_.empty()) {
+        std::lock_guard<std::mutex> lock(sharedLinksMutex);
+        shareKey_ = "link-audio:" + std::to_string(nextSharedLinkId++);
+        sharedLinks.emplace(shareKey_, link_);
+    }
+    return Napi::String::New(info.Env(), shareKey_);
+}
+
+Napi::Value AbletonLinkAudioWrapper::Attach(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(info.Env(), "Share key (string) expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    std::shared_ptr<ableton::LinkAudio> link;
+    {
+        std::lock_guard<std::mutex> lock(sharedLinksMutex);
+        const auto it = sharedLinks.find(info[0].As<Napi::String>().Utf8Value());
+        if (it != sharedLinks.end()) {
+            link = it->second.lock();
+        }
+    }
+    if (!link) {
+        Napi::Error::New(info.Env(), "No shared AbletonLinkAudio for this key")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    // The constructor copies the pointer before New() returns.
+    return AddonData(info.Env()).linkAudio.New(
+        {Napi::External<std::shared_ptr<ableton::LinkAudio>>::New(info.Env(), &link)});
+}
+
+Napi::Value AbletonLinkAudioWrapper::IsAttached(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), !owner_);
+}
+
+bool AbletonLinkAudioWrapper::RequireOwner(Napi::Env env) {
+    if (owner_) {
+        return true;
+    }
+    Napi::Error::New(env,
+                     "Link callbacks can only be set on the instance that called share()")
+        .ThrowAsJavaScriptException();
+    return false;
 }
 
 std::chrono::microseconds AbletonLinkAudioWrapper::getCurrentTime() const {
@@ -689,71 +1117,196 @@ std::chrono::microseconds AbletonLinkAudioWrapper::getCurrentTime() const {
 }
 
 void AbletonLinkAudioWrapper::handleNumPeersCallback(std::size_t numPeers) {
+    numPeersStats_.Fired();
+    PushEvent(kLinkEventPeers, static_cast<double>(numPeers));
     std::lock_guard<std::mutex> lock(callbackMutex_);
-    if (numPeersCallback_) {
-        numPeersCallback_.BlockingCall([numPeers](Napi::Env env, Napi::Function callback) {
-            callback.Call({Napi::Number::New(env, static_cast<double>(numPeers))});
-        });
+    if (numPeersCallback_ && numPeersLatest_) {
+        PostCoalesced(
+            numPeersCallback_, numPeersLatest_, static_cast<double>(numPeers),
+            [](Napi::Env env, double value) { return Napi::Number::New(env, value); },
+            &numPeersStats_);
+    } else if (numPeersCallback_) {
+        PostCounted(numPeersCallback_, numPeersStats_,
+                    [numPeers](Napi::Env env, Napi::Function callback) {
+                        callback.Call({Napi::Number::New(env, static_cast<double>(numPeers))});
+                    });
     }
 }
 
 void AbletonLinkAudioWrapper::handleTempoCallback(double tempo) {
+    tempoStats_.Fired();
+    PushEvent(kLinkEventTempo, tempo);
     std::lock_guard<std::mutex> lock(callbackMutex_);
-    if (tempoCallback_) {
-        tempoCallback_.BlockingCall([tempo](Napi::Env env, Napi::Function callback) {
+    if (tempoCallback_ && tempoLatest_) {
+        PostCoalesced(
+            tempoCallback_, tempoLatest_, tempo,
+            [](Napi::Env env, double value) { return Napi::Number::New(env, value); },
+            &tempoStats_);
+    } else if (tempoCallback_) {
+        PostCounted(tempoCallback_, tempoStats_, [tempo](Napi::Env env, Napi::Function callback) {
             callback.Call({Napi::Number::New(env, tempo)});
         });
     }
 }
 
 void AbletonLinkAudioWrapper::handleStartStopCallback(bool isPlaying) {
+    startStopStats_.Fired();
+    PushEvent(kLinkEventStartStop, isPlaying ? 1.0 : 0.0);
     std::lock_guard<std::mutex> lock(callbackMutex_);
-    if (startStopCallback_) {
-        startStopCallback_.BlockingCall([isPlaying](Napi::Env env, Napi::Function callback) {
-            callback.Call({Napi::Boolean::New(env, isPlaying)});
-        });
+    if (startStopCallback_ && startStopLatest_) {
+        PostCoalesced(
+            startStopCallback_, startStopLatest_, isPlaying ? 1.0 : 0.0,
+            [](Napi::Env env, double value) { return Napi::Boolean::New(env, value != 0.0); },
+            &startStopStats_);
+    } else if (startStopCallback_) {
+        PostCounted(startStopCallback_, startStopStats_,
+                    [isPlaying](Napi::Env env, Napi::Function callback) {
+                        callback.Call({Napi::Boolean::New(env, isPlaying)});
+                    });
     }
 }
 
 void AbletonLinkAudioWrapper::handleChannelsChangedCallback() {
+    channelsDirty_.store(true);
+    channelsStats_.Fired();
+    PushEvent(kLinkEventChannels, 0.0);
     std::lock_guard<std::mutex> lock(callbackMutex_);
-    if (channelsChangedCallback_) {
-        channelsChangedCallback_.BlockingCall(
-            [](Napi::Env env, Napi::Function callback) { callback.Call({}); });
+    if (channelsChangedCallback_ && !channelsDiff_) {
+        PostCounted(channelsChangedCallback_, channelsStats_,
+                    [](Napi::Env env, Napi::Function callback) { callback.Call({}); });
+    } else if (channelsChangedCallback_) {
+        PostCounted(
+            channelsChangedCallback_, channelsStats_,
+            [this](Napi::Env env, Napi::Function callback) {
+                // Diff against what the callback last saw. Notifications that
+                // were already covered by an earlier diff are dropped.
+                RefreshChannels();
+                auto diff = channelDirectory_->TakeDiff();
+                if (diff.Empty()) {
+                    return;
+                }
+                auto change = Napi::Object::New(env);
+                change.Set("added", ChannelsToArray(env, diff.added));
+                change.Set("removed", ChannelsToArray(env, diff.removed));
+                change.Set("renamed", ChannelsToArray(env, diff.renamed));
+                callback.Call({change});
+            });
+    }
+}
+
+void AbletonLinkAudioWrapper::PushEvent(LinkEventType type, double value) {
+    std::lock_guard<std::mutex> lock(eventMutex_);
+    if (!eventCallback_) {
+        return;
+    }
+    pendingEvents_.push_back(static_cast<double>(type));
+    pendingEvents_.push_back(getCurrentTime().count() / 1000000.0);
+    pendingEvents_.push_back(value);
+    eventStats_.Fired();
+    if (eventDispatchPending_) {
+        return;
+    }
+    eventDispatchPending_ = true;
+    const auto postedAt = eventStats_.Posted();
+    const auto status = eventCallback_.NonBlockingCall(
+        [this, postedAt](Napi::Env env, Napi::Function callback) {
+            eventStats_.Delivered(postedAt);
+            TraceSpan span(eventStats_.name, "js.callback");
+            DispatchEvents(env, callback);
+        });
+    if (status != napi_ok) {
+        eventDispatchPending_ = false;
+        eventStats_.Dropped();
     }
 }
 
+void AbletonLinkAudioWrapper::DispatchEvents(Napi::Env env, Napi::Function callback) {
+    std::vector<double> batch;
+    {
+        std::lock_guard<std::mutex> lock(eventMutex_);
+        batch.swap(pendingEvents_);
+        eventDispatchPending_ = false;
+    }
+    if (batch.empty()) {
+        return;
+    }
+    auto events = Napi::Float64Array::New(env, batch.size());
+    std::memcpy(events.Data(), batch.data(), batch.size() * sizeof(double));
+    callback.Call({events});
+}
+
 void AbletonLinkAudioWrapper::CloseInternal() {
     if (!link_) {
         return;
     }
 
+    dependents_.CloseAll();
+
     {
         std::lock_guard<std::mutex> lock(callbackMutex_);
         if (numPeersCallback_) {
             numPeersCallback_.Abort();
+            numPeersStats_.Aborted();
             numPeersCallback_.Release();
         }
         if (tempoCallback_) {
             tempoCallback_.Abort();
+            tempoStats_.Aborted();
             tempoCallback_.Release();
         }
         if (startStopCallback_) {
             startStopCallback_.Abort();
+            startStopStats_.Aborted();
             startStopCallback_.Release();
         }
         if (channelsChangedCallback_) {
             channelsChangedCallback_.Abort();
+            channelsStats_.Aborted();
             channelsChangedCallback_.Release();
         }
     }
+    {
+        std::lock_guard<std::mutex> lock(eventMutex_);
+        if (eventCallback_) {
+            eventCallback_.Abort();
+            eventStats_.Aborted();
+            eventCallback_.Release();
+            eventCallback_ = Napi::ThreadSafeFunction();
+        }
+        pendingEvents_.clear();
+    }
+    {
+        // Link-thread tasks that complete while Link shuts down are dropped.
+        std::lock_guard<std::mutex> lock(linkTaskMutex_);
+        linkTasksClosed_ = true;
+        completedLinkTasks_.clear();
+        if (linkTaskQueue_) {
+            linkTaskQueue_.Abort();
+            linkTaskQueue_.Release();
+            linkTaskQueue_ = Napi::ThreadSafeFunction();
+        }
+    }
 
-    link_->setNumPeersCallback([](std::size_t) {});
-    link_->setTempoCallback([](double) {});
-    link_->setStartStopCallback([](bool) {});
-    link_->setChannelsChangedCallback([]() {});
-    link_->enableLinkAudio(false);
-    link_->enable(false);
+    if (owner_) {
+        link_->setNumPeersCallback([](std::size_t) {});
+        link_->setTempoCallback([](double) {});
+        link_->setStartStopCallback([](bool) {});
+        link_->setChannelsChangedCallback([]() {});
+    }
+    if (!shareKey_.empty() || !owner_) {
+        if (!shareKey_.empty()) {
+            std::lock_guard<std::mutex> lock(sharedLinksMutex);
+            sharedLinks.erase(shareKey_);
+            shareKey_.clear();
+        }
+        // Other handles may keep Link running, so wait until the Link thread
+        // has finished any callback or task that still refers to this handle.
+        std::promise<void> flushed;
+        auto done = flushed.get_future();
+        link_->callOnLinkThread([&flushed]() { flushed.set_value(); });
+        done.wait();
+    }
+    // Leaves the session if this was the last handle (see MakeLinkAudio).
     link_.reset();
 }
 
@@ -771,18 +1324,22 @@ Napi::Object AbletonLinkAudioSinkBufferHandleWrapper::Init(
             InstanceMethod("commit", &AbletonLinkAudioSinkBufferHandleWrapper::Commit),
         });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    AddonData(env).sinkBufferHandle = Napi::Persistent(func);
     exports.Set("AbletonLinkAudioSinkBufferHandle", func);
     return exports;
 }
 
 Napi::Object AbletonLinkAudioSinkBufferHandleWrapper::New(
-    Napi::Env env, std::unique_ptr<ableton::LinkAudioSink::BufferHandle> handle) {
+    Napi::Env env,
+    std::unique_ptr<ableton::LinkAudioSink::BufferHandle> handle,
+    std::shared_ptr<ableton::LinkAudioSink> sink,
+    std::shared_ptr<SinkStats> stats) {
     Napi::EscapableHandleScope scope(env);
-    auto obj = constructor.New({});
+    auto obj = AddonData(env).sinkBufferHandle.New({});
     auto* wrapper = Napi::ObjectWrap<AbletonLinkAudioSinkBufferHandleWrapper>::Unwrap(obj);
     wrapper->handle_ = std::move(handle);
+    wrapper->sink_ = std::move(sink);
+    wrapper->stats_ = std::move(stats);
     if (wrapper->handle_ && static_cast<bool>(*wrapper->handle_)) {
         auto* samples = wrapper->handle_->samples;
         const auto maxSamples = wrapper->handle_->maxNumSamples;
@@ -851,12 +1408,16 @@ Napi::Value AbletonLinkAudioSinkBufferHandleWrapper::Commit(
         static_cast<size_t>(info[4].As<Napi::Number>().Uint32Value());
     const auto sampleRate =
         static_cast<uint32_t>(info[5].As<Napi::Number>().Uint32Value());
+    TraceSpan span("sink", "commit");
     const auto result = handle_->commit(stateWrapper->State(),
                                         beatsAtBufferBegin,
                                         quantum,
                                         numFrames,
                                         numChannels,
                                         sampleRate);
+    if (stats_) {
+        stats_->Committed(result, numFrames * numChannels * sizeof(int16_t));
+    }
     return Napi::Boolean::New(info.Env(), result);
 }
 
@@ -870,10 +1431,11 @@ Napi::Object AbletonLinkAudioSinkWrapper::Init(Napi::Env env, Napi::Object expor
                        &AbletonLinkAudioSinkWrapper::RequestMaxNumSamples),
         InstanceMethod("maxNumSamples", &AbletonLinkAudioSinkWrapper::MaxNumSamples),
         InstanceMethod("retainBuffer", &AbletonLinkAudioSinkWrapper::RetainBuffer),
+        InstanceMethod("getStats", &AbletonLinkAudioSinkWrapper::GetStats),
+        InstanceMethod("close", &AbletonLinkAudioSinkWrapper::Close),
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    AddonData(env).sink = Napi::Persistent(func);
     exports.Set("AbletonLinkAudioSink", func);
     return exports;
 }
@@ -890,12 +1452,15 @@ AbletonLinkAudioSinkWrapper::AbletonLinkAudioSinkWrapper(const Napi::CallbackInf
     }
     auto* linkWrapper = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(
         info[0].As<Napi::Object>());
+    link_ = linkWrapper->LinkAudioRef();
+    if (!link_) {
+        Napi::Error::New(info.Env(), "AbletonLinkAudio is closed").ThrowAsJavaScriptException();
+        return;
+    }
     const auto name = info[1].As<Napi::String>().Utf8Value();
     const auto maxNumSamples =
         static_cast<size_t>(info[2].As<Napi::Number>().Uint32Value());
-    sink_ = std::make_shared<ableton::LinkAudioSink>(linkWrapper->LinkAudio(),
-                                                     name,
-                                                     maxNumSamples);
+    sink_ = std::make_shared<ableton::LinkAudioSink>(*link_, name, maxNumSamples);
     linkRef_ = Napi::Persistent(info[0].As<Napi::Object>());
     linkRef_.SuppressDestruct();
 }
@@ -903,9 +1468,33 @@ AbletonLinkAudioSinkWrapper::AbletonLinkAudioSinkWrapper(const Napi::CallbackInf
 AbletonLinkAudioSinkWrapper::~AbletonLinkAudioSinkWrapper() {
     linkRef_.Reset();
     sink_.reset();
+    link_.reset();
+}
+
+bool AbletonLinkAudioSinkWrapper::IsInstance(const Napi::Object& object) {
+    return object.InstanceOf(AddonData(object.Env()).sink.Value());
+}
+
+std::shared_ptr<ableton::LinkAudioSink> AbletonLinkAudioSinkWrapper::Sink() const {
+    return sink_;
+}
+
+std::shared_ptr<SinkStats> AbletonLinkAudioSinkWrapper::Stats() const {
+    return stats_;
+}
+
+bool AbletonLinkAudioSinkWrapper::RequireOpen(Napi::Env env) {
+    if (!sink_) {
+        Napi::Error::New(env, "Sink is closed").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
 }
 
 Napi::Value AbletonLinkAudioSinkWrapper::Name(const Napi::CallbackInfo& info) {
+    if (!RequireOpen(info.Env())) {
+        return info.Env().Null();
+    }
     return Napi::String::New(info.Env(), sink_->name());
 }
 
@@ -915,6 +1504,9 @@ void AbletonLinkAudioSinkWrapper::SetName(const Napi::CallbackInfo& info) {
             .ThrowAsJavaScriptException();
         return;
     }
+    if (!RequireOpen(info.Env())) {
+        return;
+    }
     sink_->setName(info[0].As<Napi::String>().Utf8Value());
 }
 
@@ -924,20 +1516,47 @@ void AbletonLinkAudioSinkWrapper::RequestMaxNumSamples(const Napi::CallbackInfo&
             .ThrowAsJavaScriptException();
         return;
     }
+    if (!RequireOpen(info.Env())) {
+        return;
+    }
     sink_->requestMaxNumSamples(
         static_cast<size_t>(info[0].As<Napi::Number>().Uint32Value()));
 }
 
 Napi::Value AbletonLinkAudioSinkWrapper::MaxNumSamples(const Napi::CallbackInfo& info) {
+    if (!RequireOpen(info.Env())) {
+        return info.Env().Null();
+    }
     return Napi::Number::New(info.Env(), static_cast<double>(sink_->maxNumSamples()));
 }
 
 Napi::Value AbletonLinkAudioSinkWrapper::RetainBuffer(const Napi::CallbackInfo& info) {
+    if (!RequireOpen(info.Env())) {
+        return info.Env().Null();
+    }
+    TraceSpan span("sink", "retain");
     auto handle = std::make_unique<ableton::LinkAudioSink::BufferHandle>(*sink_);
-    if (!static_cast<bool>(*handle)) {
+    const auto retained = static_cast<bool>(*handle);
+    stats_->Retained(retained);
+    if (!retained) {
         return info.Env().Null();
     }
-    return AbletonLinkAudioSinkBufferHandleWrapper::New(info.Env(), std::move(handle));
+    return AbletonLinkAudioSinkBufferHandleWrapper::New(info.Env(), std::move(handle), sink_,
+                                                        stats_);
+}
+
+Napi::Value AbletonLinkAudioSinkWrapper::GetStats(const Napi::CallbackInfo& info) {
+    auto result = stats_->ToObject(info.Env());
+    result.Set("buffersPerSec",
+               rate_.Update(stats_->commits.load(std::memory_order_relaxed)));
+    return result;
+}
+
+void AbletonLinkAudioSinkWrapper::Close(const Napi::CallbackInfo& info) {
+    // The channel leaves the session once transports, mix buses and retained
+    // buffer handles using this sink have released it too.
+    sink_.reset();
+    linkRef_.Reset();
 }
 
 Napi::Object AbletonLinkAudioBufferInfoWrapper::Init(Napi::Env env,
@@ -956,8 +1575,7 @@ Napi::Object AbletonLinkAudioBufferInfoWrapper::Init(Napi::Env env,
         InstanceMethod("endBeats", &AbletonLinkAudioBufferInfoWrapper::EndBeats),
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    AddonData(env).bufferInfo = Napi::Persistent(func);
     exports.Set("AbletonLinkAudioBufferInfo", func);
     return exports;
 }
@@ -965,7 +1583,7 @@ Napi::Object AbletonLinkAudioBufferInfoWrapper::Init(Napi::Env env,
 Napi::Object AbletonLinkAudioBufferInfoWrapper::New(
     Napi::Env env, const ableton::LinkAudioSource::BufferHandle::Info& info) {
     Napi::EscapableHandleScope scope(env);
-    auto obj = constructor.New({});
+    auto obj = AddonData(env).bufferInfo.New({});
     auto* wrapper = Napi::ObjectWrap<AbletonLinkAudioBufferInfoWrapper>::Unwrap(obj);
     wrapper->info_ = info;
     return scope.Escape(napi_value(obj)).ToObject();
@@ -1039,11 +1657,11 @@ Napi::Object AbletonLinkAudioSourceWrapper::Init(Napi::Env env, Napi::Object exp
     Napi::HandleScope scope(env);
     Napi::Function func = DefineClass(env, "AbletonLinkAudioSource", {
         InstanceMethod("id", &AbletonLinkAudioSourceWrapper::Id),
+        InstanceMethod("getStats", &AbletonLinkAudioSourceWrapper::GetStats),
         InstanceMethod("close", &AbletonLinkAudioSourceWrapper::Close),
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    AddonData(env).source = Napi::Persistent(func);
     exports.Set("AbletonLinkAudioSource", func);
     return exports;
 }
@@ -1058,9 +1676,37 @@ AbletonLinkAudioSourceWrapper::AbletonLinkAudioSourceWrapper(const Napi::Callbac
             .ThrowAsJavaScriptException();
         return;
     }
+    bool align = false;
+    if (info.Length() > 3 && info[3].IsObject()) {
+        auto options = info[3].As<Napi::Object>();
+        if (options.Get("align").IsBoolean()) {
+            align = options.Get("align").As<Napi::Boolean>().Value();
+        }
+        if (options.Get("quantum").IsNumber()) {
+            quantum_ = options.Get("quantum").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("targetLatencyMs").IsNumber()) {
+            targetLatency_ =
+                options.Get("targetLatencyMs").As<Napi::Number>().DoubleValue() * 1000.0;
+        }
+    }
+    if (!(quantum_ > 0.0)) {
+        Napi::TypeError::New(info.Env(), "Quantum must be positive").ThrowAsJavaScriptException();
+        return;
+    }
+    if (!(targetLatency_ >= 0.0) || !std::isfinite(targetLatency_)) {
+        Napi::TypeError::New(info.Env(), "targetLatencyMs must be a non-negative number")
+            .ThrowAsJavaScriptException();
+        return;
+    }
 
     auto* linkWrapper = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(
         info[0].As<Napi::Object>());
+    link_ = linkWrapper->LinkAudioRef();
+    if (!link_) {
+        Napi::Error::New(info.Env(), "AbletonLinkAudio is closed").ThrowAsJavaScriptException();
+        return;
+    }
     const auto idStr = info[1].As<Napi::String>().Utf8Value();
     ableton::ChannelId channelId{};
     if (!ParseNodeIdString(idStr, channelId)) {
@@ -1072,8 +1718,14 @@ AbletonLinkAudioSourceWrapper::AbletonLinkAudioSourceWrapper(const Napi::Callbac
         info.Env(), info[2].As<Napi::Function>(), "LinkAudioSourceCallback", 0, 1);
     bufferCallback_.Unref(info.Env());
 
+    if (align) {
+        alignment_ = linkWrapper->Alignment();
+        alignmentId_ = alignment_->Add(targetLatency_);
+        delayRunning_ = true;
+        delayThread_ = std::thread([this]() { RunDelay(); });
+    }
     source_ = std::make_shared<ableton::LinkAudioSource>(
-        linkWrapper->LinkAudio(),
+        *link_,
         channelId,
         [this](auto handle) { handleBuffer(handle); });
     linkRef_ = Napi::Persistent(info[0].As<Napi::Object>());
@@ -1089,11 +1741,22 @@ void AbletonLinkAudioSourceWrapper::Close(const Napi::CallbackInfo& info) {
 }
 
 void AbletonLinkAudioSourceWrapper::CloseInternal() {
+    // Stop both posting threads, the Link thread and the delay thread, before
+    // the callback they post to goes away.
+    source_.reset();
+    StopDelay();
     if (bufferCallback_) {
         bufferCallback_.Abort();
         bufferCallback_.Release();
+        bufferCallback_ = Napi::ThreadSafeFunction();
+        // No buffer can be posted any more.
+        buffers_.Aborted();
     }
-    source_.reset();
+    if (alignment_) {
+        alignment_->Remove(alignmentId_);
+        alignment_.reset();
+    }
+    link_.reset();
     linkRef_.Reset();
 }
 
@@ -1104,22 +1767,125 @@ Napi::Value AbletonLinkAudioSourceWrapper::Id(const Napi::CallbackInfo& info) {
     return Napi::String::New(info.Env(), NodeIdToHexString(source_->id()));
 }
 
+Napi::Value AbletonLinkAudioSourceWrapper::GetStats(const Napi::CallbackInfo& info) {
+    auto result = Napi::Object::New(info.Env());
+    result.Set("buffers", buffers_.ToObject(info.Env()));
+    result.Set("bytesCopied", static_cast<double>(bytesCopied_));
+    result.Set("buffersPerSec",
+               rate_.Update(buffers_.delivered.load(std::memory_order_relaxed)));
+    result.Set("latency", latency_.ToObject(info.Env()));
+    if (alignment_) {
+        auto alignment = Napi::Object::New(info.Env());
+        alignment.Set("targetMs", alignment_->Target() / 1000.0);
+        alignment.Set("buffersDelayed",
+                      static_cast<double>(buffersDelayed_.load(std::memory_order_relaxed)));
+        alignment.Set("buffersLate",
+                      static_cast<double>(buffersLate_.load(std::memory_order_relaxed)));
+        result.Set("alignment", alignment);
+    } else {
+        result.Set("alignment", info.Env().Null());
+    }
+    return result;
+}
+
 void AbletonLinkAudioSourceWrapper::handleBuffer(
     const ableton::LinkAudioSource::BufferHandle& handle) {
+    buffers_.Fired();
+    TraceInstant(buffers_.name, "buffer");
+
+    // Buffers from another session have no place on the local timeline and
+    // are neither measured nor delayed.
+    const auto arrival = link_->clock().micros();
+    const auto state = link_->captureAppSessionState();
+    const auto begin = handle.info.beginBeats(state, quantum_);
+    std::chrono::microseconds beatTime{0};
+    if (begin) {
+        beatTime = state.timeAtBeat(*begin, quantum_);
+        latency_.Record(static_cast<double>((arrival - beatTime).count()));
+        if (alignment_) {
+            alignment_->Update(alignmentId_, std::max(latency_.Budget(), targetLatency_));
+        }
+    }
     if (!bufferCallback_) {
         return;
     }
 
-    bufferCallback_.BlockingCall(
-        [handle](Napi::Env env, Napi::Function callback) {
-            const auto numSamples = handle.info.numFrames * handle.info.numChannels;
-            auto samples = Napi::Buffer<int16_t>::Copy(env, handle.samples, numSamples);
-            auto info = AbletonLinkAudioBufferInfoWrapper::New(env, handle.info);
-            auto payload = Napi::Object::New(env);
-            payload.Set("samples", samples);
-            payload.Set("info", info);
-            callback.Call({payload});
-        });
+    if (alignment_ && begin) {
+        const auto due =
+            beatTime + std::chrono::microseconds(std::llround(alignment_->Target()));
+        if (due > arrival) {
+            DelayedBuffer buffer;
+            buffer.due = due;
+            buffer.info = handle.info;
+            buffer.samples.assign(handle.samples,
+                                  handle.samples + handle.info.numFrames * handle.info.numChannels);
+            {
+                std::lock_guard<std::mutex> lock(delayMutex_);
+                delayed_.push_back(std::move(buffer));
+            }
+            delayWake_.notify_one();
+            buffersDelayed_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        buffersLate_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    PostCounted(bufferCallback_, buffers_, [this, handle](Napi::Env env, Napi::Function callback) {
+        Deliver(env, callback, handle.info, handle.samples);
+    });
+}
+
+void AbletonLinkAudioSourceWrapper::Deliver(
+    Napi::Env env, Napi::Function callback,
+    const ableton::LinkAudioSource::BufferHandle::Info& bufferInfo, const int16_t* samples) {
+    const auto numSamples = bufferInfo.numFrames * bufferInfo.numChannels;
+    auto buffer = Napi::Buffer<int16_t>::Copy(env, samples, numSamples);
+    bytesCopied_ += numSamples * sizeof(int16_t);
+    auto payload = Napi::Object::New(env);
+    payload.Set("samples", buffer);
+    payload.Set("info", AbletonLinkAudioBufferInfoWrapper::New(env, bufferInfo));
+    callback.Call({payload});
+}
+
+void AbletonLinkAudioSourceWrapper::RunDelay() {
+    ThreadPolicyScope policy("source-align");
+    std::unique_lock<std::mutex> lock(delayMutex_);
+    while (delayRunning_) {
+        if (delayed_.empty()) {
+            delayWake_.wait(lock);
+            continue;
+        }
+        // Released in arrival order; a shrinking target only makes the
+        // following buffers due sooner.
+        const auto wait = delayed_.front().due - link_->clock().micros();
+        if (wait.count() > 0) {
+            delayWake_.wait_for(lock, wait);
+            continue;
+        }
+        auto buffer = std::make_shared<DelayedBuffer>(std::move(delayed_.front()));
+        delayed_.pop_front();
+        lock.unlock();
+        PostCounted(bufferCallback_, buffers_,
+                    [this, buffer](Napi::Env env, Napi::Function callback) {
+                        Deliver(env, callback, buffer->info, buffer->samples.data());
+                    });
+        lock.lock();
+    }
+}
+
+void AbletonLinkAudioSourceWrapper::StopDelay() {
+    {
+        std::lock_guard<std::mutex> lock(delayMutex_);
+        if (!delayRunning_) {
+            return;
+        }
+        delayRunning_ = false;
+        delayed_.clear();
+    }
+    delayWake_.notify_all();
+    if (delayThread_.joinable()) {
+        delayThread_.join();
+    }
 }
 
 Napi::Object InitAbletonLinkAudio(Napi::Env env, Napi::Object exports) {
@@ -1,12 +1,31 @@
 #ifndef ABLETONLINK_AUDIO_H
 #define ABLETONLINK_AUDIO_H
 
+#include "abletonlink_channels.h"
+#include "abletonlink_coalesce.h"
+#include "abletonlink_latency.h"
+#include "abletonlink_stats.h"
+#include "abletonlink_timeline.h"
 #include <napi.h>
 #include <ableton/LinkAudio.hpp>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Event types recorded by the unified event stream (setEventCallback).
+enum LinkEventType : int {
+    kLinkEventPeers = 0,
+    kLinkEventTempo,
+    kLinkEventStartStop,
+    kLinkEventChannels
+};
 
 class AbletonLinkAudioSessionStateWrapper
     : public Napi::ObjectWrap<AbletonLinkAudioSessionStateWrapper> {
@@ -19,8 +38,6 @@ public:
     ableton::LinkAudio::SessionState& State();
 
 private:
-    static Napi::FunctionReference constructor;
-
     Napi::Value Tempo(const Napi::CallbackInfo& info);
     void SetTempo(const Napi::CallbackInfo& info);
     Napi::Value BeatAtTime(const Napi::CallbackInfo& info);
@@ -43,12 +60,24 @@ public:
     AbletonLinkAudioWrapper(const Napi::CallbackInfo& info);
     ~AbletonLinkAudioWrapper();
 
+    static bool IsInstance(const Napi::Object& object);
+
     ableton::LinkAudio& LinkAudio();
+    // Shared ownership of the native instance; null once this handle is closed.
+    std::shared_ptr<ableton::LinkAudio> LinkAudioRef() const;
+    // Timeline for a native worker thread; see abletonlink_timeline.h.
+    std::unique_ptr<LinkTimeline> CreateTimeline();
+    LinkDependents& Dependents();
+    // Delay shared by the sources created with { align: true } on this handle.
+    std::shared_ptr<ChannelAlignment> Alignment() const;
 
 private:
-    static Napi::FunctionReference constructor;
-
-    std::unique_ptr<ableton::LinkAudio> link_;
+    // Shared with handles attached from other threads (see share()/attach()).
+    std::shared_ptr<ableton::LinkAudio> link_;
+    std::shared_ptr<ChannelAlignment> alignment_ = std::make_shared<ChannelAlignment>();
+    // False for handles created by attach(); they cannot install Link callbacks.
+    bool owner_ = true;
+    std::string shareKey_;
 
     Napi::Value Enable(const Napi::CallbackInfo& info);
     Napi::Value IsEnabled(const Napi::CallbackInfo& info);
@@ -68,22 +97,32 @@ private:
     void SetIsPlayingAndRequestBeatAtTime(const Napi::CallbackInfo& info);
     Napi::Value TimeForIsPlaying(const Napi::CallbackInfo& info);
     Napi::Value GetClockTime(const Napi::CallbackInfo& info);
+    Napi::Value GetState(const Napi::CallbackInfo& info);
 
     Napi::Value IsLinkAudioEnabled(const Napi::CallbackInfo& info);
     void EnableLinkAudio(const Napi::CallbackInfo& info);
     void SetPeerName(const Napi::CallbackInfo& info);
     void SetChannelsChangedCallback(const Napi::CallbackInfo& info);
     Napi::Value Channels(const Napi::CallbackInfo& info);
+    Napi::Value FindChannels(const Napi::CallbackInfo& info);
     void CallOnLinkThread(const Napi::CallbackInfo& info);
+    Napi::Value RunOnLinkThread(const Napi::CallbackInfo& info);
+    Napi::Value Share(const Napi::CallbackInfo& info);
+    static Napi::Value Attach(const Napi::CallbackInfo& info);
+    Napi::Value IsAttached(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
 
     Napi::Value CaptureAppSessionState(const Napi::CallbackInfo& info);
     void CommitAppSessionState(const Napi::CallbackInfo& info);
     Napi::Value CaptureAudioSessionState(const Napi::CallbackInfo& info);
     void CommitAudioSessionState(const Napi::CallbackInfo& info);
+    Napi::Value CaptureAppSessionStateInto(const Napi::CallbackInfo& info);
+    Napi::Value CaptureAudioSessionStateInto(const Napi::CallbackInfo& info);
 
     void SetNumPeersCallback(const Napi::CallbackInfo& info);
     void SetTempoCallback(const Napi::CallbackInfo& info);
     void SetStartStopCallback(const Napi::CallbackInfo& info);
+    void SetEventCallback(const Napi::CallbackInfo& info);
     void Close(const Napi::CallbackInfo& info);
 
     std::chrono::microseconds getCurrentTime() const;
@@ -91,6 +130,21 @@ private:
     void handleTempoCallback(double tempo);
     void handleStartStopCallback(bool isPlaying);
     void handleChannelsChangedCallback();
+    void RefreshChannels();
+    bool RequireOwner(Napi::Env env);
+    void PushEvent(LinkEventType type, double value);
+    void DispatchEvents(Napi::Env env, Napi::Function callback);
+
+    // A task queued by callOnLinkThread (callback only) or runOnLinkThread
+    // (deferred, optional callback). Lives on the JS thread until completed.
+    struct LinkTask {
+        Napi::FunctionReference callback;
+        std::unique_ptr<Napi::Promise::Deferred> deferred;
+    };
+    void SubmitLinkTask(Napi::Env env, LinkTask task);
+    void CompleteLinkTask(uint64_t id);
+    void DrainLinkTasks(Napi::Env env);
+    void RejectLinkTasks(Napi::Env env);
 
     void CloseInternal();
 
@@ -99,6 +153,45 @@ private:
     Napi::ThreadSafeFunction tempoCallback_;
     Napi::ThreadSafeFunction startStopCallback_;
     Napi::ThreadSafeFunction channelsChangedCallback_;
+    // Set when channelsChanged was registered with { diff: true }.
+    bool channelsDiff_ = false;
+    // Set when the matching callback was registered with { coalesce: true }.
+    std::shared_ptr<CoalescedSlot> numPeersLatest_;
+    std::shared_ptr<CoalescedSlot> tempoLatest_;
+    std::shared_ptr<CoalescedSlot> startStopLatest_;
+
+    // getStats() counters, updated from the Link thread without locking.
+    CallbackStats numPeersStats_{"numPeers"};
+    CallbackStats tempoStats_{"tempo"};
+    CallbackStats startStopStats_{"startStop"};
+    CallbackStats channelsStats_{"channels"};
+    CallbackStats eventStats_{"events"};
+    // Calls served into caller-owned objects instead of new ones.
+    std::atomic<uint64_t> allocationsAvoided_{0};
+
+    // Channel directory, read and refreshed on the JS thread. The Link thread
+    // only marks it dirty when the channel list changes.
+    std::unique_ptr<LinkChannelDirectory> channelDirectory_;
+    std::atomic<bool> channelsDirty_{true};
+
+    // Unified event stream: [type, timeSec, value] triplets batched into one
+    // ThreadSafeFunction call at a time.
+    std::mutex eventMutex_;
+    Napi::ThreadSafeFunction eventCallback_;
+    std::vector<double> pendingEvents_;
+    bool eventDispatchPending_ = false;
+
+    // Persistent Link-thread task queue. The Link thread records completed
+    // task ids; one ThreadSafeFunction call at a time drains them in order.
+    std::mutex linkTaskMutex_;
+    Napi::ThreadSafeFunction linkTaskQueue_;
+    std::vector<uint64_t> completedLinkTasks_;
+    bool linkTaskDispatchPending_ = false;
+    bool linkTasksClosed_ = false;
+    std::unordered_map<uint64_t, LinkTask> linkTasks_;
+    uint64_t nextLinkTaskId_ = 1;
+
+    LinkDependents dependents_;
 };
 
 class AbletonLinkAudioSinkBufferHandleWrapper
@@ -106,21 +199,24 @@ class AbletonLinkAudioSinkBufferHandleWrapper
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     static Napi::Object New(Napi::Env env,
-                            std::unique_ptr<ableton::LinkAudioSink::BufferHandle> handle);
+                            std::unique_ptr<ableton::LinkAudioSink::BufferHandle> handle,
+                            std::shared_ptr<ableton::LinkAudioSink> sink,
+                            std::shared_ptr<SinkStats> stats);
 
     AbletonLinkAudioSinkBufferHandleWrapper(const Napi::CallbackInfo& info);
     ~AbletonLinkAudioSinkBufferHandleWrapper();
 
 private:
-    static Napi::FunctionReference constructor;
-
     Napi::Value IsValid(const Napi::CallbackInfo& info);
     Napi::Value Samples(const Napi::CallbackInfo& info);
     Napi::Value MaxNumSamples(const Napi::CallbackInfo& info);
     Napi::Value Commit(const Napi::CallbackInfo& info);
 
     std::unique_ptr<ableton::LinkAudioSink::BufferHandle> handle_;
+    // Keeps the sink alive while the handle is retained, even after close().
+    std::shared_ptr<ableton::LinkAudioSink> sink_;
     Napi::Reference<Napi::Buffer<int16_t>> samples_;
+    std::shared_ptr<SinkStats> stats_;
 };
 
 class AbletonLinkAudioSinkWrapper : public Napi::ObjectWrap<AbletonLinkAudioSinkWrapper> {
@@ -129,16 +225,26 @@ public:
     AbletonLinkAudioSinkWrapper(const Napi::CallbackInfo& info);
     ~AbletonLinkAudioSinkWrapper();
 
-private:
-    static Napi::FunctionReference constructor;
+    static bool IsInstance(const Napi::Object& object);
 
+    std::shared_ptr<ableton::LinkAudioSink> Sink() const;
+    // Counters shared with buffer handles and transports writing to this sink.
+    std::shared_ptr<SinkStats> Stats() const;
+
+private:
     Napi::Value Name(const Napi::CallbackInfo& info);
     void SetName(const Napi::CallbackInfo& info);
     void RequestMaxNumSamples(const Napi::CallbackInfo& info);
     Napi::Value MaxNumSamples(const Napi::CallbackInfo& info);
     Napi::Value RetainBuffer(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+    bool RequireOpen(Napi::Env env);
 
     std::shared_ptr<ableton::LinkAudioSink> sink_;
+    std::shared_ptr<SinkStats> stats_ = std::make_shared<SinkStats>();
+    RateWindow rate_;
+    std::shared_ptr<ableton::LinkAudio> link_;
     Napi::ObjectReference linkRef_;
 };
 
@@ -152,8 +258,6 @@ public:
     AbletonLinkAudioBufferInfoWrapper(const Napi::CallbackInfo& info);
 
 private:
-    static Napi::FunctionReference constructor;
-
     Napi::Value NumChannels(const Napi::CallbackInfo& info);
     Napi::Value NumFrames(const Napi::CallbackInfo& info);
     Napi::Value SampleRate(const Napi::CallbackInfo& info);
@@ -174,9 +278,8 @@ public:
     ~AbletonLinkAudioSourceWrapper();
 
 private:
-    static Napi::FunctionReference constructor;
-
     Napi::Value Id(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
     void Close(const Napi::CallbackInfo& info);
     void CloseInternal();
 
@@ -187,9 +290,46 @@ private:
         const ableton::LinkAudioSource::BufferHandle& handle,
         void* context);
 
+    // An aligned buffer waiting for its release time.
+    struct DelayedBuffer {
+        std::chrono::microseconds due{0};
+        ableton::LinkAudioSource::BufferHandle::Info info{};
+        std::vector<int16_t> samples;
+    };
+
+    void Deliver(Napi::Env env, Napi::Function callback,
+                 const ableton::LinkAudioSource::BufferHandle::Info& bufferInfo,
+                 const int16_t* samples);
+    void RunDelay();
+    void StopDelay();
+
     std::shared_ptr<ableton::LinkAudioSource> source_;
+    std::shared_ptr<ableton::LinkAudio> link_;
     Napi::ObjectReference linkRef_;
     Napi::ThreadSafeFunction bufferCallback_;
+    // Quantum used to place buffers on the local timeline. Latencies of more
+    // than half a quantum cannot be told apart from an earlier bar.
+    double quantum_ = 4.0;
+    ChannelLatency latency_;
+    // Smallest budget this source reports to its alignment group, in micros.
+    double targetLatency_ = 0.0;
+
+    // Alignment, when enabled: a thread releases delayed_ in order.
+    std::shared_ptr<ChannelAlignment> alignment_;
+    uint64_t alignmentId_ = 0;
+    std::mutex delayMutex_;
+    std::condition_variable delayWake_;
+    std::deque<DelayedBuffer> delayed_;
+    bool delayRunning_ = false;
+    std::thread delayThread_;
+    std::atomic<uint64_t> buffersDelayed_{0};
+    std::atomic<uint64_t> buffersLate_{0};
+
+    // getStats() counters. The audio thread updates `buffers` lock-free;
+    // bytesCopied and rate_ are only touched on the JS thread.
+    CallbackStats buffers_{"source"};
+    uint64_t bytesCopied_ = 0;
+    RateWindow rate_;
 };
 
 Napi::Object InitAbletonLinkAudio(Napi::Env env, Napi::Object exports);
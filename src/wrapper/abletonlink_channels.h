@@ -0,0 +1,144 @@
+#ifndef ABLETONLINK_CHANNELS_H
+#define ABLETONLINK_CHANNELS_H
+
+#include <ableton/LinkAudio.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct LinkChannelEntry {
+    std::string id;
+    std::string name;
+    std::string peerId;
+    std::string peerName;
+};
+
+struct LinkChannelDiff {
+    std::vector<LinkChannelEntry> added;
+    std::vector<LinkChannelEntry> removed;
+    std::vector<LinkChannelEntry> renamed;
+
+    bool Empty() const { return added.empty() && removed.empty() && renamed.empty(); }
+};
+
+// Directory of the channels announced in the session, owned by the JS thread.
+// Hex IDs are formatted once per NodeId and reused across refreshes, lookups go
+// through indices built on refresh, and diffs are computed against the state
+// last handed out by TakeDiff().
+class LinkChannelDirectory {
+public:
+    using FormatId = std::function<std::string(const ableton::link::NodeId&)>;
+
+    explicit LinkChannelDirectory(FormatId formatId) : formatId_(std::move(formatId)) {}
+
+    // Rebuilds the directory from Link's channel list.
+    template <typename Channels>
+    void Refresh(const Channels& channels) {
+        std::unordered_map<uint64_t, std::string> ids;
+        entries_.clear();
+        entries_.reserve(channels.size());
+        for (const auto& channel : channels) {
+            entries_.push_back({Intern(channel.id, ids), channel.name,
+                                Intern(channel.peerId, ids), channel.peerName});
+        }
+        // Keep only IDs still in use so the cache tracks the live session.
+        hexIds_.swap(ids);
+
+        byId_.clear();
+        byName_.clear();
+        byPeer_.clear();
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            const auto& entry = entries_[i];
+            byId_.emplace(entry.id, i);
+            byName_.emplace(entry.name, i);
+            byPeer_.emplace(entry.peerId, i);
+            if (entry.peerName != entry.peerId) {
+                byPeer_.emplace(entry.peerName, i);
+            }
+        }
+    }
+
+    const std::vector<LinkChannelEntry>& Entries() const { return entries_; }
+
+    const LinkChannelEntry* FindById(const std::string& id) const {
+        const auto it = byId_.find(id);
+        return it == byId_.end() ? nullptr : &entries_[it->second];
+    }
+
+    std::vector<const LinkChannelEntry*> FindByName(const std::string& name) const {
+        return Collect(byName_, name);
+    }
+
+    // Matches either the peer's hex ID or its name.
+    std::vector<const LinkChannelEntry*> FindByPeer(const std::string& peer) const {
+        return Collect(byPeer_, peer);
+    }
+
+    // Changes since the previous call.
+    LinkChannelDiff TakeDiff() {
+        LinkChannelDiff diff;
+        std::unordered_map<std::string, LinkChannelEntry> current;
+        current.reserve(entries_.size());
+        for (const auto& entry : entries_) {
+            const auto it = delivered_.find(entry.id);
+            if (it == delivered_.end()) {
+                diff.added.push_back(entry);
+            } else if (it->second.name != entry.name ||
+                       it->second.peerName != entry.peerName) {
+                diff.renamed.push_back(entry);
+            }
+            current.emplace(entry.id, entry);
+        }
+        for (const auto& item : delivered_) {
+            if (current.find(item.first) == current.end()) {
+                diff.removed.push_back(item.second);
+            }
+        }
+        delivered_.swap(current);
+        return diff;
+    }
+
+private:
+    using Index = std::unordered_multimap<std::string, std::size_t>;
+
+    std::vector<const LinkChannelEntry*> Collect(const Index& index,
+                                                 const std::string& key) const {
+        std::vector<const LinkChannelEntry*> result;
+        const auto range = index.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            result.push_back(&entries_[it->second]);
+        }
+        // Keep Link's channel order regardless of hash bucket order.
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    const std::string& Intern(const ableton::link::NodeId& id,
+                              std::unordered_map<uint64_t, std::string>& live) {
+        uint64_t key = 0;
+        for (const auto byte : id) {
+            key = (key << 8) | byte;
+        }
+        const auto used = live.find(key);
+        if (used != live.end()) {
+            return used->second;
+        }
+        const auto cached = hexIds_.find(key);
+        auto hex = cached != hexIds_.end() ? std::move(cached->second) : formatId_(id);
+        return live.emplace(key, std::move(hex)).first->second;
+    }
+
+    FormatId formatId_;
+    std::unordered_map<uint64_t, std::string> hexIds_;
+    std::vector<LinkChannelEntry> entries_;
+    std::unordered_map<std::string, std::size_t> byId_;
+    Index byName_;
+    Index byPeer_;
+    std::unordered_map<std::string, LinkChannelEntry> delivered_;
+};
+
+#endif // ABLETONLINK_CHANNELS_H
@@ -0,0 +1,75 @@
+#ifndef ABLETONLINK_COALESCE_H
+#define ABLETONLINK_COALESCE_H
+
+#include "abletonlink_stats.h"
+
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Latest-value slot for a callback registered with `{ coalesce: true }`. The
+// Link thread overwrites the value and schedules at most one JS dispatch, which
+// delivers the newest value together with the number of changes it stands for.
+// A fresh slot is created per registration so calls still queued for a
+// replaced callback cannot consume the new one's changes.
+struct CoalescedSlot {
+    std::atomic<double> value{0.0};
+    std::atomic<uint64_t> changes{0};
+    std::atomic<bool> dispatchPending{false};
+};
+
+// Returns a slot when the options object at `index` sets `coalesce: true`.
+inline std::shared_ptr<CoalescedSlot> ParseCoalesceOption(const Napi::CallbackInfo& info,
+                                                          size_t index) {
+    if (info.Length() > index && info[index].IsObject()) {
+        auto coalesce = info[index].As<Napi::Object>().Get("coalesce");
+        if (coalesce.IsBoolean() && coalesce.As<Napi::Boolean>().Value()) {
+            return std::make_shared<CoalescedSlot>();
+        }
+    }
+    return nullptr;
+}
+
+// Stores value and, unless a dispatch is already queued, queues one without
+// blocking. toValue converts the stored double back to the callback's JS type.
+// stats, when given, counts the queued dispatches.
+template <typename ToValue>
+void PostCoalesced(Napi::ThreadSafeFunction& tsfn,
+                   const std::shared_ptr<CoalescedSlot>& slot,
+                   double value,
+                   ToValue toValue,
+                   CallbackStats* stats = nullptr) {
+    slot->value.store(value, std::memory_order_relaxed);
+    slot->changes.fetch_add(1, std::memory_order_release);
+    if (slot->dispatchPending.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    const auto postedAt = stats ? stats->Posted() : 0;
+    const auto status = tsfn.NonBlockingCall(
+        [slot, toValue, stats, postedAt](Napi::Env env, Napi::Function callback) {
+            if (stats) {
+                stats->Delivered(postedAt);
+            }
+            // Clear the flag before draining so a change made from here on
+            // queues another dispatch instead of being lost.
+            slot->dispatchPending.store(false, std::memory_order_release);
+            const auto changes = slot->changes.exchange(0, std::memory_order_acq_rel);
+            if (changes == 0) {
+                return;
+            }
+            const auto latest = slot->value.load(std::memory_order_relaxed);
+            TraceSpan span(stats ? stats->name : "coalesced", "js.callback");
+            callback.Call({toValue(env, latest),
+                           Napi::Number::New(env, static_cast<double>(changes))});
+        });
+    if (status != napi_ok) {
+        slot->dispatchPending.store(false, std::memory_order_release);
+        if (stats) {
+            stats->Dropped();
+        }
+    }
+}
+
+#endif // ABLETONLINK_COALESCE_H
@@ -0,0 +1,436 @@
+#include "abletonlink_decode.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ABLETONLINK_DECODE_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ABLETONLINK_DECODE_NEON 1
+#endif
+
+namespace {
+constexpr uint16_t kWaveFormatPcm = 1;
+constexpr uint16_t kWaveFormatFloat = 3;
+constexpr uint16_t kWaveFormatExtensible = 0xFFFE;
+
+// Full-scale float maps to +/-32767 so that 1.0 does not clip.
+constexpr float kFloatScale = 32767.0f;
+
+uint16_t ReadLE16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t ReadBE16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t ReadBE32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+// AIFF stores the sample rate as an 80-bit IEEE 754 extended float.
+double ReadExtended(const uint8_t* p) {
+    const int exponent = ((p[0] & 0x7F) << 8) | p[1];
+    uint64_t mantissa = 0;
+    for (int i = 0; i < 8; ++i) {
+        mantissa = (mantissa << 8) | p[2 + i];
+    }
+    if (exponent == 0 && mantissa == 0) {
+        return 0.0;
+    }
+    const double value = std::ldexp(static_cast<double>(mantissa), exponent - 16383 - 63);
+    return (p[0] & 0x80) ? -value : value;
+}
+
+bool SetIntegerEncoding(size_t bytes, bool signed8, AudioFileInfo& info) {
+    switch (bytes) {
+    case 1:
+        info.encoding = signed8 ? SampleEncoding::kInt8 : SampleEncoding::kUnsigned8;
+        return true;
+    case 2:
+        info.encoding = SampleEncoding::kInt16;
+        return true;
+    case 3:
+        info.encoding = SampleEncoding::kInt24;
+        return true;
+    case 4:
+        info.encoding = SampleEncoding::kInt32;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool SetFloatEncoding(size_t bytes, AudioFileInfo& info) {
+    if (bytes == 4) {
+        info.encoding = SampleEncoding::kFloat32;
+        return true;
+    }
+    if (bytes == 8) {
+        info.encoding = SampleEncoding::kFloat64;
+        return true;
+    }
+    return false;
+}
+
+bool ParseWav(const uint8_t* data, size_t size, AudioFileInfo& info, std::string& error) {
+    info.container = "wav";
+    uint16_t formatTag = 0;
+    uint16_t blockAlign = 0;
+    bool haveFormat = false;
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const uint8_t* id = data + offset;
+        const uint32_t chunkSize = ReadLE32(data + offset + 4);
+        const size_t start = offset + 8;
+        if (std::memcmp(id, "fmt ", 4) == 0) {
+            if (chunkSize < 16 || start + 16 > size) {
+                error = "WAV fmt chunk is truncated";
+                return false;
+            }
+            formatTag = ReadLE16(data + start);
+            info.numChannels = ReadLE16(data + start + 2);
+            info.sampleRate = ReadLE32(data + start + 4);
+            blockAlign = ReadLE16(data + start + 12);
+            info.bitsPerSample = ReadLE16(data + start + 14);
+            if (formatTag == kWaveFormatExtensible) {
+                if (chunkSize < 40 || start + 40 > size) {
+                    error = "WAV extensible fmt chunk is truncated";
+                    return false;
+                }
+                // The sub-format GUID starts with the plain format tag.
+                formatTag = ReadLE16(data + start + 24);
+            }
+            haveFormat = true;
+        } else if (std::memcmp(id, "data", 4) == 0) {
+            if (!haveFormat) {
+                error = "WAV data chunk precedes fmt chunk";
+                return false;
+            }
+            if (info.numChannels == 0 || blockAlign % info.numChannels != 0) {
+                error = "WAV fmt chunk has an invalid channel layout";
+                return false;
+            }
+            // Samples are left-justified in their container, so the container
+            // width decides the encoding (e.g. 20 valid bits in 24).
+            info.bytesPerSample = blockAlign / info.numChannels;
+            const bool supported = formatTag == kWaveFormatPcm
+                                       ? SetIntegerEncoding(info.bytesPerSample, false, info)
+                                   : formatTag == kWaveFormatFloat
+                                       ? SetFloatEncoding(info.bytesPerSample, info)
+                                       : false;
+            if (!supported) {
+                error = "Unsupported WAV format (tag " + std::to_string(formatTag) + ", " +
+                        std::to_string(info.bitsPerSample) + " bits)";
+                return false;
+            }
+            // Streaming writers may leave the size at 0 or 0xFFFFFFFF.
+            const size_t available = size - start;
+            const size_t bytes = chunkSize == 0 ? available : std::min<size_t>(chunkSize, available);
+            info.dataOffset = start;
+            info.numSamples = bytes / blockAlign * info.numChannels;
+            info.bigEndian = false;
+            return true;
+        }
+        offset = start + chunkSize + (chunkSize & 1);
+    }
+    error = "WAV missing fmt or data chunk";
+    return false;
+}
+
+bool ParseAiff(const uint8_t* data, size_t size, AudioFileInfo& info, std::string& error) {
+    info.container = "aiff";
+    const bool compressed = std::memcmp(data + 8, "AIFC", 4) == 0;
+    bool haveCommon = false;
+    uint32_t numFrames = 0;
+    char compression[4] = {'N', 'O', 'N', 'E'};
+    size_t soundStart = 0;
+    size_t soundBytes = 0;
+    bool haveSound = false;
+
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const uint8_t* id = data + offset;
+        const uint32_t chunkSize = ReadBE32(data + offset + 4);
+        const size_t start = offset + 8;
+        if (std::memcmp(id, "COMM", 4) == 0) {
+            const size_t needed = compressed ? 22 : 18;
+            if (chunkSize < needed || start + needed > size) {
+                error = "AIFF COMM chunk is truncated";
+                return false;
+            }
+            info.numChannels = ReadBE16(data + start);
+            numFrames = ReadBE32(data + start + 2);
+            info.bitsPerSample = ReadBE16(data + start + 6);
+            info.sampleRate = static_cast<uint32_t>(std::lround(ReadExtended(data + start + 8)));
+            if (compressed) {
+                std::memcpy(compression, data + start + 18, 4);
+            }
+            haveCommon = true;
+        } else if (std::memcmp(id, "SSND", 4) == 0) {
+            if (chunkSize < 8 || start + 8 > size) {
+                error = "AIFF SSND chunk is truncated";
+                return false;
+            }
+            const uint32_t dataOffset = ReadBE32(data + start);
+            soundStart = std::min(size, start + 8 + dataOffset);
+            soundBytes = std::min<size_t>(chunkSize - 8, size - soundStart);
+            haveSound = true;
+        }
+        offset = start + chunkSize + (chunkSize & 1);
+    }
+    if (!haveCommon || !haveSound) {
+        error = "AIFF missing COMM or SSND chunk";
+        return false;
+    }
+    if (info.numChannels == 0) {
+        error = "AIFF COMM chunk has no channels";
+        return false;
+    }
+
+    info.bytesPerSample = (info.bitsPerSample + 7) / 8;
+    bool supported = false;
+    if (std::memcmp(compression, "NONE", 4) == 0 || std::memcmp(compression, "twos", 4) == 0) {
+        info.bigEndian = true;
+        supported = SetIntegerEncoding(info.bytesPerSample, true, info);
+    } else if (std::memcmp(compression, "sowt", 4) == 0) {
+        info.bigEndian = false;
+        supported = SetIntegerEncoding(info.bytesPerSample, true, info);
+    } else if (std::memcmp(compression, "fl32", 4) == 0 ||
+               std::memcmp(compression, "FL32", 4) == 0) {
+        info.bigEndian = true;
+        info.bytesPerSample = 4;
+        supported = SetFloatEncoding(4, info);
+    } else if (std::memcmp(compression, "fl64", 4) == 0 ||
+               std::memcmp(compression, "FL64", 4) == 0) {
+        info.bigEndian = true;
+        info.bytesPerSample = 8;
+        supported = SetFloatEncoding(8, info);
+    }
+    if (!supported) {
+        error = "Unsupported AIFF encoding '" + std::string(compression, 4) + "' (" +
+                std::to_string(info.bitsPerSample) + " bits)";
+        return false;
+    }
+
+    const size_t frameBytes = info.bytesPerSample * info.numChannels;
+    const size_t frames = std::min<size_t>(numFrames, soundBytes / frameBytes);
+    info.dataOffset = soundStart;
+    info.numSamples = frames * info.numChannels;
+    return true;
+}
+
+// Reads one integer sample, left-justified to 32 bits.
+int32_t ReadInteger(const uint8_t* p, SampleEncoding encoding, bool bigEndian) {
+    switch (encoding) {
+    case SampleEncoding::kUnsigned8:
+        return static_cast<int32_t>(static_cast<uint32_t>(p[0] ^ 0x80) << 24);
+    case SampleEncoding::kInt8:
+        return static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 24);
+    case SampleEncoding::kInt16:
+        return static_cast<int32_t>(
+            static_cast<uint32_t>(bigEndian ? ReadBE16(p) : ReadLE16(p)) << 16);
+    case SampleEncoding::kInt24:
+        return static_cast<int32_t>(
+            bigEndian ? (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                            (static_cast<uint32_t>(p[2]) << 8)
+                      : (static_cast<uint32_t>(p[2]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                            (static_cast<uint32_t>(p[0]) << 8));
+    default:
+        return static_cast<int32_t>(bigEndian ? ReadBE32(p) : ReadLE32(p));
+    }
+}
+
+double ReadFloat(const uint8_t* p, SampleEncoding encoding, bool bigEndian) {
+    if (encoding == SampleEncoding::kFloat32) {
+        const uint32_t bits = bigEndian ? ReadBE32(p) : ReadLE32(p);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+        bits |= static_cast<uint64_t>(p[bigEndian ? 7 - i : i]) << (8 * i);
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int16_t Saturate(double value) {
+    if (!(value > -32768.0)) {
+        return value != value ? 0 : -32768;
+    }
+    return static_cast<int16_t>(std::min(std::lrint(value), 32767L));
+}
+
+// xorshift32 source for TPDF dither: the difference of two uniform values
+// gives a triangular distribution over (-1, 1) LSB.
+class Dither {
+public:
+    double Next() {
+        return Uniform() - Uniform();
+    }
+
+private:
+    double Uniform() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return static_cast<double>(state_ >> 8) * (1.0 / 16777216.0);
+    }
+
+    uint32_t state_ = 0x9E3779B9u;
+};
+
+// Little-endian float32 without dither, the common case for float assets.
+// Out-of-range input is clamped before conversion and NaN becomes 0, matching
+// Saturate() in the scalar tail.
+void ConvertFloat32(const uint8_t* data, int16_t* out, size_t count) {
+    size_t i = 0;
+#if defined(ABLETONLINK_DECODE_SSE2)
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(kFloatScale);
+    for (; i + 8 <= count; i += 8) {
+        const auto* src = reinterpret_cast<const float*>(data) + i;
+        __m128 a = _mm_loadu_ps(src);
+        __m128 b = _mm_loadu_ps(src + 4);
+        // maxps returns its second operand for NaN, so zero NaN lanes first.
+        a = _mm_min_ps(_mm_max_ps(_mm_and_ps(a, _mm_cmpord_ps(a, a)), lo), hi);
+        b = _mm_min_ps(_mm_max_ps(_mm_and_ps(b, _mm_cmpord_ps(b, b)), lo), hi);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)),
+                                               _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#elif defined(ABLETONLINK_DECODE_NEON)
+    const float32x4_t lo = vdupq_n_f32(-1.0f);
+    const float32x4_t hi = vdupq_n_f32(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a;
+        float32x4_t b;
+        std::memcpy(&a, data + i * 4, sizeof(a));
+        std::memcpy(&b, data + i * 4 + 16, sizeof(b));
+        a = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vceqq_f32(a, a)));
+        b = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(b), vceqq_f32(b, b)));
+        a = vmulq_n_f32(vminq_f32(vmaxq_f32(a, lo), hi), kFloatScale);
+        b = vmulq_n_f32(vminq_f32(vmaxq_f32(b, lo), hi), kFloatScale);
+        const int16x8_t packed =
+            vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b)));
+        vst1q_s16(out + i, packed);
+    }
+#endif
+    for (; i < count; ++i) {
+        float value;
+        std::memcpy(&value, data + i * 4, sizeof(value));
+        out[i] = Saturate(std::clamp(value, -1.0f, 1.0f) * kFloatScale);
+    }
+}
+} // namespace
+
+bool ParseAudioFile(const uint8_t* data, size_t size, AudioFileInfo& info, std::string& error) {
+    if (size >= 12 && std::memcmp(data, "RIFF", 4) == 0 && std::memcmp(data + 8, "WAVE", 4) == 0) {
+        return ParseWav(data, size, info, error);
+    }
+    if (size >= 12 && std::memcmp(data, "FORM", 4) == 0 &&
+        (std::memcmp(data + 8, "AIFF", 4) == 0 || std::memcmp(data + 8, "AIFC", 4) == 0)) {
+        return ParseAiff(data, size, info, error);
+    }
+    error = "Not a WAV or AIFF file";
+    return false;
+}
+
+void ConvertToInt16(const AudioFileInfo& info, const uint8_t* data, int16_t* out, bool dither) {
+    const uint8_t* src = data + info.dataOffset;
+    const size_t count = info.numSamples;
+    const size_t width = info.bytesPerSample;
+    const auto encoding = info.encoding;
+
+    if (encoding == SampleEncoding::kInt16 && !info.bigEndian) {
+        std::memcpy(out, src, count * sizeof(int16_t));
+        return;
+    }
+    if (encoding == SampleEncoding::kFloat32 && !info.bigEndian && !dither) {
+        ConvertFloat32(src, out, count);
+        return;
+    }
+
+    // Sources no wider than 16 bits convert exactly and are never dithered.
+    const bool narrow = encoding == SampleEncoding::kUnsigned8 ||
+                        encoding == SampleEncoding::kInt8 || encoding == SampleEncoding::kInt16;
+    Dither noise;
+    if (encoding == SampleEncoding::kFloat32 || encoding == SampleEncoding::kFloat64) {
+        for (size_t i = 0; i < count; ++i) {
+            const double value =
+                std::clamp(ReadFloat(src + i * width, encoding, info.bigEndian), -1.0, 1.0) *
+                kFloatScale;
+            out[i] = Saturate(dither ? value + noise.Next() : value);
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t value = ReadInteger(src + i * width, encoding, info.bigEndian);
+        if (narrow) {
+            out[i] = static_cast<int16_t>(value >> 16);
+        } else if (dither) {
+            out[i] = Saturate(value / 65536.0 + noise.Next());
+        } else {
+            out[i] = static_cast<int16_t>(
+                std::min<int64_t>((static_cast<int64_t>(value) + 0x8000) >> 16, 32767));
+        }
+    }
+}
+
+namespace {
+// decodeAudio(data, { dither }) -> { samples, numChannels, sampleRate, ... }
+Napi::Value DecodeAudio(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    if (info.Length() < 1 || !info[0].IsTypedArray() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+        Napi::TypeError::New(env, "Buffer or Uint8Array expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    bool dither = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        const auto option = info[1].As<Napi::Object>().Get("dither");
+        dither = option.IsBoolean() && option.As<Napi::Boolean>().Value();
+    }
+
+    auto bytes = info[0].As<Napi::Uint8Array>();
+    AudioFileInfo file;
+    std::string error;
+    if (!ParseAudioFile(bytes.Data(), bytes.ByteLength(), file, error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    auto samples = Napi::Int16Array::New(env, file.numSamples);
+    ConvertToInt16(file, bytes.Data(), samples.Data(), dither);
+
+    const bool isFloat =
+        file.encoding == SampleEncoding::kFloat32 || file.encoding == SampleEncoding::kFloat64;
+    auto result = Napi::Object::New(env);
+    result.Set("samples", samples);
+    result.Set("numChannels", static_cast<double>(file.numChannels));
+    result.Set("sampleRate", static_cast<double>(file.sampleRate));
+    result.Set("bitsPerSample", static_cast<double>(file.bitsPerSample));
+    result.Set("sampleFormat", isFloat ? "float" : "int");
+    result.Set("container", file.container);
+    return result;
+}
+} // namespace
+
+Napi::Object InitAbletonLinkDecode(Napi::Env env, Napi::Object exports) {
+    exports.Set("decodeAudio", Napi::Function::New(env, DecodeAudio, "decodeAudio"));
+    return exports;
+}
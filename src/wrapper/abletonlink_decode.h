@@ -0,0 +1,38 @@
+#ifndef ABLETONLINK_DECODE_H
+#define ABLETONLINK_DECODE_H
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Decoding of WAV (integer PCM, IEEE float, WAVE_FORMAT_EXTENSIBLE) and
+// AIFF/AIFF-C files to the interleaved int16 samples LinkAudio sinks take.
+
+enum class SampleEncoding { kUnsigned8, kInt8, kInt16, kInt24, kInt32, kFloat32, kFloat64 };
+
+struct AudioFileInfo {
+    SampleEncoding encoding = SampleEncoding::kInt16;
+    bool bigEndian = false;
+    uint32_t numChannels = 0;
+    uint32_t sampleRate = 0;
+    uint32_t bitsPerSample = 0;
+    const char* container = "wav";
+    // Interleaved sample data: numSamples (frames * channels) samples from
+    // dataOffset, each bytesPerSample wide.
+    size_t dataOffset = 0;
+    size_t numSamples = 0;
+    size_t bytesPerSample = 2;
+};
+
+// Reads the file header. Returns false with a message in error when the file
+// is malformed or uses an unsupported encoding.
+bool ParseAudioFile(const uint8_t* data, size_t size, AudioFileInfo& info, std::string& error);
+
+// Writes info.numSamples int16 samples to out, rounding and saturating.
+// dither adds TPDF dither of one int16 LSB to sources wider than 16 bits.
+void ConvertToInt16(const AudioFileInfo& info, const uint8_t* data, int16_t* out, bool dither);
+
+Napi::Object InitAbletonLinkDecode(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_DECODE_H
@@ -0,0 +1,109 @@
+#ifndef ABLETONLINK_LATENCY_H
+#define ABLETONLINK_LATENCY_H
+
+#include <napi.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+// How late a channel's buffers arrive: the Link time a buffer is received
+// minus the local Link time of the beat it begins at. Negative when the
+// sender commits ahead of its clock by more than the network delay.
+//
+// Written by the Link thread only; getStats() reads the relaxed atomics.
+class ChannelLatency {
+public:
+    void Record(double micros) {
+        const auto count = count_.load(std::memory_order_relaxed);
+        auto smoothed = micros;
+        auto jitter = 0.0;
+        if (count > 0) {
+            // Exponential averages over roughly the last 16 buffers.
+            smoothed = smoothed_.load(std::memory_order_relaxed);
+            jitter = jitter_.load(std::memory_order_relaxed);
+            jitter += kAlpha * (std::abs(micros - smoothed) - jitter);
+            smoothed += kAlpha * (micros - smoothed);
+        }
+        last_.store(micros, std::memory_order_relaxed);
+        smoothed_.store(smoothed, std::memory_order_relaxed);
+        jitter_.store(jitter, std::memory_order_relaxed);
+        count_.store(count + 1, std::memory_order_relaxed);
+    }
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+
+    // Delay that covers most buffers of this channel.
+    double Budget() const {
+        return smoothed_.load(std::memory_order_relaxed) +
+               2.0 * jitter_.load(std::memory_order_relaxed);
+    }
+
+    Napi::Object ToObject(Napi::Env env) const {
+        auto result = Napi::Object::New(env);
+        const auto count = Count();
+        const auto ms = [&](const std::atomic<double>& value) {
+            return count > 0 ? Napi::Value(Napi::Number::New(
+                                   env, value.load(std::memory_order_relaxed) / 1000.0))
+                             : env.Null();
+        };
+        result.Set("count", static_cast<double>(count));
+        result.Set("lastMs", ms(last_));
+        result.Set("smoothedMs", ms(smoothed_));
+        result.Set("jitterMs", ms(jitter_));
+        return result;
+    }
+
+private:
+    static constexpr double kAlpha = 1.0 / 16.0;
+
+    std::atomic<uint64_t> count_{0};
+    std::atomic<double> last_{0.0};
+    std::atomic<double> smoothed_{0.0};
+    std::atomic<double> jitter_{0.0};
+};
+
+// Common delay for the aligned sources of one AbletonLinkAudio handle. Each
+// source reports its latency budget; buffers of every member are then
+// released at their beat time plus the largest budget, so all channels come
+// out with the same offset from the local timeline.
+class ChannelAlignment {
+public:
+    uint64_t Add(double budgetMicros) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto id = nextId_++;
+        budgets_[id] = budgetMicros;
+        return id;
+    }
+
+    void Remove(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budgets_.erase(id);
+    }
+
+    void Update(uint64_t id, double budgetMicros) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = budgets_.find(id);
+        if (it != budgets_.end()) {
+            it->second = budgetMicros;
+        }
+    }
+
+    double Target() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        double target = 0.0;
+        for (const auto& entry : budgets_) {
+            target = std::max(target, entry.second);
+        }
+        return target;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, double> budgets_;
+    uint64_t nextId_ = 1;
+};
+
+#endif // ABLETONLINK_LATENCY_H
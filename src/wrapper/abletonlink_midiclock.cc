@@ -0,0 +1,421 @@
+#include "abletonlink_midiclock.h"
+#include "abletonlink_addon.h"
+#include "abletonlink.h"
+#include "abletonlink_audio.h"
+#include "abletonlink_thread_policy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr int kPulsesPerQuarterNote = 24;
+
+constexpr uint8_t kMidiClock = 0xF8;
+constexpr uint8_t kMidiStart = 0xFA;
+constexpr uint8_t kMidiContinue = 0xFB;
+constexpr uint8_t kMidiStop = 0xFC;
+constexpr uint8_t kMidiSongPosition = 0xF2;
+
+// Upper bound on how long the thread sleeps without re-reading the session,
+// so tempo and start/stop changes are picked up between slow clock pulses.
+constexpr std::chrono::microseconds kRecheckInterval{5000};
+
+// Returns how many bytes were written, 0 on error. The fd is non-blocking
+// while the clock runs, so a full pipe or a FIFO without a reader writes
+// nothing instead of stalling.
+std::size_t WriteBytes(int fd, const uint8_t* bytes, std::size_t size) {
+#if defined(_WIN32)
+    const auto written = _write(fd, bytes, static_cast<unsigned int>(size));
+#else
+    const auto written = ::write(fd, bytes, size);
+#endif
+    return written > 0 ? static_cast<std::size_t>(written) : 0;
+}
+
+// Status bytes have the high bit set; data bytes never do.
+bool IsStatusByte(uint8_t byte) {
+    return (byte & 0x80) != 0;
+}
+} // namespace
+
+Napi::Object AbletonLinkMidiClockWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "AbletonLinkMidiClock", {
+        InstanceMethod("start", &AbletonLinkMidiClockWrapper::Start),
+        InstanceMethod("stop", &AbletonLinkMidiClockWrapper::Stop),
+        InstanceMethod("isRunning", &AbletonLinkMidiClockWrapper::IsRunning),
+        InstanceMethod("status", &AbletonLinkMidiClockWrapper::Status),
+        InstanceMethod("close", &AbletonLinkMidiClockWrapper::Close),
+    });
+
+    AddonData(env).midiClock = Napi::Persistent(func);
+    exports.Set("AbletonLinkMidiClock", func);
+    return exports;
+}
+
+AbletonLinkMidiClockWrapper::AbletonLinkMidiClockWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<AbletonLinkMidiClockWrapper>(info) {
+    if (info.Length() < 1 || !info[0].IsObject() ||
+        (info.Length() > 1 && !info[1].IsFunction() && !info[1].IsNull() &&
+         !info[1].IsUndefined())) {
+        Napi::TypeError::New(info.Env(),
+                             "Link instance and optional event callback (function) expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto linkObject = info[0].As<Napi::Object>();
+    if (AbletonLinkAudioWrapper::IsInstance(linkObject)) {
+        auto* link = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(linkObject);
+        timeline_ = link->CreateTimeline();
+        dependents_ = &link->Dependents();
+    } else if (AbletonLinkWrapper::IsInstance(linkObject)) {
+        auto* link = Napi::ObjectWrap<AbletonLinkWrapper>::Unwrap(linkObject);
+        timeline_ = link->CreateTimeline();
+        dependents_ = &link->Dependents();
+    }
+    if (!timeline_) {
+        dependents_ = nullptr;
+        Napi::TypeError::New(info.Env(), "Open AbletonLink or AbletonLinkAudio expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (info.Length() > 2 && info[2].IsObject()) {
+        auto options = info[2].As<Napi::Object>();
+        if (options.Get("fd").IsNumber()) {
+            fd_ = options.Get("fd").As<Napi::Number>().Int32Value();
+        }
+        if (options.Get("quantum").IsNumber()) {
+            quantum_ = options.Get("quantum").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("coarseMs").IsNumber()) {
+            const auto coarseMs = options.Get("coarseMs").As<Napi::Number>().DoubleValue();
+            coarse_ = std::chrono::microseconds(
+                static_cast<long long>(std::max(0.0, coarseMs) * 1000.0));
+        }
+        if (options.Get("clockWhileStopped").IsBoolean()) {
+            clockWhileStopped_ = options.Get("clockWhileStopped").As<Napi::Boolean>().Value();
+        }
+    }
+
+    const bool hasCallback = info.Length() > 1 && info[1].IsFunction();
+    if (!hasCallback && fd_ < 0) {
+        timeline_.reset();
+        dependents_ = nullptr;
+        Napi::TypeError::New(info.Env(), "Event callback or fd option expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+#if !defined(_WIN32)
+    if (fd_ >= 0) {
+        if (fcntl(fd_, F_GETFL) < 0) {
+            timeline_.reset();
+            dependents_ = nullptr;
+            Napi::TypeError::New(info.Env(), "fd option is not an open file descriptor")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+    }
+#endif
+    if (hasCallback) {
+        dispatch_ = Napi::ThreadSafeFunction::New(
+            info.Env(), info[1].As<Napi::Function>(), "LinkMidiClockDispatch", 0, 1);
+        dispatch_.Unref(info.Env());
+    }
+
+    linkRef_ = Napi::Persistent(linkObject);
+    linkRef_.SuppressDestruct();
+
+    dependentId_ = dependents_->Add([this]() {
+        dependents_ = nullptr;
+        CloseInternal();
+    });
+}
+
+AbletonLinkMidiClockWrapper::~AbletonLinkMidiClockWrapper() {
+    CloseInternal();
+}
+
+void AbletonLinkMidiClockWrapper::Start(const Napi::CallbackInfo& info) {
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "MIDI clock is closed").ThrowAsJavaScriptException();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return;
+        }
+        running_ = true;
+    }
+#if !defined(_WIN32)
+    if (fd_ >= 0) {
+        // The flag lives on the open file description, which the caller and
+        // any dups share, so it is only set while the clock runs.
+        const int flags = fcntl(fd_, F_GETFL);
+        restoreBlocking_ = flags >= 0 && (flags & O_NONBLOCK) == 0;
+        if (restoreBlocking_) {
+            fcntl(fd_, F_SETFL, flags | O_NONBLOCK);
+        }
+    }
+#endif
+    thread_ = std::thread([this]() { Run(); });
+    if (dispatch_) {
+        dispatch_.Ref(info.Env());
+    }
+}
+
+void AbletonLinkMidiClockWrapper::Stop(const Napi::CallbackInfo& info) {
+    StopThread();
+}
+
+Napi::Value AbletonLinkMidiClockWrapper::IsRunning(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Napi::Boolean::New(info.Env(), running_);
+}
+
+Napi::Value AbletonLinkMidiClockWrapper::Status(const Napi::CallbackInfo& info) {
+    auto result = Napi::Object::New(info.Env());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.Set("running", running_);
+    }
+    result.Set("written",
+               static_cast<double>(written_.load(std::memory_order_relaxed)));
+    result.Set("dropped",
+               static_cast<double>(dropped_.load(std::memory_order_relaxed)));
+    return result;
+}
+
+void AbletonLinkMidiClockWrapper::Close(const Napi::CallbackInfo& info) {
+    CloseInternal();
+}
+
+void AbletonLinkMidiClockWrapper::Run() {
+    ThreadPolicyScope policy("midi-clock");
+    std::unique_lock<std::mutex> lock(mutex_);
+    timeline_->Capture();
+    lastPlaying_ = timeline_->IsPlaying();
+    lastTick_ = static_cast<int64_t>(std::floor(
+        timeline_->BeatAtTime(timeline_->Now(), quantum_) * kPulsesPerQuarterNote));
+    transportPending_ = false;
+
+    while (running_) {
+        timeline_->Capture();
+        const auto now = timeline_->Now();
+
+        const bool playing = timeline_->IsPlaying();
+        if (playing != lastPlaying_) {
+            // A second edge before the first was sent cancels it.
+            transportPending_ = !transportPending_;
+            transportStart_ = playing;
+            transportTime_ = timeline_->TimeForIsPlaying();
+            lastPlaying_ = playing;
+        }
+
+        const auto current = static_cast<int64_t>(
+            std::floor(timeline_->BeatAtTime(now, quantum_) * kPulsesPerQuarterNote));
+        const bool clockOn = playing || clockWhileStopped_;
+        if (!clockOn || current < lastTick_ - kPulsesPerQuarterNote ||
+            current > lastTick_ + kPulsesPerQuarterNote) {
+            // Resynchronize after a timeline jump (e.g. forceBeatAtTime) or a
+            // stall of more than a beat, instead of sending a burst of pulses.
+            // Pulses that are only slightly late are still sent.
+            lastTick_ = current;
+        }
+        const auto tick = lastTick_ + 1;
+        const auto tickTime = timeline_->TimeAtBeat(
+            static_cast<double>(tick) / kPulsesPerQuarterNote, quantum_);
+
+        auto next = clockOn ? tickTime : now + kRecheckInterval;
+        if (transportPending_) {
+            next = std::min(next, transportTime_);
+        }
+        const auto remaining = next - now;
+        if (remaining > coarse_) {
+            wake_.wait_for(lock, std::min(remaining - coarse_, kRecheckInterval));
+            continue;
+        }
+        if (remaining.count() > 0) {
+            lock.unlock();
+            SleepUntilLinkTime(*timeline_, next);
+            lock.lock();
+            if (!running_) {
+                break;
+            }
+        }
+
+        // Transport messages precede the clock pulse they coincide with.
+        if (transportPending_ && transportTime_ <= next) {
+            EmitTransport();
+        }
+        if (clockOn && tickTime <= next) {
+            Emit(kMidiClock, 0, tickTime);
+            lastTick_ = tick;
+        }
+        Flush();
+
+        if (outSize_ > 0) {
+            // Written without mutex_ so a slow fd never blocks the JS thread.
+            lock.unlock();
+            WriteOut();
+            lock.lock();
+        }
+    }
+}
+
+void AbletonLinkMidiClockWrapper::WriteOut() {
+    // Clock thread only. The rest of a message a short write split goes out
+    // before anything new, so the receiver never sees a torn Song Position
+    // Pointer; while it cannot be sent, new messages are dropped whole.
+    if (tailSize_ > 0) {
+        const auto sent = WriteBytes(fd_, tail_, tailSize_);
+        std::memmove(tail_, tail_ + sent, tailSize_ - sent);
+        tailSize_ -= sent;
+    }
+    uint64_t started = 0;
+    if (tailSize_ == 0) {
+        // One write per pass; on pipes it is atomic and never short.
+        const auto sent = WriteBytes(fd_, out_, outSize_);
+        for (std::size_t i = 0; i < sent; ++i) {
+            started += IsStatusByte(out_[i]) ? 1 : 0;
+        }
+        // Keep the data bytes of a message whose status byte went out.
+        auto end = sent;
+        while (end < outSize_ && !IsStatusByte(out_[end])) {
+            ++end;
+        }
+        std::memcpy(tail_, out_ + sent, end - sent);
+        tailSize_ = end - sent;
+    }
+    written_.fetch_add(started, std::memory_order_relaxed);
+    dropped_.fetch_add(outMessages_ - started, std::memory_order_relaxed);
+    outSize_ = 0;
+    outMessages_ = 0;
+}
+
+void AbletonLinkMidiClockWrapper::EmitTransport() {
+    // Called with mutex_ held on the clock thread.
+    transportPending_ = false;
+    if (!transportStart_) {
+        Emit(kMidiStop, 0, transportTime_);
+        return;
+    }
+    const auto beat = timeline_->BeatAtTime(transportTime_, quantum_);
+    if (beat < 0.5 / kPulsesPerQuarterNote) {
+        Emit(kMidiStart, 0, transportTime_);
+        return;
+    }
+    // Song position is counted in MIDI beats (sixteenth notes), 14 bits wide.
+    const auto position =
+        static_cast<int>(std::min(16383.0, std::max(0.0, std::round(beat * 4.0))));
+    Emit(kMidiSongPosition, position, transportTime_);
+    Emit(kMidiContinue, 0, transportTime_);
+}
+
+void AbletonLinkMidiClockWrapper::Emit(uint8_t status,
+                                       int value,
+                                       std::chrono::microseconds time) {
+    // Called with mutex_ held on the clock thread.
+    if (fd_ >= 0 && outSize_ + 3 <= sizeof(out_)) {
+        out_[outSize_++] = status;
+        if (status == kMidiSongPosition) {
+            out_[outSize_++] = static_cast<uint8_t>(value & 0x7F);
+            out_[outSize_++] = static_cast<uint8_t>((value >> 7) & 0x7F);
+        }
+        ++outMessages_;
+    }
+    if (dispatch_) {
+        // Batch layout per event: time (seconds), status byte, value.
+        pending_.push_back(time.count() / 1000000.0);
+        pending_.push_back(static_cast<double>(status));
+        pending_.push_back(static_cast<double>(value));
+    }
+}
+
+void AbletonLinkMidiClockWrapper::Flush() {
+    // Called with mutex_ held.
+    if (!dispatch_ || pending_.empty() || dispatchPending_) {
+        return;
+    }
+    dispatchPending_ = true;
+    const auto status = dispatch_.NonBlockingCall(
+        [this](Napi::Env env, Napi::Function callback) { Dispatch(env, callback); });
+    if (status != napi_ok) {
+        dispatchPending_ = false;
+    }
+}
+
+void AbletonLinkMidiClockWrapper::Dispatch(Napi::Env env, Napi::Function callback) {
+    std::vector<double> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.swap(pending_);
+        dispatchPending_ = false;
+    }
+    if (batch.empty()) {
+        return;
+    }
+    auto events = Napi::Float64Array::New(env, batch.size());
+    std::memcpy(events.Data(), batch.data(), batch.size() * sizeof(double));
+    callback.Call({events});
+}
+
+void AbletonLinkMidiClockWrapper::StopThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+#if !defined(_WIN32)
+    if (restoreBlocking_) {
+        const int flags = fcntl(fd_, F_GETFL);
+        if (flags >= 0) {
+            fcntl(fd_, F_SETFL, flags & ~O_NONBLOCK);
+        }
+        restoreBlocking_ = false;
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.clear();
+    if (dispatch_) {
+        dispatch_.Unref(Env());
+    }
+}
+
+void AbletonLinkMidiClockWrapper::CloseInternal() {
+    StopThread();
+    if (dispatch_) {
+        dispatch_.Abort();
+        dispatch_.Release();
+        dispatch_ = Napi::ThreadSafeFunction();
+    }
+    if (dependents_) {
+        dependents_->Remove(dependentId_);
+        dependents_ = nullptr;
+    }
+    timeline_.reset();
+    linkRef_.Reset();
+}
+
+Napi::Object InitAbletonLinkMidiClock(Napi::Env env, Napi::Object exports) {
+    AbletonLinkMidiClockWrapper::Init(env, exports);
+    return exports;
+}
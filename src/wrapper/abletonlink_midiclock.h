@@ -0,0 +1,79 @@
+#ifndef ABLETONLINK_MIDICLOCK_H
+#define ABLETONLINK_MIDICLOCK_H
+
+#include "abletonlink_timeline.h"
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 24-PPQN MIDI clock generator driven by the Link timeline. A dedicated thread
+// sleeps to the Link time of each clock pulse and of every start/stop
+// transition, then writes raw MIDI bytes to a file descriptor and/or queues
+// timestamped events that are delivered to JS in batches.
+class AbletonLinkMidiClockWrapper : public Napi::ObjectWrap<AbletonLinkMidiClockWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    AbletonLinkMidiClockWrapper(const Napi::CallbackInfo& info);
+    ~AbletonLinkMidiClockWrapper();
+
+private:
+    void Start(const Napi::CallbackInfo& info);
+    void Stop(const Napi::CallbackInfo& info);
+    Napi::Value IsRunning(const Napi::CallbackInfo& info);
+    Napi::Value Status(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void Run();
+    void EmitTransport();
+    void Emit(uint8_t status, int value, std::chrono::microseconds time);
+    void Flush();
+    void WriteOut();
+    void Dispatch(Napi::Env env, Napi::Function callback);
+    void StopThread();
+    void CloseInternal();
+
+    std::unique_ptr<LinkTimeline> timeline_;
+    double quantum_ = 4.0;
+    std::chrono::microseconds coarse_{2000};
+    int fd_ = -1;
+    // Set while the clock runs if start() made fd_ non-blocking.
+    bool restoreBlocking_ = false;
+    bool clockWhileStopped_ = true;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+    bool dispatchPending_ = false;
+    std::vector<double> pending_;
+    std::thread thread_;
+
+    // Clock thread state.
+    int64_t lastTick_ = 0;
+    bool lastPlaying_ = false;
+    bool transportPending_ = false;
+    bool transportStart_ = false;
+    std::chrono::microseconds transportTime_{0};
+    uint8_t out_[16];
+    std::size_t outSize_ = 0;
+    uint64_t outMessages_ = 0;
+    // Data bytes of a message that a short write split.
+    uint8_t tail_[2];
+    std::size_t tailSize_ = 0;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    Napi::ThreadSafeFunction dispatch_;
+    Napi::ObjectReference linkRef_;
+    LinkDependents* dependents_ = nullptr;
+    uint64_t dependentId_ = 0;
+};
+
+Napi::Object InitAbletonLinkMidiClock(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_MIDICLOCK_H
@@ -0,0 +1,783 @@
+#include "abletonlink_mixbus.h"
+#include "abletonlink_addon.h"
+#include "abletonlink_audio.h"
+#include "abletonlink_thread_policy.h"
+#include "abletonlink_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ABLETONLINK_MIXBUS_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ABLETONLINK_MIXBUS_NEON 1
+#endif
+
+namespace {
+constexpr double kBeatEpsilon = 1e-6;
+constexpr double kDefaultRampMs = 10.0;
+constexpr std::size_t kDefaultStreamFrames = 8192;
+constexpr double kQuarterPi = 0.78539816339744830962;
+
+#if defined(ABLETONLINK_MIXBUS_SSE2)
+// Set bits in a 4-lane comparison mask.
+constexpr uint8_t kMaskBits[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+#endif
+
+void ToFloat(const int16_t* src, float* dst, std::size_t count) {
+    std::size_t i = 0;
+#if defined(ABLETONLINK_MIXBUS_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // Interleaving a vector with itself and shifting right sign-extends.
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(hi));
+    }
+#elif defined(ABLETONLINK_MIXBUS_NEON)
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t s = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))));
+        vst1q_f32(dst + i + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = src[i];
+    }
+}
+
+// Mono to interleaved stereo.
+void ToFloatDuplicated(const int16_t* src, float* dst, std::size_t frames) {
+    std::size_t i = 0;
+#if defined(ABLETONLINK_MIXBUS_SSE2)
+    for (; i + 4 <= frames; i += 4) {
+        const __m128i s = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i pairs = _mm_unpacklo_epi16(s, s);
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(pairs, pairs), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(pairs, pairs), 16);
+        _mm_storeu_ps(dst + 2 * i, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps(dst + 2 * i + 4, _mm_cvtepi32_ps(hi));
+    }
+#elif defined(ABLETONLINK_MIXBUS_NEON)
+    for (; i + 4 <= frames; i += 4) {
+        const float32x4_t f = vcvtq_f32_s32(vmovl_s16(vld1_s16(src + i)));
+        const float32x4x2_t pairs = vzipq_f32(f, f);
+        vst1q_f32(dst + 2 * i, pairs.val[0]);
+        vst1q_f32(dst + 2 * i + 4, pairs.val[1]);
+    }
+#endif
+    for (; i < frames; ++i) {
+        dst[2 * i] = src[i];
+        dst[2 * i + 1] = src[i];
+    }
+}
+
+void Expand(const int16_t* src, uint32_t inChannels, uint32_t outChannels, std::size_t frames,
+            float* dst) {
+    if (inChannels == outChannels) {
+        ToFloat(src, dst, frames * inChannels);
+    } else if (inChannels == 1) {
+        ToFloatDuplicated(src, dst, frames);
+    } else {
+        for (std::size_t i = 0; i < frames; ++i) {
+            dst[i] = 0.5f * (static_cast<float>(src[2 * i]) + src[2 * i + 1]);
+        }
+    }
+}
+
+// acc += src * gain, where the gain of channel c at frame f is
+// start[c] + step[c] * f. channels is 1 or 2, so a 4-lane vector always
+// covers whole frames.
+void Accumulate(float* acc, const float* src, std::size_t frames, uint32_t channels,
+                const float* start, const float* step) {
+    const auto count = frames * channels;
+    std::size_t i = 0;
+#if defined(ABLETONLINK_MIXBUS_SSE2) || defined(ABLETONLINK_MIXBUS_NEON)
+    float gains[4];
+    float steps[4];
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+        const auto c = lane % channels;
+        gains[lane] = start[c] + step[c] * static_cast<float>(lane / channels);
+        steps[lane] = step[c] * static_cast<float>(4 / channels);
+    }
+#endif
+#if defined(ABLETONLINK_MIXBUS_SSE2)
+    __m128 gain = _mm_loadu_ps(gains);
+    const __m128 delta = _mm_loadu_ps(steps);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 scaled = _mm_mul_ps(_mm_loadu_ps(src + i), gain);
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), scaled));
+        gain = _mm_add_ps(gain, delta);
+    }
+#elif defined(ABLETONLINK_MIXBUS_NEON)
+    float32x4_t gain = vld1q_f32(gains);
+    const float32x4_t delta = vld1q_f32(steps);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(acc + i, vmlaq_f32(vld1q_f32(acc + i), vld1q_f32(src + i), gain));
+        gain = vaddq_f32(gain, delta);
+    }
+#endif
+    for (; i < count; ++i) {
+        const auto c = i % channels;
+        acc[i] += src[i] * (start[c] + step[c] * static_cast<float>(i / channels));
+    }
+}
+
+// Rounds and saturates the mix to int16. Returns the number of samples that
+// were out of range.
+uint64_t Saturate(const float* src, int16_t* out, std::size_t count) {
+    uint64_t clipped = 0;
+    std::size_t i = 0;
+#if defined(ABLETONLINK_MIXBUS_SSE2)
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_loadu_ps(src + i);
+        const __m128 b = _mm_loadu_ps(src + i + 4);
+        clipped += kMaskBits[_mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(a, lo), _mm_cmpgt_ps(a, hi)))];
+        clipped += kMaskBits[_mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(b, lo), _mm_cmpgt_ps(b, hi)))];
+        // Clamping first keeps values beyond int32 from wrapping in the
+        // conversion; the pack then saturates nothing further.
+        const __m128i packed =
+            _mm_packs_epi32(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(a, lo), hi)),
+                            _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(b, lo), hi)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#elif defined(ABLETONLINK_MIXBUS_NEON)
+    const float32x4_t lo = vdupq_n_f32(-32768.0f);
+    const float32x4_t hi = vdupq_n_f32(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        const float32x4_t a = vld1q_f32(src + i);
+        const float32x4_t b = vld1q_f32(src + i + 4);
+        const uint32x4_t outside = vaddq_u32(
+            vshrq_n_u32(vorrq_u32(vcltq_f32(a, lo), vcgtq_f32(a, hi)), 31),
+            vshrq_n_u32(vorrq_u32(vcltq_f32(b, lo), vcgtq_f32(b, hi)), 31));
+        clipped += vaddvq_u32(outside);
+        const int16x8_t packed = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)),
+                                              vqmovn_s32(vcvtnq_s32_f32(b)));
+        vst1q_s16(out + i, packed);
+    }
+#endif
+    for (; i < count; ++i) {
+        const auto value = src[i];
+        if (value < -32768.0f || value > 32767.0f) {
+            ++clipped;
+        }
+        out[i] = static_cast<int16_t>(std::lrint(std::clamp(value, -32768.0f, 32767.0f)));
+    }
+    return clipped;
+}
+
+uint32_t RampFrames(const Napi::CallbackInfo& info, std::size_t index, uint32_t sampleRate) {
+    auto rampMs = kDefaultRampMs;
+    if (info.Length() > index && info[index].IsNumber()) {
+        rampMs = std::max(0.0, info[index].As<Napi::Number>().DoubleValue());
+    }
+    return static_cast<uint32_t>(std::lround(rampMs * sampleRate / 1000.0));
+}
+} // namespace
+
+Napi::Object AbletonLinkAudioMixBusWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "AbletonLinkAudioMixBus", {
+        InstanceMethod("addClip", &AbletonLinkAudioMixBusWrapper::AddClip),
+        InstanceMethod("addStream", &AbletonLinkAudioMixBusWrapper::AddStream),
+        InstanceMethod("write", &AbletonLinkAudioMixBusWrapper::Write),
+        InstanceMethod("setGain", &AbletonLinkAudioMixBusWrapper::SetGain),
+        InstanceMethod("setPan", &AbletonLinkAudioMixBusWrapper::SetPan),
+        InstanceMethod("removeInput", &AbletonLinkAudioMixBusWrapper::RemoveInput),
+        InstanceMethod("start", &AbletonLinkAudioMixBusWrapper::Start),
+        InstanceMethod("stop", &AbletonLinkAudioMixBusWrapper::Stop),
+        InstanceMethod("status", &AbletonLinkAudioMixBusWrapper::Status),
+        InstanceMethod("close", &AbletonLinkAudioMixBusWrapper::Close),
+    });
+
+    AddonData(env).mixBus = Napi::Persistent(func);
+    exports.Set("AbletonLinkAudioMixBus", func);
+    return exports;
+}
+
+AbletonLinkAudioMixBusWrapper::AbletonLinkAudioMixBusWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<AbletonLinkAudioMixBusWrapper>(info) {
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
+        Napi::TypeError::New(info.Env(), "LinkAudio instance and sink expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto linkObject = info[0].As<Napi::Object>();
+    auto sinkObject = info[1].As<Napi::Object>();
+    if (!AbletonLinkAudioWrapper::IsInstance(linkObject) ||
+        !AbletonLinkAudioSinkWrapper::IsInstance(sinkObject)) {
+        Napi::TypeError::New(info.Env(), "AbletonLinkAudio and AbletonLinkAudioSink expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (info.Length() > 2 && info[2].IsObject()) {
+        auto options = info[2].As<Napi::Object>();
+        if (options.Get("numChannels").IsNumber()) {
+            numChannels_ = options.Get("numChannels").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Get("sampleRate").IsNumber()) {
+            sampleRate_ = options.Get("sampleRate").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Get("quantum").IsNumber()) {
+            quantum_ = options.Get("quantum").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("framesPerBuffer").IsNumber()) {
+            framesPerBuffer_ = std::max<std::size_t>(
+                1, options.Get("framesPerBuffer").As<Napi::Number>().Uint32Value());
+        }
+        if (options.Get("leadMs").IsNumber()) {
+            const auto leadMs = options.Get("leadMs").As<Napi::Number>().DoubleValue();
+            lead_ = std::chrono::microseconds(
+                static_cast<long long>(std::max(0.0, leadMs) * 1000.0));
+        }
+    }
+    if (numChannels_ != 1 && numChannels_ != 2) {
+        Napi::TypeError::New(info.Env(), "numChannels must be 1 or 2")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    if (sampleRate_ == 0 || !(quantum_ > 0.0)) {
+        Napi::TypeError::New(info.Env(), "Sample rate and quantum must be positive")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto* sinkWrapper = Napi::ObjectWrap<AbletonLinkAudioSinkWrapper>::Unwrap(sinkObject);
+    if (!sinkWrapper->Sink()) {
+        Napi::Error::New(info.Env(), "Sink is closed").ThrowAsJavaScriptException();
+        return;
+    }
+    auto* link = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(linkObject);
+    timeline_ = link->CreateTimeline();
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "AbletonLinkAudio is closed")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    link_ = &link->LinkAudio();
+    sink_ = sinkWrapper->Sink();
+    sinkStats_ = sinkWrapper->Stats();
+    state_ = std::make_unique<ableton::LinkAudio::SessionState>(
+        link_->captureAppSessionState());
+    mix_.reserve(framesPerBuffer_ * numChannels_);
+    scratch_.reserve(framesPerBuffer_ * numChannels_);
+
+    linkRef_ = Napi::Persistent(linkObject);
+    linkRef_.SuppressDestruct();
+    sinkRef_ = Napi::Persistent(sinkObject);
+    sinkRef_.SuppressDestruct();
+
+    // The render thread must stop before the LinkAudio instance is destroyed.
+    dependents_ = &link->Dependents();
+    dependentId_ = dependents_->Add([this]() {
+        dependents_ = nullptr;
+        CloseInternal();
+    });
+}
+
+AbletonLinkAudioMixBusWrapper::~AbletonLinkAudioMixBusWrapper() {
+    CloseInternal();
+}
+
+bool AbletonLinkAudioMixBusWrapper::ReadInputOptions(const Napi::CallbackInfo& info,
+                                                     std::size_t index, Input& input) {
+    if (info.Length() <= index || !info[index].IsObject()) {
+        return true;
+    }
+    auto options = info[index].As<Napi::Object>();
+    if (options.Get("gain").IsNumber()) {
+        input.gain = options.Get("gain").As<Napi::Number>().DoubleValue();
+    }
+    if (options.Get("pan").IsNumber()) {
+        input.pan = options.Get("pan").As<Napi::Number>().DoubleValue();
+    }
+    if (options.Get("loop").IsBoolean()) {
+        input.loop = options.Get("loop").As<Napi::Boolean>().Value();
+    }
+    if (!std::isfinite(input.gain) || !std::isfinite(input.pan)) {
+        Napi::TypeError::New(info.Env(), "Gain and pan must be finite")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    input.pan = std::clamp(input.pan, -1.0, 1.0);
+    return true;
+}
+
+Napi::Value AbletonLinkAudioMixBusWrapper::AddInput(Napi::Env env, std::shared_ptr<Input> input) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    input->id = nextInputId_++;
+    inputs_.push_back(input);
+    return Napi::Number::New(env, static_cast<double>(input->id));
+}
+
+Napi::Value AbletonLinkAudioMixBusWrapper::AddClip(const Napi::CallbackInfo& info) {
+    if (info.Length() < 2 || !info[0].IsTypedArray() || !info[1].IsNumber() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_int16_array) {
+        Napi::TypeError::New(info.Env(), "Int16Array samples and numChannels expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    auto samples = info[0].As<Napi::Int16Array>();
+    auto input = std::make_shared<Input>();
+    input->isClip = true;
+    input->numChannels = info[1].As<Napi::Number>().Uint32Value();
+    if ((input->numChannels != 1 && input->numChannels != 2) ||
+        samples.ElementLength() < input->numChannels) {
+        Napi::TypeError::New(info.Env(), "Clip must be mono or stereo and hold at least one frame")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    if (!ReadInputOptions(info, 2, *input)) {
+        return info.Env().Null();
+    }
+    input->clipFrames = samples.ElementLength() / input->numChannels;
+    input->clip.assign(samples.Data(), samples.Data() + input->clipFrames * input->numChannels);
+    return AddInput(info.Env(), std::move(input));
+}
+
+Napi::Value AbletonLinkAudioMixBusWrapper::AddStream(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "numChannels expected").ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    auto input = std::make_shared<Input>();
+    input->numChannels = info[0].As<Napi::Number>().Uint32Value();
+    if (input->numChannels != 1 && input->numChannels != 2) {
+        Napi::TypeError::New(info.Env(), "Stream must be mono or stereo")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    if (!ReadInputOptions(info, 1, *input)) {
+        return info.Env().Null();
+    }
+    input->capacityFrames = kDefaultStreamFrames;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        auto capacity = info[1].As<Napi::Object>().Get("capacityFrames");
+        if (capacity.IsNumber()) {
+            input->capacityFrames =
+                std::max<std::size_t>(1, capacity.As<Napi::Number>().Uint32Value());
+        }
+    }
+    input->ring.resize(input->capacityFrames * input->numChannels);
+    return AddInput(info.Env(), std::move(input));
+}
+
+std::shared_ptr<AbletonLinkAudioMixBusWrapper::Input> AbletonLinkAudioMixBusWrapper::FindInput(
+    uint64_t id) {
+    // Called with mutex_ held.
+    for (const auto& input : inputs_) {
+        if (input->id == id && !input->removing) {
+            return input;
+        }
+    }
+    return nullptr;
+}
+
+Napi::Value AbletonLinkAudioMixBusWrapper::Write(const Napi::CallbackInfo& info) {
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsTypedArray() ||
+        info[1].As<Napi::TypedArray>().TypedArrayType() != napi_int16_array) {
+        Napi::TypeError::New(info.Env(), "Input id and Int16Array samples expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    std::shared_ptr<Input> input;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        input = FindInput(static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value()));
+    }
+    if (!input || input->isClip) {
+        Napi::Error::New(info.Env(), "No stream input with that id")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+
+    auto samples = info[1].As<Napi::Int16Array>();
+    const auto channels = input->numChannels;
+    const auto capacity = input->capacityFrames;
+    const auto written = input->framesWritten.load(std::memory_order_relaxed);
+    const auto read = input->framesRead.load(std::memory_order_acquire);
+    const auto space = capacity - static_cast<std::size_t>(written - read);
+    const auto frames = std::min(samples.ElementLength() / channels, space);
+    const auto begin = static_cast<std::size_t>(written % capacity);
+    const auto first = std::min(frames, capacity - begin);
+    std::memcpy(input->ring.data() + begin * channels, samples.Data(),
+                first * channels * sizeof(int16_t));
+    std::memcpy(input->ring.data(), samples.Data() + first * channels,
+                (frames - first) * channels * sizeof(int16_t));
+    input->framesWritten.store(written + frames, std::memory_order_release);
+    return Napi::Number::New(info.Env(), static_cast<double>(frames));
+}
+
+bool AbletonLinkAudioMixBusWrapper::SetParameter(const Napi::CallbackInfo& info, bool pan) {
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+        Napi::TypeError::New(info.Env(), pan ? "Input id and pan expected"
+                                             : "Input id and gain expected")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    const auto value = info[1].As<Napi::Number>().DoubleValue();
+    if (!std::isfinite(value)) {
+        Napi::TypeError::New(info.Env(), "Gain and pan must be finite")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto input = FindInput(static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value()));
+    if (!input) {
+        return false;
+    }
+    if (pan) {
+        input->pan = std::clamp(value, -1.0, 1.0);
+    } else {
+        input->gain = value;
+    }
+    input->rampFrames = RampFrames(info, 2, sampleRate_);
+    input->changed = true;
+    return true;
+}
+
+Napi::Value AbletonLinkAudioMixBusWrapper::SetGain(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), SetParameter(info, false));
+}
+
+Napi::Value AbletonLinkAudioMixBusWrapper::SetPan(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), SetParameter(info, true));
+}
+
+Napi::Value AbletonLinkAudioMixBusWrapper::RemoveInput(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Input id expected").ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    const auto id = static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value());
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto input = FindInput(id);
+    if (!input) {
+        return Napi::Boolean::New(info.Env(), false);
+    }
+    if (!running_) {
+        inputs_.erase(std::find(inputs_.begin(), inputs_.end(), input));
+        return Napi::Boolean::New(info.Env(), true);
+    }
+    // Fade out; the render thread drops the input once the ramp completes.
+    input->gain = 0.0;
+    input->rampFrames = RampFrames(info, 1, sampleRate_);
+    input->changed = true;
+    input->removing = true;
+    return Napi::Boolean::New(info.Env(), true);
+}
+
+void AbletonLinkAudioMixBusWrapper::Start(const Napi::CallbackInfo& info) {
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "Mix bus is closed").ThrowAsJavaScriptException();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return;
+        }
+        running_ = true;
+    }
+    thread_ = std::thread([this]() { Run(); });
+}
+
+void AbletonLinkAudioMixBusWrapper::Stop(const Napi::CallbackInfo& info) {
+    StopThread();
+}
+
+Napi::Value AbletonLinkAudioMixBusWrapper::Status(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    auto obj = Napi::Object::New(env);
+    std::lock_guard<std::mutex> lock(mutex_);
+    obj.Set("running", running_);
+    obj.Set("framesCommitted",
+            static_cast<double>(framesCommitted_.load(std::memory_order_relaxed)));
+    obj.Set("buffersDropped",
+            static_cast<double>(buffersDropped_.load(std::memory_order_relaxed)));
+    obj.Set("clippedSamples",
+            static_cast<double>(clippedSamples_.load(std::memory_order_relaxed)));
+    auto inputs = Napi::Array::New(env);
+    uint32_t index = 0;
+    uint32_t removing = 0;
+    for (const auto& input : inputs_) {
+        if (input->removing) {
+            ++removing;
+            continue;
+        }
+        auto entry = Napi::Object::New(env);
+        entry.Set("id", static_cast<double>(input->id));
+        entry.Set("type", input->isClip ? "clip" : "stream");
+        entry.Set("numChannels", static_cast<double>(input->numChannels));
+        entry.Set("gain", input->gain);
+        entry.Set("pan", input->pan);
+        if (!input->isClip) {
+            const auto buffered = input->framesWritten.load(std::memory_order_acquire) -
+                                  input->framesRead.load(std::memory_order_acquire);
+            entry.Set("bufferedFrames", static_cast<double>(buffered));
+            entry.Set("underruns",
+                      static_cast<double>(input->underruns.load(std::memory_order_relaxed)));
+        }
+        inputs.Set(index++, entry);
+    }
+    obj.Set("inputs", inputs);
+    obj.Set("removingInputs", static_cast<double>(removing));
+    return obj;
+}
+
+void AbletonLinkAudioMixBusWrapper::Close(const Napi::CallbackInfo& info) {
+    CloseInternal();
+}
+
+void AbletonLinkAudioMixBusWrapper::Run() {
+    ThreadPolicyScope policy("mixbus");
+    const auto frameMicros = 1000000.0 / sampleRate_;
+    bool synced = false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        const auto now = static_cast<double>(timeline_->Now().count());
+        if (!synced || bufferTime_ < now - framesPerBuffer_ * frameMicros) {
+            // First buffer, or the thread fell behind: restart the stream one
+            // lead ahead of the clock. Clip positions follow from their
+            // launch times.
+            bufferTime_ = now + lead_.count();
+            synced = true;
+        }
+
+        const auto ahead = bufferTime_ - now;
+        if (ahead > lead_.count()) {
+            wake_.wait_for(lock, std::chrono::microseconds(
+                                     static_cast<long long>(ahead - lead_.count())));
+            continue;
+        }
+        lock.unlock();
+        RenderBuffer();
+        lock.lock();
+    }
+}
+
+void AbletonLinkAudioMixBusWrapper::TakeInputs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Faded-out inputs leave once their ramp has been rendered.
+    inputs_.erase(std::remove_if(inputs_.begin(), inputs_.end(),
+                                 [](const std::shared_ptr<Input>& input) {
+                                     return input->removing && !input->changed &&
+                                            input->ramp.framesLeft == 0;
+                                 }),
+                  inputs_.end());
+
+    for (const auto& input : inputs_) {
+        if (!input->changed) {
+            continue;
+        }
+        auto& ramp = input->ramp;
+        const auto gain = static_cast<float>(input->gain);
+        if (numChannels_ == 1) {
+            ramp.target[0] = ramp.target[1] = gain;
+        } else if (input->numChannels == 1) {
+            // Equal-power pan for mono inputs.
+            const auto angle = (input->pan + 1.0) * kQuarterPi;
+            ramp.target[0] = gain * static_cast<float>(std::cos(angle));
+            ramp.target[1] = gain * static_cast<float>(std::sin(angle));
+        } else {
+            // Balance for stereo inputs, unity at center.
+            ramp.target[0] = gain * static_cast<float>(std::min(1.0, 1.0 - input->pan));
+            ramp.target[1] = gain * static_cast<float>(std::min(1.0, 1.0 + input->pan));
+        }
+        if (!input->mixed || input->rampFrames == 0) {
+            ramp.current[0] = ramp.target[0];
+            ramp.current[1] = ramp.target[1];
+            ramp.framesLeft = 0;
+        } else {
+            ramp.framesLeft = input->rampFrames;
+        }
+        input->changed = false;
+    }
+    active_.assign(inputs_.begin(), inputs_.end());
+}
+
+void AbletonLinkAudioMixBusWrapper::MixSegment(Input& input, const int16_t* src,
+                                               std::size_t offset, std::size_t frames) {
+    const auto channels = numChannels_;
+    scratch_.resize(frames * channels);
+    Expand(src, input.numChannels, channels, frames, scratch_.data());
+
+    auto& ramp = input.ramp;
+    auto* acc = mix_.data() + offset * channels;
+    std::size_t done = 0;
+    if (ramp.framesLeft > 0) {
+        done = std::min<std::size_t>(frames, ramp.framesLeft);
+        float step[2];
+        for (int c = 0; c < 2; ++c) {
+            step[c] = (ramp.target[c] - ramp.current[c]) / ramp.framesLeft;
+        }
+        Accumulate(acc, scratch_.data(), done, channels, ramp.current, step);
+        ramp.framesLeft -= static_cast<uint32_t>(done);
+        for (int c = 0; c < 2; ++c) {
+            ramp.current[c] =
+                ramp.framesLeft == 0 ? ramp.target[c] : ramp.current[c] + step[c] * done;
+        }
+    }
+    if (done < frames) {
+        const float flat[2] = {0.0f, 0.0f};
+        Accumulate(acc + done * channels, scratch_.data() + done * channels, frames - done,
+                   channels, ramp.current, flat);
+    }
+    input.mixed = true;
+}
+
+void AbletonLinkAudioMixBusWrapper::SkipRamp(GainRamp& ramp, std::size_t frames) {
+    if (ramp.framesLeft == 0) {
+        return;
+    }
+    const auto done = std::min<std::size_t>(frames, ramp.framesLeft);
+    for (int c = 0; c < 2; ++c) {
+        const auto step = (ramp.target[c] - ramp.current[c]) / ramp.framesLeft;
+        ramp.current[c] = done == ramp.framesLeft ? ramp.target[c] : ramp.current[c] + step * done;
+    }
+    ramp.framesLeft -= static_cast<uint32_t>(done);
+}
+
+void AbletonLinkAudioMixBusWrapper::MixClip(Input& input, double beginMicros,
+                                            std::size_t numFrames) {
+    const auto frameMicros = 1000000.0 / sampleRate_;
+    if (!input.launched) {
+        // Launch on the first quantum boundary not yet committed.
+        const auto bufferBegin =
+            std::chrono::microseconds(static_cast<long long>(std::llround(beginMicros)));
+        const auto startBeat = state_->beatAtTime(bufferBegin, quantum_);
+        const auto launchBeat = std::ceil(startBeat / quantum_ - kBeatEpsilon) * quantum_;
+        input.launchTime = static_cast<double>(state_->timeAtBeat(launchBeat, quantum_).count());
+        input.launched = true;
+    }
+
+    const auto firstFrame =
+        static_cast<long long>(std::ceil((input.launchTime - beginMicros) / frameMicros));
+    auto frame = static_cast<std::size_t>(std::max(0LL, firstFrame));
+    while (frame < numFrames) {
+        auto position = static_cast<std::size_t>(static_cast<long long>(frame) - firstFrame);
+        if (input.loop) {
+            position %= input.clipFrames;
+        } else if (position >= input.clipFrames) {
+            break;
+        }
+        const auto count = std::min(numFrames - frame, input.clipFrames - position);
+        MixSegment(input, input.clip.data() + position * input.numChannels, frame, count);
+        frame += count;
+    }
+}
+
+void AbletonLinkAudioMixBusWrapper::MixStream(Input& input, std::size_t numFrames) {
+    const auto capacity = input.capacityFrames;
+    const auto read = input.framesRead.load(std::memory_order_relaxed);
+    const auto written = input.framesWritten.load(std::memory_order_acquire);
+    const auto take = std::min(static_cast<std::size_t>(written - read), numFrames);
+    std::size_t done = 0;
+    while (done < take) {
+        const auto index = static_cast<std::size_t>((read + done) % capacity);
+        const auto count = std::min(take - done, capacity - index);
+        MixSegment(input, input.ring.data() + index * input.numChannels, done, count);
+        done += count;
+    }
+    input.framesRead.store(read + take, std::memory_order_release);
+    if (take < numFrames && written > 0) {
+        input.underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AbletonLinkAudioMixBusWrapper::RenderBuffer() {
+    // Called on the render thread without mutex_.
+    TraceSpan span("mixbus", "render");
+    TakeInputs();
+    *state_ = link_->captureAppSessionState();
+    const auto frameMicros = 1000000.0 / sampleRate_;
+    const auto beginMicros = bufferTime_;
+    const auto bufferBegin =
+        std::chrono::microseconds(static_cast<long long>(std::llround(beginMicros)));
+    bufferTime_ += framesPerBuffer_ * frameMicros;
+
+    ableton::LinkAudioSink::BufferHandle handle(*sink_);
+    sinkStats_->Retained(static_cast<bool>(handle));
+    const auto numFrames =
+        handle ? std::min(framesPerBuffer_, handle.maxNumSamples / numChannels_) : 0;
+    if (numFrames == 0) {
+        buffersDropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const auto numSamples = numFrames * numChannels_;
+    mix_.assign(numSamples, 0.0f);
+    for (const auto& input : active_) {
+        const auto framesLeft = input->ramp.framesLeft;
+        if (input->isClip) {
+            MixClip(*input, beginMicros, numFrames);
+        } else {
+            MixStream(*input, numFrames);
+        }
+        if (input->ramp.framesLeft == framesLeft) {
+            // Nothing was mixed: an empty stream, or a clip before its launch
+            // or past its end. Ramps run in time, so a fade-out still ends.
+            SkipRamp(input->ramp, numFrames);
+        }
+    }
+    clippedSamples_.fetch_add(Saturate(mix_.data(), handle.samples, numSamples),
+                              std::memory_order_relaxed);
+
+    const auto beatsAtBufferBegin = state_->beatAtTime(bufferBegin, quantum_);
+    const auto committed = handle.commit(*state_, beatsAtBufferBegin, quantum_, numFrames,
+                                         numChannels_, sampleRate_);
+    sinkStats_->Committed(committed, numSamples * sizeof(int16_t));
+    if (committed) {
+        framesCommitted_.fetch_add(numFrames, std::memory_order_relaxed);
+    } else {
+        buffersDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AbletonLinkAudioMixBusWrapper::StopThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void AbletonLinkAudioMixBusWrapper::CloseInternal() {
+    StopThread();
+    if (dependents_) {
+        dependents_->Remove(dependentId_);
+        dependents_ = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inputs_.clear();
+    }
+    active_.clear();
+    sink_.reset();
+    sinkStats_.reset();
+    state_.reset();
+    timeline_.reset();
+    link_ = nullptr;
+    sinkRef_.Reset();
+    linkRef_.Reset();
+}
+
+Napi::Object InitAbletonLinkMixBus(Napi::Env env, Napi::Object exports) {
+    AbletonLinkAudioMixBusWrapper::Init(env, exports);
+    return exports;
+}
@@ -0,0 +1,136 @@
+#ifndef ABLETONLINK_MIXBUS_H
+#define ABLETONLINK_MIXBUS_H
+
+#include "abletonlink_stats.h"
+#include "abletonlink_timeline.h"
+#include <napi.h>
+#include <ableton/LinkAudio.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Native summing bus for a LinkAudio sink. A render thread mixes any number
+// of inputs into one published channel `lead` ahead of the Link clock:
+//
+//   clips    int16 clips launched on the next quantum boundary after they are
+//            added, optionally looped
+//   streams  single-producer rings that JS fills with write()
+//
+// Each input has a gain and pan that ramp linearly to new values. Inputs are
+// converted to float, summed and saturated back to int16 with SSE2/NEON where
+// available. All inputs run at the bus sample rate.
+class AbletonLinkAudioMixBusWrapper : public Napi::ObjectWrap<AbletonLinkAudioMixBusWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    AbletonLinkAudioMixBusWrapper(const Napi::CallbackInfo& info);
+    ~AbletonLinkAudioMixBusWrapper();
+
+private:
+    // Per-output-channel gains moving linearly to target over framesLeft.
+    struct GainRamp {
+        float current[2] = {0.0f, 0.0f};
+        float target[2] = {0.0f, 0.0f};
+        uint32_t framesLeft = 0;
+    };
+
+    struct Input {
+        uint64_t id = 0;
+        bool isClip = false;
+        uint32_t numChannels = 0;
+
+        // Clip samples; immutable once added.
+        std::vector<int16_t> clip;
+        std::size_t clipFrames = 0;
+        bool loop = true;
+
+        // Stream ring of capacityFrames frames. write() is the only producer
+        // and the render thread the only consumer; the counters are totals.
+        std::vector<int16_t> ring;
+        std::size_t capacityFrames = 0;
+        std::atomic<uint64_t> framesWritten{0};
+        std::atomic<uint64_t> framesRead{0};
+        std::atomic<uint64_t> underruns{0};
+
+        // Parameters, guarded by mutex_.
+        double gain = 1.0;
+        double pan = 0.0;
+        uint32_t rampFrames = 0;
+        bool changed = true;
+        bool removing = false;
+
+        // Render thread state.
+        GainRamp ramp;
+        bool mixed = false;
+        bool launched = false;
+        double launchTime = 0.0;
+    };
+
+    Napi::Value AddClip(const Napi::CallbackInfo& info);
+    Napi::Value AddStream(const Napi::CallbackInfo& info);
+    Napi::Value Write(const Napi::CallbackInfo& info);
+    Napi::Value SetGain(const Napi::CallbackInfo& info);
+    Napi::Value SetPan(const Napi::CallbackInfo& info);
+    Napi::Value RemoveInput(const Napi::CallbackInfo& info);
+    void Start(const Napi::CallbackInfo& info);
+    void Stop(const Napi::CallbackInfo& info);
+    Napi::Value Status(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    // Reads { gain, pan } from an options object into a new input.
+    bool ReadInputOptions(const Napi::CallbackInfo& info, std::size_t index, Input& input);
+    Napi::Value AddInput(Napi::Env env, std::shared_ptr<Input> input);
+    std::shared_ptr<Input> FindInput(uint64_t id);
+    bool SetParameter(const Napi::CallbackInfo& info, bool pan);
+
+    void Run();
+    void RenderBuffer();
+    void TakeInputs();
+    void MixClip(Input& input, double beginMicros, std::size_t numFrames);
+    void MixStream(Input& input, std::size_t numFrames);
+    void MixSegment(Input& input, const int16_t* src, std::size_t offset, std::size_t frames);
+    // Advances a ramp over frames the input did not contribute to.
+    static void SkipRamp(GainRamp& ramp, std::size_t frames);
+    void StopThread();
+    void CloseInternal();
+
+    ableton::LinkAudio* link_ = nullptr;
+    std::shared_ptr<ableton::LinkAudioSink> sink_;
+    std::shared_ptr<SinkStats> sinkStats_;
+    std::unique_ptr<LinkTimeline> timeline_;
+    uint32_t numChannels_ = 2;
+    uint32_t sampleRate_ = 48000;
+    double quantum_ = 4.0;
+    std::size_t framesPerBuffer_ = 512;
+    std::chrono::microseconds lead_{20000};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<std::shared_ptr<Input>> inputs_;
+    uint64_t nextInputId_ = 1;
+    bool running_ = false;
+    std::thread thread_;
+
+    // Render thread state. active_ is the input list taken under mutex_ at
+    // the start of each buffer; mixing itself runs without the lock.
+    std::unique_ptr<ableton::LinkAudio::SessionState> state_;
+    std::vector<std::shared_ptr<Input>> active_;
+    std::vector<float> mix_;
+    std::vector<float> scratch_;
+    double bufferTime_ = 0.0;
+    std::atomic<uint64_t> framesCommitted_{0};
+    std::atomic<uint64_t> buffersDropped_{0};
+    std::atomic<uint64_t> clippedSamples_{0};
+
+    Napi::ObjectReference linkRef_;
+    Napi::ObjectReference sinkRef_;
+    LinkDependents* dependents_ = nullptr;
+    uint64_t dependentId_ = 0;
+};
+
+Napi::Object InitAbletonLinkMixBus(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_MIXBUS_H
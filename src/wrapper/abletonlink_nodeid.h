@@ -0,0 +1,42 @@
+#ifndef ABLETONLINK_NODEID_H
+#define ABLETONLINK_NODEID_H
+
+#include <ableton/LinkAudio.hpp>
+#include <cctype>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Conversions between Link node/channel IDs and the hex strings used in JS.
+inline std::string NodeIdToHexString(const ableton::link::NodeId& id) {
+    std::ostringstream stream;
+    stream << id;
+    return stream.str();
+}
+
+inline bool ParseNodeIdString(const std::string& input, ableton::link::NodeId& out) {
+    std::string hex = input;
+    if (hex.rfind("0x", 0) == 0 || hex.rfind("0X", 0) == 0) {
+        hex = hex.substr(2);
+    }
+    if (hex.size() != 16) {
+        return false;
+    }
+
+    ableton::link::NodeIdArray bytes{};
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        const auto hi = hex[2 * i];
+        const auto lo = hex[2 * i + 1];
+        if (!std::isxdigit(static_cast<unsigned char>(hi)) ||
+            !std::isxdigit(static_cast<unsigned char>(lo))) {
+            return false;
+        }
+        const auto byte = std::stoul(hex.substr(2 * i, 2), nullptr, 16);
+        bytes[i] = static_cast<std::uint8_t>(byte);
+    }
+
+    out = ableton::link::NodeId(bytes);
+    return true;
+}
+
+#endif // ABLETONLINK_NODEID_H
@@ -0,0 +1,261 @@
+#include "abletonlink_publisher.h"
+#include "abletonlink_addon.h"
+#include "abletonlink.h"
+#include "abletonlink_audio.h"
+#include "abletonlink_trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <abletonlink_shm.h>
+#include <sys/stat.h>
+
+static_assert(sizeof(lkshm_state) == 128, "lkshm_state layout changed");
+static_assert(offsetof(lkshm_state, sequence) == 16, "lkshm_state layout changed");
+static_assert(offsetof(lkshm_state, snapshot) == 24, "lkshm_state layout changed");
+static_assert(offsetof(lkshm_snapshot, active) == 56, "lkshm_snapshot layout changed");
+
+namespace {
+// A segment left by an earlier publisher may be taken over once it closed,
+// died mid-write or stopped updating for staleAfter.
+bool Reusable(const lkshm_state* state, std::chrono::microseconds staleAfter) {
+    if (state->magic != LKSHM_MAGIC || state->version != LKSHM_VERSION ||
+        state->size != sizeof(lkshm_state)) {
+        return false;
+    }
+    lkshm_snapshot snapshot{};
+    return lkshm_read(state, &snapshot) != LKSHM_OK ||
+           lkshm_age_us(&snapshot) >= staleAfter.count();
+}
+
+// Maps the segment read-write, creating it exclusively unless a reusable one
+// exists. Returns MAP_FAILED with errno set, EEXIST if the name is taken.
+void* MapSegment(const std::string& name, std::chrono::microseconds staleAfter) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    const bool created = fd >= 0;
+    if (!created && errno == EEXIST) {
+        fd = shm_open(name.c_str(), O_RDWR, 0);
+    }
+    if (fd < 0) {
+        return MAP_FAILED;
+    }
+    void* map = MAP_FAILED;
+    struct stat st {};
+    if (created) {
+        if (ftruncate(fd, sizeof(lkshm_state)) == 0) {
+            map = mmap(nullptr, sizeof(lkshm_state), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+    } else if (fstat(fd, &st) == 0) {
+        errno = EEXIST;
+        if (st.st_size == static_cast<off_t>(sizeof(lkshm_state))) {
+            map = mmap(nullptr, sizeof(lkshm_state), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (map != MAP_FAILED && !Reusable(static_cast<const lkshm_state*>(map), staleAfter)) {
+                munmap(map, sizeof(lkshm_state));
+                map = MAP_FAILED;
+                errno = EEXIST;
+            }
+        }
+    }
+    const int error = errno;
+    close(fd);
+    errno = error;
+    return map;
+}
+} // namespace
+#endif
+
+Napi::Object AbletonLinkStatePublisherWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "AbletonLinkStatePublisher", {
+        InstanceMethod("status", &AbletonLinkStatePublisherWrapper::Status),
+        InstanceMethod("close", &AbletonLinkStatePublisherWrapper::Close),
+    });
+
+    AddonData(env).statePublisher = Napi::Persistent(func);
+    exports.Set("AbletonLinkStatePublisher", func);
+    return exports;
+}
+
+AbletonLinkStatePublisherWrapper::AbletonLinkStatePublisherWrapper(
+    const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<AbletonLinkStatePublisherWrapper>(info) {
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsString()) {
+        Napi::TypeError::New(info.Env(), "Link instance and segment name (string) expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    name_ = info[1].As<Napi::String>().Utf8Value();
+    if (name_.empty() || name_[0] != '/') {
+        name_.insert(0, "/");
+    }
+    if (name_.size() < 2 || name_.size() > 255 || name_.find('/', 1) != std::string::npos) {
+        Napi::TypeError::New(info.Env(), "Segment name must be a single path component")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (info.Length() > 2 && info[2].IsObject()) {
+        auto options = info[2].As<Napi::Object>();
+        if (options.Get("quantum").IsNumber()) {
+            quantum_ = options.Get("quantum").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("intervalMs").IsNumber()) {
+            const auto intervalMs = options.Get("intervalMs").As<Napi::Number>().DoubleValue();
+            interval_ = std::chrono::microseconds(
+                static_cast<long long>(std::max(0.1, intervalMs) * 1000.0));
+        }
+    }
+    if (!(quantum_ > 0.0)) {
+        Napi::TypeError::New(info.Env(), "quantum must be positive").ThrowAsJavaScriptException();
+        return;
+    }
+
+#if defined(_WIN32)
+    Napi::Error::New(info.Env(), "Shared-memory publication requires POSIX shared memory")
+        .ThrowAsJavaScriptException();
+    return;
+#else
+    auto linkObject = info[0].As<Napi::Object>();
+    if (AbletonLinkAudioWrapper::IsInstance(linkObject)) {
+        auto* link = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(linkObject);
+        timeline_ = link->CreateTimeline();
+        dependents_ = &link->Dependents();
+    } else if (AbletonLinkWrapper::IsInstance(linkObject)) {
+        auto* link = Napi::ObjectWrap<AbletonLinkWrapper>::Unwrap(linkObject);
+        timeline_ = link->CreateTimeline();
+        dependents_ = &link->Dependents();
+    }
+    if (!timeline_) {
+        dependents_ = nullptr;
+        Napi::TypeError::New(info.Env(), "Open AbletonLink or AbletonLinkAudio expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    void* map = MapSegment(name_, std::max(std::chrono::microseconds(1000000), interval_ * 10));
+    if (map == MAP_FAILED) {
+        const std::string error = errno == EEXIST ? "in use by another publisher"
+                                                  : std::strerror(errno);
+        timeline_.reset();
+        dependents_ = nullptr;
+        Napi::Error::New(info.Env(), "Could not open shared memory " + name_ + ": " + error)
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    state_ = static_cast<lkshm_state*>(map);
+    state_->magic = LKSHM_MAGIC;
+    state_->version = LKSHM_VERSION;
+    state_->size = sizeof(lkshm_state);
+    // A publisher that died mid-write leaves the sequence odd.
+    const auto sequence = __atomic_load_n(&state_->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&state_->sequence, (sequence + 1) & ~uint64_t{1}, __ATOMIC_RELEASE);
+    Publish(true);
+
+    linkRef_ = Napi::Persistent(linkObject);
+    linkRef_.SuppressDestruct();
+
+    dependentId_ = dependents_->Add([this]() {
+        dependents_ = nullptr;
+        CloseInternal();
+    });
+
+    running_ = true;
+    thread_ = std::thread([this]() { Run(); });
+#endif
+}
+
+AbletonLinkStatePublisherWrapper::~AbletonLinkStatePublisherWrapper() {
+    CloseInternal();
+}
+
+Napi::Value AbletonLinkStatePublisherWrapper::Status(const Napi::CallbackInfo& info) {
+    auto result = Napi::Object::New(info.Env());
+    result.Set("name", name_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.Set("active", running_);
+    uint64_t sequence = 0;
+#if !defined(_WIN32)
+    if (state_) {
+        sequence = __atomic_load_n(&state_->sequence, __ATOMIC_RELAXED);
+    }
+#endif
+    result.Set("sequence", static_cast<double>(sequence));
+    return result;
+}
+
+void AbletonLinkStatePublisherWrapper::Close(const Napi::CallbackInfo& info) {
+    CloseInternal();
+}
+
+void AbletonLinkStatePublisherWrapper::Run() {
+    TraceThreadName("state-publisher");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        wake_.wait_for(lock, interval_);
+        if (!running_) {
+            break;
+        }
+        Publish(true);
+    }
+}
+
+void AbletonLinkStatePublisherWrapper::Publish(bool active) {
+#if !defined(_WIN32)
+    // Single writer: the constructor, then the publisher thread, then close.
+    lkshm_snapshot snapshot{};
+    timeline_->Capture();
+    const auto now = timeline_->Now();
+    snapshot.clock_offset_us = now.count() - lkshm_clock_us();
+    snapshot.time_us = now.count();
+    snapshot.tempo = timeline_->Tempo();
+    snapshot.beat = timeline_->BeatAtTime(now, quantum_);
+    snapshot.quantum = quantum_;
+    snapshot.time_for_is_playing_us = timeline_->TimeForIsPlaying().count();
+    snapshot.is_playing = timeline_->IsPlaying() ? 1 : 0;
+    snapshot.num_peers = static_cast<uint32_t>(timeline_->NumPeers());
+    snapshot.active = active ? 1 : 0;
+
+    const auto sequence = __atomic_load_n(&state_->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&state_->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    std::memcpy(&state_->snapshot, &snapshot, sizeof(snapshot));
+    __atomic_store_n(&state_->sequence, sequence + 2, __ATOMIC_RELEASE);
+#endif
+}
+
+void AbletonLinkStatePublisherWrapper::CloseInternal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+#if !defined(_WIN32)
+    if (state_) {
+        // Readers that keep the mapping see the segment go inactive.
+        Publish(false);
+        munmap(state_, sizeof(lkshm_state));
+        shm_unlink(name_.c_str());
+        state_ = nullptr;
+    }
+#endif
+    if (dependents_) {
+        dependents_->Remove(dependentId_);
+        dependents_ = nullptr;
+    }
+    timeline_.reset();
+    linkRef_.Reset();
+}
+
+Napi::Object InitAbletonLinkStatePublisher(Napi::Env env, Napi::Object exports) {
+    AbletonLinkStatePublisherWrapper::Init(env, exports);
+    return exports;
+}
@@ -0,0 +1,51 @@
+#ifndef ABLETONLINK_PUBLISHER_H
+#define ABLETONLINK_PUBLISHER_H
+
+#include "abletonlink_timeline.h"
+#include <napi.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct lkshm_state;
+
+// Publishes the Link timeline and transport state into a POSIX shared-memory
+// segment so other local processes can follow the beat clock without joining
+// the session. The layout and a header-only C reader are in
+// include/abletonlink_shm.h.
+class AbletonLinkStatePublisherWrapper
+    : public Napi::ObjectWrap<AbletonLinkStatePublisherWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    AbletonLinkStatePublisherWrapper(const Napi::CallbackInfo& info);
+    ~AbletonLinkStatePublisherWrapper();
+
+private:
+    Napi::Value Status(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void Run();
+    void Publish(bool active);
+    void CloseInternal();
+
+    std::unique_ptr<LinkTimeline> timeline_;
+    std::string name_;
+    double quantum_ = 4.0;
+    std::chrono::microseconds interval_{2000};
+    lkshm_state* state_ = nullptr;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+    std::thread thread_;
+
+    Napi::ObjectReference linkRef_;
+    LinkDependents* dependents_ = nullptr;
+    uint64_t dependentId_ = 0;
+};
+
+Napi::Object InitAbletonLinkStatePublisher(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_PUBLISHER_H
@@ -0,0 +1,408 @@
+#include "abletonlink_scheduler.h"
+#include "abletonlink_addon.h"
+#include "abletonlink.h"
+#include "abletonlink_audio.h"
+#include "abletonlink_thread_policy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+std::chrono::microseconds SecondsToMicros(double seconds) {
+    return std::chrono::microseconds(static_cast<long long>(seconds * 1000000.0));
+}
+
+// Upper bound on how long the thread sleeps without re-reading the session
+// timeline while beat-domain events are pending.
+constexpr std::chrono::microseconds kBeatRecheckInterval{5000};
+} // namespace
+
+Napi::Object AbletonLinkSchedulerWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "AbletonLinkScheduler", {
+        InstanceMethod("now", &AbletonLinkSchedulerWrapper::Now),
+        InstanceMethod("scheduleAt", &AbletonLinkSchedulerWrapper::ScheduleAt),
+        InstanceMethod("scheduleAtBeat", &AbletonLinkSchedulerWrapper::ScheduleAtBeat),
+        InstanceMethod("scheduleEveryBeats",
+                       &AbletonLinkSchedulerWrapper::ScheduleEveryBeats),
+        InstanceMethod("cancel", &AbletonLinkSchedulerWrapper::Cancel),
+        InstanceMethod("start", &AbletonLinkSchedulerWrapper::Start),
+        InstanceMethod("stop", &AbletonLinkSchedulerWrapper::Stop),
+        InstanceMethod("close", &AbletonLinkSchedulerWrapper::Close),
+    });
+
+    AddonData(env).scheduler = Napi::Persistent(func);
+    exports.Set("AbletonLinkScheduler", func);
+    return exports;
+}
+
+AbletonLinkSchedulerWrapper::AbletonLinkSchedulerWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<AbletonLinkSchedulerWrapper>(info) {
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+        Napi::TypeError::New(info.Env(),
+                             "Link instance and dispatch callback (function) expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto linkObject = info[0].As<Napi::Object>();
+    if (AbletonLinkAudioWrapper::IsInstance(linkObject)) {
+        auto* link = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(linkObject);
+        timeline_ = link->CreateTimeline();
+        dependents_ = &link->Dependents();
+    } else if (AbletonLinkWrapper::IsInstance(linkObject)) {
+        auto* link = Napi::ObjectWrap<AbletonLinkWrapper>::Unwrap(linkObject);
+        timeline_ = link->CreateTimeline();
+        dependents_ = &link->Dependents();
+    }
+    if (!timeline_) {
+        dependents_ = nullptr;
+        Napi::TypeError::New(info.Env(), "Open AbletonLink or AbletonLinkAudio expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (info.Length() > 2 && info[2].IsObject()) {
+        auto options = info[2].As<Napi::Object>();
+        if (options.Get("coarseMs").IsNumber()) {
+            const auto coarseMs = options.Get("coarseMs").As<Napi::Number>().DoubleValue();
+            coarse_ = std::chrono::microseconds(
+                static_cast<long long>(std::max(0.0, coarseMs) * 1000.0));
+        }
+    }
+
+    dispatch_ = Napi::ThreadSafeFunction::New(
+        info.Env(), info[1].As<Napi::Function>(), "LinkSchedulerDispatch", 0, 1);
+    dispatch_.Unref(info.Env());
+
+    linkRef_ = Napi::Persistent(linkObject);
+    linkRef_.SuppressDestruct();
+
+    // The Link instance closes its dependents before it is destroyed.
+    dependentId_ = dependents_->Add([this]() {
+        dependents_ = nullptr;
+        CloseInternal();
+    });
+}
+
+AbletonLinkSchedulerWrapper::~AbletonLinkSchedulerWrapper() {
+    CloseInternal();
+}
+
+Napi::Value AbletonLinkSchedulerWrapper::Now(const Napi::CallbackInfo& info) {
+    if (!timeline_) {
+        return info.Env().Null();
+    }
+    return Napi::Number::New(info.Env(), timeline_->Now().count() / 1000000.0);
+}
+
+Napi::Value AbletonLinkSchedulerWrapper::ScheduleAt(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Time (number) expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "Scheduler is closed").ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+
+    Event event{};
+    event.time = SecondsToMicros(info[0].As<Napi::Number>().DoubleValue());
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        event.period = SecondsToMicros(
+            std::max(0.0, info[1].As<Napi::Number>().DoubleValue()));
+    }
+    return PushNew(info, event);
+}
+
+Napi::Value AbletonLinkSchedulerWrapper::ScheduleAtBeat(const Napi::CallbackInfo& info) {
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Beat (number) and quantum (number) expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "Scheduler is closed").ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+
+    Event event{};
+    event.beatDomain = true;
+    event.beat = info[0].As<Napi::Number>().DoubleValue();
+    event.quantum = info[1].As<Napi::Number>().DoubleValue();
+    if (info.Length() > 2 && info[2].IsNumber()) {
+        event.periodBeats = std::max(0.0, info[2].As<Napi::Number>().DoubleValue());
+    }
+    return PushNew(info, event);
+}
+
+Napi::Value AbletonLinkSchedulerWrapper::ScheduleEveryBeats(
+    const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsNumber() ||
+        info[0].As<Napi::Number>().DoubleValue() <= 0.0) {
+        Napi::TypeError::New(info.Env(), "Period in beats (positive number) expected")
+            .ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "Scheduler is closed").ThrowAsJavaScriptException();
+        return info.Env().Null();
+    }
+
+    Event event{};
+    event.beatDomain = true;
+    event.periodBeats = info[0].As<Napi::Number>().DoubleValue();
+    event.quantum = info.Length() > 1 && info[1].IsNumber()
+                        ? info[1].As<Napi::Number>().DoubleValue()
+                        : event.periodBeats;
+    // Resolved to the next multiple of the period on the scheduler thread.
+    event.beat = std::numeric_limits<double>::quiet_NaN();
+    return PushNew(info, event);
+}
+
+Napi::Value AbletonLinkSchedulerWrapper::PushNew(const Napi::CallbackInfo& info,
+                                                  Event event) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        event.id = nextId_++;
+    }
+    Push(event);
+    return Napi::Number::New(info.Env(), static_cast<double>(event.id));
+}
+
+void AbletonLinkSchedulerWrapper::Cancel(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Event id (number) expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    const auto id = static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (live_.erase(id) > 0) {
+        cancelled_.insert(id);
+    }
+}
+
+void AbletonLinkSchedulerWrapper::Start(const Napi::CallbackInfo& info) {
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "Scheduler is closed").ThrowAsJavaScriptException();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return;
+        }
+        running_ = true;
+    }
+    thread_ = std::thread([this]() { Run(); });
+    // Like a pending setTimeout, a running scheduler keeps the process alive.
+    dispatch_.Ref(info.Env());
+}
+
+void AbletonLinkSchedulerWrapper::Stop(const Napi::CallbackInfo& info) {
+    StopThread();
+}
+
+void AbletonLinkSchedulerWrapper::Close(const Napi::CallbackInfo& info) {
+    CloseInternal();
+}
+
+void AbletonLinkSchedulerWrapper::Push(const Event& event) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (event.beatDomain) {
+            // The deadline is unknown until the thread re-reads the timeline.
+            ++beatEvents_;
+            beatsDirty_ = true;
+            wake = true;
+        }
+        heap_.push_back(event);
+        std::push_heap(heap_.begin(), heap_.end(), EventLater{});
+        live_.insert(event.id);
+        wake = wake || heap_.front().id == event.id;
+    }
+    if (wake) {
+        wake_.notify_one();
+    }
+}
+
+void AbletonLinkSchedulerWrapper::Run() {
+    ThreadPolicyScope policy("scheduler");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        while (!heap_.empty() && cancelled_.count(heap_.front().id) > 0) {
+            cancelled_.erase(heap_.front().id);
+            if (heap_.front().beatDomain) {
+                --beatEvents_;
+            }
+            std::pop_heap(heap_.begin(), heap_.end(), EventLater{});
+            heap_.pop_back();
+        }
+        if (heap_.empty()) {
+            wake_.wait(lock);
+            continue;
+        }
+        if (beatEvents_ > 0) {
+            RefreshBeatDeadlines();
+        }
+
+        const auto next = heap_.front().time;
+        const auto remaining = next - timeline_->Now();
+        if (remaining > coarse_) {
+            // Interruptible wait so earlier events and stop() are noticed. With
+            // beat events pending, wake periodically to follow tempo changes.
+            auto wait = remaining - coarse_;
+            if (beatEvents_ > 0) {
+                wait = std::min(wait, kBeatRecheckInterval);
+            }
+            wake_.wait_for(lock, wait);
+            continue;
+        }
+        if (remaining.count() > 0) {
+            lock.unlock();
+            SleepUntilLinkTime(*timeline_, next);
+            lock.lock();
+            continue;
+        }
+
+        CollectDue(timeline_->Now());
+    }
+}
+
+void AbletonLinkSchedulerWrapper::RefreshBeatDeadlines() {
+    // Called with mutex_ held on the scheduler thread.
+    timeline_->Capture();
+    const auto tempo = timeline_->Tempo();
+    const auto origin = timeline_->TimeAtBeat(0.0, 1.0);
+    if (!beatsDirty_ && tempo == lastTempo_ && origin == lastOrigin_) {
+        return;
+    }
+    lastTempo_ = tempo;
+    lastOrigin_ = origin;
+    beatsDirty_ = false;
+
+    const auto now = timeline_->Now();
+    for (auto& event : heap_) {
+        if (!event.beatDomain) {
+            continue;
+        }
+        if (std::isnan(event.beat)) {
+            const auto beat = timeline_->BeatAtTime(now, event.quantum);
+            event.beat = std::ceil(beat / event.periodBeats) * event.periodBeats;
+        }
+        event.time = timeline_->TimeAtBeat(event.beat, event.quantum);
+    }
+    std::make_heap(heap_.begin(), heap_.end(), EventLater{});
+}
+
+void AbletonLinkSchedulerWrapper::CollectDue(std::chrono::microseconds now) {
+    // Called with mutex_ held.
+    while (!heap_.empty() && heap_.front().time <= now) {
+        std::pop_heap(heap_.begin(), heap_.end(), EventLater{});
+        auto event = heap_.back();
+        heap_.pop_back();
+        if (cancelled_.erase(event.id) > 0) {
+            if (event.beatDomain) {
+                --beatEvents_;
+            }
+            continue;
+        }
+
+        // Batch layout per event: id, time (seconds), beat (NaN for time events).
+        pending_.push_back(static_cast<double>(event.id));
+        pending_.push_back(event.time.count() / 1000000.0);
+        pending_.push_back(event.beatDomain ? event.beat
+                                            : std::numeric_limits<double>::quiet_NaN());
+
+        if (event.beatDomain && event.periodBeats > 0.0) {
+            event.beat += event.periodBeats;
+            event.time = timeline_->TimeAtBeat(event.beat, event.quantum);
+            heap_.push_back(event);
+            std::push_heap(heap_.begin(), heap_.end(), EventLater{});
+        } else if (!event.beatDomain && event.period.count() > 0) {
+            event.time += event.period;
+            heap_.push_back(event);
+            std::push_heap(heap_.begin(), heap_.end(), EventLater{});
+        } else {
+            if (event.beatDomain) {
+                --beatEvents_;
+            }
+            live_.erase(event.id);
+        }
+    }
+
+    if (pending_.empty() || dispatchPending_) {
+        return;
+    }
+    dispatchPending_ = true;
+    const auto status = dispatch_.NonBlockingCall(
+        [this](Napi::Env env, Napi::Function callback) { Dispatch(env, callback); });
+    if (status != napi_ok) {
+        dispatchPending_ = false;
+    }
+}
+
+void AbletonLinkSchedulerWrapper::Dispatch(Napi::Env env, Napi::Function callback) {
+    std::vector<double> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.swap(pending_);
+        dispatchPending_ = false;
+    }
+    if (batch.empty()) {
+        return;
+    }
+    auto events = Napi::Float64Array::New(env, batch.size());
+    std::memcpy(events.Data(), batch.data(), batch.size() * sizeof(double));
+    callback.Call({events});
+}
+
+void AbletonLinkSchedulerWrapper::StopThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    heap_.clear();
+    live_.clear();
+    cancelled_.clear();
+    pending_.clear();
+    beatEvents_ = 0;
+    if (dispatch_) {
+        dispatch_.Unref(Env());
+    }
+}
+
+void AbletonLinkSchedulerWrapper::CloseInternal() {
+    StopThread();
+    if (dispatch_) {
+        dispatch_.Abort();
+        dispatch_.Release();
+        dispatch_ = Napi::ThreadSafeFunction();
+    }
+    if (dependents_) {
+        dependents_->Remove(dependentId_);
+        dependents_ = nullptr;
+    }
+    timeline_.reset();
+    linkRef_.Reset();
+}
+
+Napi::Object InitAbletonLinkScheduler(Napi::Env env, Napi::Object exports) {
+    AbletonLinkSchedulerWrapper::Init(env, exports);
+    return exports;
+}
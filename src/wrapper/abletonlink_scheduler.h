@@ -0,0 +1,88 @@
+#ifndef ABLETONLINK_SCHEDULER_H
+#define ABLETONLINK_SCHEDULER_H
+
+#include "abletonlink_timeline.h"
+#include <napi.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Link-clock event scheduler backed by a dedicated thread. Events live in a
+// binary heap; due events are collected into a pending batch that is handed
+// to JS through a single ThreadSafeFunction call.
+//
+// Beat-domain events are keyed by (beat, quantum). Their deadlines are
+// re-derived from the session timeline whenever the thread notices a tempo or
+// timeline change, so JS never has to cancel and reschedule them.
+class AbletonLinkSchedulerWrapper : public Napi::ObjectWrap<AbletonLinkSchedulerWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    AbletonLinkSchedulerWrapper(const Napi::CallbackInfo& info);
+    ~AbletonLinkSchedulerWrapper();
+
+private:
+    struct Event {
+        std::chrono::microseconds time{0};
+        uint64_t id = 0;
+        std::chrono::microseconds period{0};
+        bool beatDomain = false;
+        double beat = 0.0;
+        double quantum = 1.0;
+        double periodBeats = 0.0;
+    };
+
+    struct EventLater {
+        bool operator()(const Event& a, const Event& b) const {
+            return a.time > b.time;
+        }
+    };
+
+    Napi::Value Now(const Napi::CallbackInfo& info);
+    Napi::Value ScheduleAt(const Napi::CallbackInfo& info);
+    Napi::Value ScheduleAtBeat(const Napi::CallbackInfo& info);
+    Napi::Value ScheduleEveryBeats(const Napi::CallbackInfo& info);
+    void Cancel(const Napi::CallbackInfo& info);
+    void Start(const Napi::CallbackInfo& info);
+    void Stop(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    Napi::Value PushNew(const Napi::CallbackInfo& info, Event event);
+    void Push(const Event& event);
+    void Run();
+    void RefreshBeatDeadlines();
+    void CollectDue(std::chrono::microseconds now);
+    void Dispatch(Napi::Env env, Napi::Function callback);
+    void StopThread();
+    void CloseInternal();
+
+    std::unique_ptr<LinkTimeline> timeline_;
+    std::chrono::microseconds coarse_{2000};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<Event> heap_;
+    std::unordered_set<uint64_t> live_;
+    std::unordered_set<uint64_t> cancelled_;
+    uint64_t nextId_ = 1;
+    std::size_t beatEvents_ = 0;
+    bool beatsDirty_ = false;
+    double lastTempo_ = 0.0;
+    std::chrono::microseconds lastOrigin_{0};
+    bool running_ = false;
+    bool dispatchPending_ = false;
+    std::vector<double> pending_;
+
+    std::thread thread_;
+    Napi::ThreadSafeFunction dispatch_;
+    Napi::ObjectReference linkRef_;
+    LinkDependents* dependents_ = nullptr;
+    uint64_t dependentId_ = 0;
+};
+
+Napi::Object InitAbletonLinkScheduler(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_SCHEDULER_H
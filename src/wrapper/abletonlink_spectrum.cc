@@ -0,0 +1,397 @@
+#include "abletonlink_spectrum.h"
+#include "abletonlink_addon.h"
+#include "abletonlink_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr std::size_t kMinFftSize = 64;
+constexpr std::size_t kMaxFftSize = 32768;
+constexpr std::size_t kMaxBands = 1024;
+// Power floor for decibel output, -120 dB.
+constexpr float kPowerFloor = 1e-12f;
+constexpr uint32_t kDefaultSampleRate = 48000;
+
+bool ParseWindow(const std::string& name, LogBandSpectrum::Window& window) {
+    if (name == "hann") {
+        window = LogBandSpectrum::Window::Hann;
+    } else if (name == "hamming") {
+        window = LogBandSpectrum::Window::Hamming;
+    } else if (name == "blackman") {
+        window = LogBandSpectrum::Window::Blackman;
+    } else if (name == "rectangular") {
+        window = LogBandSpectrum::Window::Rectangular;
+    } else {
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+void LogBandSpectrum::Configure(const Config& config, uint32_t sampleRate) {
+    config_ = config;
+    sampleRate_ = sampleRate;
+    const auto size = config.fftSize;
+    const auto half = size / 2;
+    hop_ = std::max<std::size_t>(1, std::lround(size * (1.0 - config.overlap)));
+    maxHz_ = std::min(config.maxHz, sampleRate / 2.0);
+    minHz_ = std::min(config.minHz, maxHz_ / 2.0);
+
+    input_.assign(size, 0.0f);
+    inputPosition_ = 0;
+    untilFrame_ = size;
+
+    window_.resize(size);
+    double windowPower = 0.0;
+    for (std::size_t n = 0; n < size; ++n) {
+        const double x = 2.0 * kPi * n / size;
+        double w = 1.0;
+        switch (config.window) {
+        case Window::Hann:
+            w = 0.5 - 0.5 * std::cos(x);
+            break;
+        case Window::Hamming:
+            w = 0.54 - 0.46 * std::cos(x);
+            break;
+        case Window::Blackman:
+            w = 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2.0 * x);
+            break;
+        case Window::Rectangular:
+            break;
+        }
+        window_[n] = static_cast<float>(w);
+        windowPower += w * w;
+    }
+    // Normalized by the window's noise bandwidth: the bins a full-scale sine
+    // leaks into sum to power 1 with every window.
+    gain_ = static_cast<float>(2.0 / std::sqrt(size * windowPower));
+
+    buffer_.resize(half);
+    twiddles_.resize(half / 2);
+    for (std::size_t k = 0; k < half / 2; ++k) {
+        twiddles_[k] = std::polar(1.0f, static_cast<float>(-2.0 * kPi * k / half));
+    }
+    realTwiddles_.resize(half + 1);
+    for (std::size_t k = 0; k <= half; ++k) {
+        realTwiddles_[k] = std::polar(1.0f, static_cast<float>(-2.0 * kPi * k / size));
+    }
+    uint32_t bits = 0;
+    while ((std::size_t{1} << bits) < half) {
+        ++bits;
+    }
+    bitReverse_.resize(half);
+    for (uint32_t k = 0; k < half; ++k) {
+        uint32_t reversed = 0;
+        for (uint32_t bit = 0; bit < bits; ++bit) {
+            reversed |= ((k >> bit) & 1u) << (bits - 1 - bit);
+        }
+        bitReverse_[k] = reversed;
+    }
+
+    // A band's power is the total of its bins, so a sine reads the same in
+    // any band width. Bands narrower than a bin take the bin nearest their
+    // centre.
+    const auto edges = BandEdges();
+    const double binHz = static_cast<double>(sampleRate) / size;
+    bandStart_.resize(config.numBands);
+    bandEnd_.resize(config.numBands);
+    for (std::size_t b = 0; b < config.numBands; ++b) {
+        auto start = static_cast<std::size_t>(std::ceil(edges[b] / binHz));
+        auto end = static_cast<std::size_t>(std::ceil(edges[b + 1] / binHz));
+        start = std::min(start, half);
+        end = std::min(end, half + 1);
+        if (end <= start) {
+            const auto centre = std::sqrt(static_cast<double>(edges[b]) * edges[b + 1]);
+            start = std::min<std::size_t>(half, std::lround(centre / binHz));
+            end = start + 1;
+        }
+        bandStart_[b] = static_cast<uint32_t>(start);
+        bandEnd_[b] = static_cast<uint32_t>(end);
+    }
+    power_.assign(half + 1, 0.0f);
+    sum_.assign(config.numBands, 0.0);
+    summed_ = 0;
+    frames_ = 0;
+}
+
+std::vector<float> LogBandSpectrum::BandEdges() const {
+    std::vector<float> edges(config_.numBands + 1);
+    const double ratio = maxHz_ / minHz_;
+    for (std::size_t b = 0; b <= config_.numBands; ++b) {
+        edges[b] = static_cast<float>(
+            minHz_ * std::pow(ratio, static_cast<double>(b) / config_.numBands));
+    }
+    return edges;
+}
+
+void LogBandSpectrum::Process(const int16_t* samples, std::size_t numFrames,
+                              std::size_t numChannels) {
+    const float scale = 1.0f / (32768.0f * static_cast<float>(numChannels));
+    const auto mask = input_.size() - 1;
+    for (std::size_t frame = 0; frame < numFrames; ++frame) {
+        float x = 0.0f;
+        for (std::size_t c = 0; c < numChannels; ++c) {
+            x += samples[frame * numChannels + c];
+        }
+        input_[inputPosition_] = x * scale;
+        inputPosition_ = (inputPosition_ + 1) & mask;
+        if (--untilFrame_ == 0) {
+            Transform();
+            untilFrame_ = hop_;
+        }
+    }
+}
+
+void LogBandSpectrum::Transform() {
+    const auto size = input_.size();
+    const auto half = size / 2;
+    const auto mask = size - 1;
+
+    // Pack even and odd samples as real and imaginary parts, oldest first
+    // (the oldest sample is at inputPosition_), in bit-reversed order.
+    for (std::size_t k = 0; k < half; ++k) {
+        const auto n = 2 * k;
+        buffer_[bitReverse_[k]] = {input_[(inputPosition_ + n) & mask] * window_[n],
+                                   input_[(inputPosition_ + n + 1) & mask] * window_[n + 1]};
+    }
+    for (std::size_t length = 2; length <= half; length <<= 1) {
+        const auto step = half / length;
+        for (std::size_t start = 0; start < half; start += length) {
+            for (std::size_t j = 0; j < length / 2; ++j) {
+                const auto t = twiddles_[j * step] * buffer_[start + j + length / 2];
+                const auto u = buffer_[start + j];
+                buffer_[start + j] = u + t;
+                buffer_[start + j + length / 2] = u - t;
+            }
+        }
+    }
+
+    // Split the half-size transform into the spectra of the even and odd
+    // samples and combine them into bins 0..N/2 of the real transform.
+    const float gain2 = gain_ * gain_;
+    for (std::size_t k = 0; k <= half; ++k) {
+        const auto z = buffer_[k % half];
+        const auto mirror = std::conj(buffer_[(half - k) % half]);
+        const auto even = 0.5f * (z + mirror);
+        const auto odd = std::complex<float>(0.0f, -0.5f) * (z - mirror);
+        power_[k] = std::norm(even + realTwiddles_[k] * odd) * gain2;
+    }
+
+    for (std::size_t b = 0; b < sum_.size(); ++b) {
+        double power = 0.0;
+        for (auto bin = bandStart_[b]; bin < bandEnd_[b]; ++bin) {
+            power += power_[bin];
+        }
+        sum_[b] += power;
+    }
+    ++summed_;
+    ++frames_;
+}
+
+bool LogBandSpectrum::Take(std::vector<float>& bands) {
+    if (summed_ == 0) {
+        return false;
+    }
+    bands.resize(sum_.size());
+    for (std::size_t b = 0; b < sum_.size(); ++b) {
+        const auto power = static_cast<float>(sum_[b] / summed_);
+        bands[b] = config_.decibels ? 10.0f * std::log10(std::max(power, kPowerFloor))
+                                    : std::sqrt(power);
+        sum_[b] = 0.0;
+    }
+    summed_ = 0;
+    return true;
+}
+
+Napi::Object AbletonLinkAudioSpectrumAnalyzerWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "AbletonLinkAudioSpectrumAnalyzer", {
+        InstanceMethod("getSpectrum", &AbletonLinkAudioSpectrumAnalyzerWrapper::GetSpectrum),
+        InstanceMethod("bandFrequencies",
+                       &AbletonLinkAudioSpectrumAnalyzerWrapper::BandFrequencies),
+        InstanceMethod("status", &AbletonLinkAudioSpectrumAnalyzerWrapper::Status),
+        InstanceMethod("close", &AbletonLinkAudioSpectrumAnalyzerWrapper::Close),
+    });
+
+    AddonData(env).spectrumAnalyzer = Napi::Persistent(func);
+    exports.Set("AbletonLinkAudioSpectrumAnalyzer", func);
+    return exports;
+}
+
+AbletonLinkAudioSpectrumAnalyzerWrapper::AbletonLinkAudioSpectrumAnalyzerWrapper(
+    const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<AbletonLinkAudioSpectrumAnalyzerWrapper>(info) {
+    const bool opened = analyzer_.Open(info, "LinkSpectrumDispatch", [&]() {
+        double rateHz = 60.0;
+        if (info.Length() > 3 && info[3].IsObject()) {
+            auto options = info[3].As<Napi::Object>();
+            if (options.Get("fftSize").IsNumber()) {
+                config_.fftSize = options.Get("fftSize").As<Napi::Number>().Uint32Value();
+            }
+            if (options.Get("window").IsString()) {
+                if (!ParseWindow(options.Get("window").As<Napi::String>().Utf8Value(),
+                                 config_.window)) {
+                    Napi::TypeError::New(info.Env(),
+                                         "window must be 'hann', 'hamming', 'blackman' or "
+                                         "'rectangular'")
+                        .ThrowAsJavaScriptException();
+                    return false;
+                }
+            }
+            if (options.Get("overlap").IsNumber()) {
+                config_.overlap = options.Get("overlap").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("bands").IsNumber()) {
+                config_.numBands = options.Get("bands").As<Napi::Number>().Uint32Value();
+            }
+            if (options.Get("minHz").IsNumber()) {
+                config_.minHz = options.Get("minHz").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("maxHz").IsNumber()) {
+                config_.maxHz = options.Get("maxHz").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("rateHz").IsNumber()) {
+                rateHz = options.Get("rateHz").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("scale").IsString()) {
+                const auto scale = options.Get("scale").As<Napi::String>().Utf8Value();
+                if (scale != "db" && scale != "linear") {
+                    Napi::TypeError::New(info.Env(), "scale must be 'db' or 'linear'")
+                        .ThrowAsJavaScriptException();
+                    return false;
+                }
+                config_.decibels = scale == "db";
+            }
+        }
+        const auto size = config_.fftSize;
+        if (size < kMinFftSize || size > kMaxFftSize || (size & (size - 1)) != 0) {
+            Napi::TypeError::New(info.Env(), "fftSize must be a power of two from 64 to 32768")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        if (!(config_.overlap >= 0.0 && config_.overlap < 1.0) || config_.numBands == 0 ||
+            config_.numBands > kMaxBands || !(config_.minHz > 0.0) ||
+            !(config_.maxHz > config_.minHz) || !(rateHz > 0.0 && rateHz <= 1000.0)) {
+            Napi::TypeError::New(info.Env(),
+                                 "Expected 0 <= overlap < 1, 1 to 1024 bands, 0 < minHz < maxHz "
+                                 "and 0 < rateHz <= 1000")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        interval_ = std::chrono::microseconds(std::lround(1000000.0 / rateHz));
+        return true;
+    });
+    if (!opened) {
+        return;
+    }
+    // Reconfigured when the first buffer brings the channel's sample rate.
+    spectrum_.Configure(config_, kDefaultSampleRate);
+    analyzer_.Start([this]() { Run(); }, [this](const auto& handle) { handleBuffer(handle); });
+}
+
+AbletonLinkAudioSpectrumAnalyzerWrapper::~AbletonLinkAudioSpectrumAnalyzerWrapper() {
+    analyzer_.Close();
+}
+
+Napi::Value AbletonLinkAudioSpectrumAnalyzerWrapper::GetSpectrum(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!hasLatest_) {
+        return info.Env().Null();
+    }
+    auto bands = Napi::Float32Array::New(info.Env(), latest_.size());
+    std::memcpy(bands.Data(), latest_.data(), latest_.size() * sizeof(float));
+    return bands;
+}
+
+Napi::Value AbletonLinkAudioSpectrumAnalyzerWrapper::BandFrequencies(
+    const Napi::CallbackInfo& info) {
+    std::vector<float> edges;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        edges = spectrum_.BandEdges();
+    }
+    auto array = Napi::Float32Array::New(info.Env(), edges.size());
+    std::memcpy(array.Data(), edges.data(), edges.size() * sizeof(float));
+    return array;
+}
+
+Napi::Value AbletonLinkAudioSpectrumAnalyzerWrapper::Status(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    auto obj = Napi::Object::New(env);
+    std::lock_guard<std::mutex> lock(mutex_);
+    obj.Set("running", running_);
+    obj.Set("sampleRate", buffersAnalyzed_ > 0
+                              ? Napi::Value(Napi::Number::New(env, spectrum_.SampleRate()))
+                              : env.Null());
+    obj.Set("fftSize", static_cast<double>(config_.fftSize));
+    obj.Set("bands", static_cast<double>(config_.numBands));
+    obj.Set("buffersAnalyzed", static_cast<double>(buffersAnalyzed_));
+    obj.Set("framesAnalyzed", static_cast<double>(spectrum_.FrameCount()));
+    obj.Set("spectraDelivered", static_cast<double>(spectraDelivered_));
+    return obj;
+}
+
+void AbletonLinkAudioSpectrumAnalyzerWrapper::Close(const Napi::CallbackInfo& info) {
+    analyzer_.Close();
+}
+
+void AbletonLinkAudioSpectrumAnalyzerWrapper::handleBuffer(
+    const ableton::LinkAudioSource::BufferHandle& handle) {
+    TraceSpan span("spectrum", "analyze");
+    const auto& bufferInfo = handle.info;
+    if (bufferInfo.numFrames == 0 || bufferInfo.numChannels == 0 || bufferInfo.sampleRate == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+        return;
+    }
+    if (spectrum_.SampleRate() != bufferInfo.sampleRate) {
+        spectrum_.Configure(config_, bufferInfo.sampleRate);
+        hasLatest_ = false;
+    }
+    spectrum_.Process(handle.samples, bufferInfo.numFrames, bufferInfo.numChannels);
+    ++buffersAnalyzed_;
+}
+
+void AbletonLinkAudioSpectrumAnalyzerWrapper::Run() {
+    TraceThreadName("spectrum");
+    auto next = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        next += interval_;
+        wake_.wait_until(lock, next, [this]() { return !running_; });
+        if (!running_) {
+            return;
+        }
+        if (!spectrum_.Take(latest_)) {
+            continue;
+        }
+        hasLatest_ = true;
+        analyzer_.Post(
+            [this](Napi::Env env, Napi::Function callback) { Dispatch(env, callback); });
+    }
+}
+
+void AbletonLinkAudioSpectrumAnalyzerWrapper::Dispatch(Napi::Env env, Napi::Function callback) {
+    auto bands = Napi::Float32Array::New(env, config_.numBands);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        analyzer_.Dispatched();
+        if (!hasLatest_) {
+            return;
+        }
+        std::memcpy(bands.Data(), latest_.data(), latest_.size() * sizeof(float));
+        ++spectraDelivered_;
+    }
+    callback.Call({bands});
+}
+
+Napi::Object InitAbletonLinkSpectrum(Napi::Env env, Napi::Object exports) {
+    AbletonLinkAudioSpectrumAnalyzerWrapper::Init(env, exports);
+    return exports;
+}
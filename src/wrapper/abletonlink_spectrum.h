@@ -0,0 +1,116 @@
+#ifndef ABLETONLINK_SPECTRUM_H
+#define ABLETONLINK_SPECTRUM_H
+
+#include "abletonlink_analyzer.h"
+
+#include <napi.h>
+#include <ableton/LinkAudio.hpp>
+#include <chrono>
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Windowed, overlapping FFT of a mono downmix, reduced to log-spaced bands.
+// Band power is averaged over every FFT frame since the last Take(), so a
+// slow reader still sees all of the signal.
+class LogBandSpectrum {
+public:
+    enum class Window { Rectangular, Hann, Hamming, Blackman };
+
+    struct Config {
+        std::size_t fftSize = 2048;
+        Window window = Window::Hann;
+        double overlap = 0.5;
+        std::size_t numBands = 32;
+        double minHz = 20.0;
+        double maxHz = 20000.0;
+        bool decibels = true;
+    };
+
+    void Configure(const Config& config, uint32_t sampleRate);
+    void Process(const int16_t* samples, std::size_t numFrames, std::size_t numChannels);
+    // Writes the averaged bands and starts a new average. Returns false if no
+    // frame was analyzed since the last call.
+    bool Take(std::vector<float>& bands);
+    // numBands + 1 band edges in Hz.
+    std::vector<float> BandEdges() const;
+
+    uint32_t SampleRate() const { return sampleRate_; }
+    uint64_t FrameCount() const { return frames_; }
+
+private:
+    void Transform();
+
+    Config config_;
+    uint32_t sampleRate_ = 0;
+    std::size_t hop_ = 0;
+    // Band range after limiting maxHz to Nyquist.
+    double minHz_ = 0.0;
+    double maxHz_ = 0.0;
+
+    // Last fftSize samples, written circularly.
+    std::vector<float> input_;
+    std::size_t inputPosition_ = 0;
+    std::size_t untilFrame_ = 0;
+
+    // Real FFT of size N as a complex FFT of size N/2.
+    std::vector<float> window_;
+    float gain_ = 1.0f;
+    std::vector<std::complex<float>> buffer_;
+    std::vector<std::complex<float>> twiddles_;
+    std::vector<std::complex<float>> realTwiddles_;
+    std::vector<uint32_t> bitReverse_;
+
+    // Bins [bandStart_[b], bandEnd_[b]) make up band b.
+    std::vector<uint32_t> bandStart_;
+    std::vector<uint32_t> bandEnd_;
+    std::vector<float> power_;
+    std::vector<double> sum_;
+    uint32_t summed_ = 0;
+    uint64_t frames_ = 0;
+};
+
+// Analyzes a received channel from its own LinkAudioSource and delivers the
+// reduced band magnitudes to JS at a fixed rate. Buffers are analyzed on the
+// Link thread; the delivery thread only copies the latest average.
+class AbletonLinkAudioSpectrumAnalyzerWrapper
+    : public Napi::ObjectWrap<AbletonLinkAudioSpectrumAnalyzerWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    AbletonLinkAudioSpectrumAnalyzerWrapper(const Napi::CallbackInfo& info);
+    ~AbletonLinkAudioSpectrumAnalyzerWrapper();
+
+private:
+    Napi::Value GetSpectrum(const Napi::CallbackInfo& info);
+    Napi::Value BandFrequencies(const Napi::CallbackInfo& info);
+    Napi::Value Status(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void handleBuffer(const ableton::LinkAudioSource::BufferHandle& handle);
+    void Run();
+    void Dispatch(Napi::Env env, Napi::Function callback);
+
+    LogBandSpectrum::Config config_;
+    std::chrono::microseconds interval_{16667};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+    ChannelAnalyzer analyzer_{mutex_, wake_, running_};
+
+    // Guarded by mutex_.
+    LogBandSpectrum spectrum_;
+    std::vector<float> latest_;
+    bool hasLatest_ = false;
+    uint64_t buffersAnalyzed_ = 0;
+    uint64_t spectraDelivered_ = 0;
+};
+
+Napi::Object InitAbletonLinkSpectrum(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_SPECTRUM_H
@@ -0,0 +1,68 @@
+#ifndef ABLETONLINK_STATE_H
+#define ABLETONLINK_STATE_H
+
+#include <napi.h>
+
+// Field order of the Float64Array written by getState(quantum, out).
+enum LinkStateField : size_t {
+    kLinkStateTempo = 0,
+    kLinkStateBeat,
+    kLinkStatePhase,
+    kLinkStatePeers,
+    kLinkStatePlaying,
+    kLinkStateFieldCount
+};
+
+struct LinkStateSnapshot {
+    double tempo = 0.0;
+    double beat = 0.0;
+    double phase = 0.0;
+    double numPeers = 0.0;
+    bool isPlaying = false;
+};
+
+// Validates the arguments of getState(quantum, out?). Throws and returns false
+// on a bad quantum or an out array that is not a Float64Array of sufficient length.
+inline bool ParseLinkStateArgs(const Napi::CallbackInfo& info, double& quantum) {
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Quantum (number) expected")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    if (info.Length() > 1 && !info[1].IsUndefined()) {
+        if (!info[1].IsTypedArray() ||
+            info[1].As<Napi::TypedArray>().TypedArrayType() != napi_float64_array ||
+            info[1].As<Napi::TypedArray>().ElementLength() < kLinkStateFieldCount) {
+            Napi::TypeError::New(info.Env(), "Float64Array of length >= 5 expected")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    quantum = info[0].As<Napi::Number>().DoubleValue();
+    return true;
+}
+
+// Writes the snapshot into the caller's Float64Array when one was passed,
+// otherwise returns a plain LinkState object.
+inline Napi::Value LinkStateToValue(const Napi::CallbackInfo& info,
+                                    const LinkStateSnapshot& state) {
+    if (info.Length() > 1 && !info[1].IsUndefined()) {
+        auto out = info[1].As<Napi::Float64Array>();
+        out[kLinkStateTempo] = state.tempo;
+        out[kLinkStateBeat] = state.beat;
+        out[kLinkStatePhase] = state.phase;
+        out[kLinkStatePeers] = state.numPeers;
+        out[kLinkStatePlaying] = state.isPlaying ? 1.0 : 0.0;
+        return out;
+    }
+
+    auto obj = Napi::Object::New(info.Env());
+    obj.Set("tempo", state.tempo);
+    obj.Set("beat", state.beat);
+    obj.Set("phase", state.phase);
+    obj.Set("peers", state.numPeers);
+    obj.Set("playing", state.isPlaying);
+    return obj;
+}
+
+#endif // ABLETONLINK_STATE_H
@@ -0,0 +1,225 @@
+#ifndef ABLETONLINK_STATS_H
+#define ABLETONLINK_STATS_H
+
+#include "abletonlink_trace.h"
+
+#include <napi.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Counters behind getStats(). Every update is a relaxed atomic operation, so
+// the Link and audio threads never take a lock or wait on the JS thread to
+// record them; readers may see counters from slightly different instants.
+
+// Same clock as trace timestamps, so latencies line up with dumpTrace().
+inline uint64_t StatsNowMicros() {
+    return TraceNowMicros();
+}
+
+// Log2 histogram of latencies in microseconds: bucket i counts values in
+// [2^(i-1), 2^i), bucket 0 counts values below 1 µs and the last bucket
+// everything from ~8 s up.
+class LatencyHistogram {
+public:
+    static constexpr size_t kBuckets = 24;
+
+    void Record(uint64_t micros) {
+        size_t bucket = 0;
+        while (bucket + 1 < kBuckets && micros >= (uint64_t{1} << bucket)) {
+            ++bucket;
+        }
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(micros, std::memory_order_relaxed);
+        auto max = max_.load(std::memory_order_relaxed);
+        while (micros > max &&
+               !max_.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Percentiles are reported as the upper bound of the bucket they fall in.
+    Napi::Object ToObject(Napi::Env env) const {
+        std::array<uint64_t, kBuckets> counts{};
+        uint64_t total = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        const auto percentile = [&](double p) {
+            const auto target = static_cast<uint64_t>(p * static_cast<double>(total));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < kBuckets; ++i) {
+                seen += counts[i];
+                if (seen > target) {
+                    return static_cast<double>(uint64_t{1} << i);
+                }
+            }
+            return static_cast<double>(uint64_t{1} << (kBuckets - 1));
+        };
+
+        auto result = Napi::Object::New(env);
+        const auto count = count_.load(std::memory_order_relaxed);
+        result.Set("count", static_cast<double>(count));
+        result.Set("meanUs", count > 0 ? static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+                                             static_cast<double>(count)
+                                       : 0.0);
+        result.Set("maxUs", static_cast<double>(max_.load(std::memory_order_relaxed)));
+        result.Set("p50Us", total > 0 ? percentile(0.5) : 0.0);
+        result.Set("p90Us", total > 0 ? percentile(0.9) : 0.0);
+        result.Set("p99Us", total > 0 ? percentile(0.99) : 0.0);
+        auto buckets = Napi::Array::New(env, kBuckets);
+        for (size_t i = 0; i < kBuckets; ++i) {
+            buckets.Set(i, static_cast<double>(counts[i]));
+        }
+        result.Set("buckets", buckets);
+        return result;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// A notification routed from a native thread to a JS callback. `fired` counts
+// notifications, `posted` the ThreadSafeFunction calls queued for them (fewer
+// when coalesced), `delivered` the calls that ran on the JS thread and
+// `dropped` the ones the queue refused or that were discarded by an abort.
+// Latency runs from queueing to the start of the JS-thread call. `name` is the
+// trace category of the path.
+struct CallbackStats {
+    explicit CallbackStats(const char* name) : name(name) {}
+
+    const char* name;
+    std::atomic<uint64_t> fired{0};
+    std::atomic<uint64_t> posted{0};
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> dropped{0};
+    LatencyHistogram latency;
+
+    void Fired() { fired.fetch_add(1, std::memory_order_relaxed); }
+
+    // Returns the timestamp to hand back to Delivered().
+    uint64_t Posted() {
+        posted.fetch_add(1, std::memory_order_relaxed);
+        return StatsNowMicros();
+    }
+
+    void Dropped() {
+        posted.fetch_sub(1, std::memory_order_relaxed);
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        TraceInstant(name, "tsfn.dropped");
+    }
+
+    // The ThreadSafeFunction was aborted, so calls still queued never run.
+    // Called on the JS thread, under the lock that guards posting.
+    void Aborted() {
+        const auto postedCount = posted.load(std::memory_order_relaxed);
+        const auto deliveredCount = delivered.load(std::memory_order_relaxed);
+        if (postedCount > deliveredCount) {
+            posted.fetch_sub(postedCount - deliveredCount, std::memory_order_relaxed);
+            dropped.fetch_add(postedCount - deliveredCount, std::memory_order_relaxed);
+        }
+    }
+
+    void Delivered(uint64_t postedAt) {
+        delivered.fetch_add(1, std::memory_order_relaxed);
+        const auto now = StatsNowMicros();
+        latency.Record(now > postedAt ? now - postedAt : 0);
+        TraceComplete(name, "tsfn.queue", postedAt, now);
+    }
+
+    Napi::Object ToObject(Napi::Env env) const {
+        const auto postedCount = posted.load(std::memory_order_relaxed);
+        const auto deliveredCount = delivered.load(std::memory_order_relaxed);
+        auto result = Napi::Object::New(env);
+        result.Set("fired", static_cast<double>(fired.load(std::memory_order_relaxed)));
+        result.Set("posted", static_cast<double>(postedCount));
+        result.Set("delivered", static_cast<double>(deliveredCount));
+        result.Set("dropped", static_cast<double>(dropped.load(std::memory_order_relaxed)));
+        const auto queueDepth = postedCount > deliveredCount ? postedCount - deliveredCount : 0;
+        result.Set("queueDepth", static_cast<double>(queueDepth));
+        result.Set("latency", latency.ToObject(env));
+        return result;
+    }
+};
+
+// BlockingCall that records the call in stats. stats must outlive the
+// ThreadSafeFunction (it is a member of the wrapper that owns both).
+template <typename Call>
+void PostCounted(Napi::ThreadSafeFunction& tsfn, CallbackStats& stats, Call call) {
+    const auto postedAt = stats.Posted();
+    CallbackStats* counters = &stats;
+    const auto status = tsfn.BlockingCall(
+        [counters, postedAt, call](Napi::Env env, Napi::Function callback) {
+            counters->Delivered(postedAt);
+            TraceSpan span(counters->name, "js.callback");
+            call(env, callback);
+        });
+    if (status != napi_ok) {
+        stats.Dropped();
+    }
+}
+
+// Buffers retained and committed through one LinkAudioSink, from JS handles
+// and native transports alike.
+struct SinkStats {
+    std::atomic<uint64_t> buffersRetained{0};
+    std::atomic<uint64_t> retainFailures{0};
+    std::atomic<uint64_t> commits{0};
+    std::atomic<uint64_t> commitFailures{0};
+    std::atomic<uint64_t> bytesCommitted{0};
+
+    void Retained(bool ok) {
+        (ok ? buffersRetained : retainFailures).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Committed(bool ok, uint64_t bytes) {
+        if (!ok) {
+            commitFailures.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        commits.fetch_add(1, std::memory_order_relaxed);
+        bytesCommitted.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    Napi::Object ToObject(Napi::Env env) const {
+        auto result = Napi::Object::New(env);
+        result.Set("buffersRetained",
+                   static_cast<double>(buffersRetained.load(std::memory_order_relaxed)));
+        result.Set("retainFailures",
+                   static_cast<double>(retainFailures.load(std::memory_order_relaxed)));
+        result.Set("commits", static_cast<double>(commits.load(std::memory_order_relaxed)));
+        result.Set("commitFailures",
+                   static_cast<double>(commitFailures.load(std::memory_order_relaxed)));
+        result.Set("bytesCommitted",
+                   static_cast<double>(bytesCommitted.load(std::memory_order_relaxed)));
+        return result;
+    }
+};
+
+// Buffers per second since the previous call, for per-channel rates reported
+// by getStats(). JS thread only.
+class RateWindow {
+public:
+    double Update(uint64_t total) {
+        const auto now = StatsNowMicros();
+        double rate = 0.0;
+        if (lastAt_ != 0 && now > lastAt_) {
+            rate = static_cast<double>(total - lastTotal_) * 1e6 /
+                   static_cast<double>(now - lastAt_);
+        }
+        lastAt_ = now;
+        lastTotal_ = total;
+        return rate;
+    }
+
+private:
+    uint64_t lastAt_ = 0;
+    uint64_t lastTotal_ = 0;
+};
+
+#endif // ABLETONLINK_STATS_H
@@ -0,0 +1,436 @@
+#include "abletonlink_tempo.h"
+#include "abletonlink_addon.h"
+#include "abletonlink_trace.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kFrameRate = 100.0;
+constexpr double kLowBandHz = 150.0;
+// Scales band power before log compression so that quiet noise stays near 0.
+constexpr float kLevelScale = 1e4f;
+// Beats of onset history compared against a pulse train to find the phase.
+constexpr std::size_t kPhaseBeats = 4;
+// Width of the tempo prior around 120 BPM, in octaves.
+constexpr double kPriorOctaves = 1.0;
+// Smallest tempo difference worth committing to the session.
+constexpr double kMinTempoChange = 0.05;
+constexpr double kPi = 3.14159265358979323846;
+
+Napi::Object EstimateToObject(Napi::Env env, bool valid, double bpm, double confidence,
+                              double beatTime, double beat, double phase) {
+    auto obj = Napi::Object::New(env);
+    obj.Set("tempo", valid ? Napi::Value(Napi::Number::New(env, bpm)) : env.Null());
+    obj.Set("confidence", valid ? confidence : 0.0);
+    // Reported in seconds, like every other Link time in the JS API.
+    obj.Set("beatTime",
+            valid ? Napi::Value(Napi::Number::New(env, beatTime / 1000000.0)) : env.Null());
+    obj.Set("beat", valid ? Napi::Value(Napi::Number::New(env, beat)) : env.Null());
+    obj.Set("phase", valid ? Napi::Value(Napi::Number::New(env, phase)) : env.Null());
+    return obj;
+}
+
+// estimateTempo(samples, numChannels, sampleRate, options) analyzes a whole
+// recording with the detector the tracker uses. beatTime is the most recent
+// beat in seconds from the first sample.
+Napi::Value EstimateTempo(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    if (info.Length() < 3 || !info[0].IsTypedArray() || !info[1].IsNumber() ||
+        !info[2].IsNumber() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_int16_array) {
+        Napi::TypeError::New(env, "Int16Array, numChannels, and sampleRate expected")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    auto samples = info[0].As<Napi::Int16Array>();
+    const auto numChannels = info[1].As<Napi::Number>().Uint32Value();
+    const auto sampleRate = info[2].As<Napi::Number>().Uint32Value();
+    if (numChannels == 0 || sampleRate == 0 || samples.ElementLength() % numChannels != 0) {
+        Napi::TypeError::New(env, "Sample count must be a multiple of a positive numChannels, "
+                                  "and sampleRate positive")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    double minBpm = 70.0;
+    double maxBpm = 180.0;
+    double halfLifeSec = 8.0;
+    if (info.Length() > 3 && info[3].IsObject()) {
+        auto options = info[3].As<Napi::Object>();
+        if (options.Get("minBpm").IsNumber()) {
+            minBpm = options.Get("minBpm").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("maxBpm").IsNumber()) {
+            maxBpm = options.Get("maxBpm").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("halfLifeSec").IsNumber()) {
+            halfLifeSec = options.Get("halfLifeSec").As<Napi::Number>().DoubleValue();
+        }
+    }
+    if (!(minBpm >= 20.0) || !(maxBpm > minBpm) || !(maxBpm <= 999.0) || !(halfLifeSec > 0.0)) {
+        Napi::TypeError::New(env, "Half-life must be positive and 20 <= minBpm < maxBpm <= 999")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OnsetTempoDetector detector;
+    detector.Configure(sampleRate, minBpm, maxBpm, halfLifeSec);
+    detector.Process(samples.Data(), samples.ElementLength() / numChannels, numChannels);
+    const auto estimate = detector.Evaluate();
+
+    auto obj = Napi::Object::New(env);
+    obj.Set("tempo", estimate.valid ? Napi::Value(Napi::Number::New(env, estimate.bpm))
+                                    : env.Null());
+    obj.Set("confidence", estimate.valid ? estimate.confidence : 0.0);
+    if (estimate.valid) {
+        // Centre of the onset frame holding the beat.
+        const auto frame = static_cast<double>(detector.FrameCount()) - 1.0 - estimate.beatAge;
+        obj.Set("beatTime", (frame + 0.5) * detector.HopSize() / sampleRate);
+    } else {
+        obj.Set("beatTime", env.Null());
+    }
+    return obj;
+}
+} // namespace
+
+void OnsetTempoDetector::Configure(uint32_t sampleRate, double minBpm, double maxBpm,
+                                   double halfLifeSec) {
+    sampleRate_ = sampleRate;
+    minBpm_ = minBpm;
+    maxBpm_ = maxBpm;
+    hop_ = std::max<std::size_t>(1, std::lround(sampleRate / kFrameRate));
+    frameRate_ = static_cast<double>(sampleRate) / hop_;
+    minLag_ = std::max<std::size_t>(2, static_cast<std::size_t>(60.0 * frameRate_ / maxBpm));
+    maxLag_ = std::max<std::size_t>(minLag_ + 2, std::ceil(60.0 * frameRate_ / minBpm));
+    decay_ = static_cast<float>(std::pow(0.5, 1.0 / (halfLifeSec * frameRate_)));
+    lowCoefficient_ = static_cast<float>(1.0 - std::exp(-2.0 * kPi * kLowBandHz / sampleRate));
+
+    std::size_t historySize = 1;
+    while (historySize < (kPhaseBeats + 1) * maxLag_) {
+        historySize <<= 1;
+    }
+    history_.assign(historySize, 0.0f);
+    historyMask_ = historySize - 1;
+    acf_.assign(2 * maxLag_ + 1, 0.0f);
+
+    low_ = lowEnergy_ = highEnergy_ = 0.0f;
+    hopPosition_ = 0;
+    lastLow_ = lastHigh_ = mean_ = energy_ = 0.0f;
+    frames_ = 0;
+}
+
+void OnsetTempoDetector::Process(const int16_t* samples, std::size_t numFrames,
+                                 std::size_t numChannels) {
+    const float scale = 1.0f / (32768.0f * static_cast<float>(numChannels));
+    for (std::size_t frame = 0; frame < numFrames; ++frame) {
+        float x = 0.0f;
+        for (std::size_t c = 0; c < numChannels; ++c) {
+            x += samples[frame * numChannels + c];
+        }
+        x *= scale;
+        low_ += lowCoefficient_ * (x - low_);
+        const float high = x - low_;
+        lowEnergy_ += low_ * low_;
+        highEnergy_ += high * high;
+        if (++hopPosition_ == hop_) {
+            PushFrame();
+        }
+    }
+}
+
+void OnsetTempoDetector::PushFrame() {
+    hopPosition_ = 0;
+    const float lowLevel = std::log1p(kLevelScale * lowEnergy_ / hop_);
+    const float highLevel = std::log1p(kLevelScale * highEnergy_ / hop_);
+    lowEnergy_ = highEnergy_ = 0.0f;
+    const float onset =
+        std::max(0.0f, lowLevel - lastLow_) + std::max(0.0f, highLevel - lastHigh_);
+    lastLow_ = lowLevel;
+    lastHigh_ = highLevel;
+
+    // Subtracting a one-second running mean leaves the peaks.
+    mean_ += static_cast<float>(1.0 / frameRate_) * (onset - mean_);
+    const float value = std::max(0.0f, onset - mean_);
+    history_[frames_ & historyMask_] = value;
+    ++frames_;
+
+    energy_ = decay_ * energy_ + value * value;
+    const auto lags = std::min<std::size_t>(acf_.size(), frames_);
+    for (std::size_t lag = minLag_; lag < lags; ++lag) {
+        acf_[lag] = decay_ * acf_[lag] + value * History(lag);
+    }
+}
+
+float OnsetTempoDetector::History(std::size_t age) const {
+    return age < frames_ ? history_[(frames_ - 1 - age) & historyMask_] : 0.0f;
+}
+
+OnsetTempoDetector::Estimate OnsetTempoDetector::Evaluate() const {
+    Estimate estimate;
+    if (frames_ < kPhaseBeats * maxLag_ || !(energy_ > 1e-9f)) {
+        return estimate;
+    }
+
+    // Each period is scored with its double, which favours the beat over the
+    // half-beat, and weighted towards moderate tempos.
+    const auto score = [this](std::size_t lag) {
+        const double octaves = std::log2(60.0 * frameRate_ / lag / 120.0) / kPriorOctaves;
+        return (acf_[lag] + 0.5 * acf_[2 * lag]) * std::exp(-0.5 * octaves * octaves);
+    };
+    std::size_t best = 0;
+    double bestScore = 0.0;
+    double sum = 0.0;
+    for (std::size_t lag = minLag_; lag <= maxLag_; ++lag) {
+        sum += acf_[lag];
+        const auto value = score(lag);
+        if (value > bestScore) {
+            best = lag;
+            bestScore = value;
+        }
+    }
+    if (best == 0) {
+        return estimate;
+    }
+
+    // The period is refined at its double, where a lag step is half as
+    // coarse, by fitting a parabola through the peak there.
+    auto peak = 2 * best;
+    for (const auto lag : {2 * best - 1, 2 * best + 1}) {
+        if (lag < acf_.size() && acf_[lag] > acf_[peak]) {
+            peak = lag;
+        }
+    }
+    double period = 0.5 * static_cast<double>(peak);
+    if (peak + 1 < acf_.size()) {
+        const double before = acf_[peak - 1];
+        const double after = acf_[peak + 1];
+        const auto curvature = before - 2.0 * acf_[peak] + after;
+        if (curvature < 0.0) {
+            period += 0.5 * std::clamp(0.5 * (before - after) / curvature, -0.5, 0.5);
+        }
+    }
+    const auto mean = sum / static_cast<double>(maxLag_ - minLag_ + 1);
+    estimate.confidence = std::clamp((acf_[best] - mean) / (energy_ - mean), 0.0, 1.0);
+
+    // The most recent beat is the offset whose pulse train through the last
+    // few periods collects the most onset strength.
+    double bestPhase = -1.0;
+    const auto offsets = static_cast<std::size_t>(std::ceil(period));
+    for (std::size_t offset = 0; offset < offsets; ++offset) {
+        double strength = 0.0;
+        for (std::size_t beat = 0; beat < kPhaseBeats; ++beat) {
+            strength += History(static_cast<std::size_t>(std::lround(offset + beat * period)));
+        }
+        if (strength > bestPhase) {
+            bestPhase = strength;
+            estimate.beatAge = static_cast<double>(offset);
+        }
+    }
+
+    estimate.valid = true;
+    estimate.bpm = 60.0 * frameRate_ / period;
+    return estimate;
+}
+
+Napi::Object AbletonLinkAudioTempoTrackerWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "AbletonLinkAudioTempoTracker", {
+        InstanceMethod("status", &AbletonLinkAudioTempoTrackerWrapper::Status),
+        InstanceMethod("setCommitEnabled", &AbletonLinkAudioTempoTrackerWrapper::SetCommitEnabled),
+        InstanceMethod("close", &AbletonLinkAudioTempoTrackerWrapper::Close),
+    });
+
+    AddonData(env).tempoTracker = Napi::Persistent(func);
+    exports.Set("AbletonLinkAudioTempoTracker", func);
+    return exports;
+}
+
+AbletonLinkAudioTempoTrackerWrapper::AbletonLinkAudioTempoTrackerWrapper(
+    const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<AbletonLinkAudioTempoTrackerWrapper>(info) {
+    const bool opened = analyzer_.Open(info, "LinkTempoTrackerDispatch", [&]() {
+        if (info.Length() > 3 && info[3].IsObject()) {
+            auto options = info[3].As<Napi::Object>();
+            if (options.Get("quantum").IsNumber()) {
+                quantum_ = options.Get("quantum").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("minBpm").IsNumber()) {
+                minBpm_ = options.Get("minBpm").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("maxBpm").IsNumber()) {
+                maxBpm_ = options.Get("maxBpm").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("halfLifeSec").IsNumber()) {
+                halfLifeSec_ = options.Get("halfLifeSec").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("minConfidence").IsNumber()) {
+                minConfidence_ = options.Get("minConfidence").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("intervalMs").IsNumber()) {
+                const auto intervalMs =
+                    options.Get("intervalMs").As<Napi::Number>().DoubleValue();
+                interval_ = std::chrono::microseconds(
+                    static_cast<long long>(std::max(10.0, intervalMs) * 1000.0));
+            }
+            if (options.Get("commit").IsBoolean()) {
+                commit_ = options.Get("commit").As<Napi::Boolean>().Value();
+            }
+        }
+        if (!(quantum_ > 0.0) || !(minBpm_ >= 20.0) || !(maxBpm_ > minBpm_) ||
+            !(maxBpm_ <= 999.0) || !(halfLifeSec_ > 0.0)) {
+            Napi::TypeError::New(info.Env(),
+                                 "Quantum and half-life must be positive and 20 <= minBpm < "
+                                 "maxBpm <= 999")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    });
+    if (!opened) {
+        return;
+    }
+    analyzer_.Start([this]() { Run(); }, [this](const auto& handle) { handleBuffer(handle); });
+}
+
+AbletonLinkAudioTempoTrackerWrapper::~AbletonLinkAudioTempoTrackerWrapper() {
+    analyzer_.Close();
+}
+
+Napi::Value AbletonLinkAudioTempoTrackerWrapper::Status(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto obj = EstimateToObject(info.Env(), report_.valid, report_.bpm, report_.confidence,
+                                report_.beatTime, report_.beat, report_.phase);
+    obj.Set("running", running_);
+    obj.Set("commitEnabled", commit_);
+    obj.Set("buffersAnalyzed", static_cast<double>(buffersAnalyzed_));
+    obj.Set("onsetFrames", static_cast<double>(detector_.FrameCount()));
+    obj.Set("commits", static_cast<double>(commits_));
+    return obj;
+}
+
+void AbletonLinkAudioTempoTrackerWrapper::SetCommitEnabled(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(info.Env(), "Boolean expected").ThrowAsJavaScriptException();
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    commit_ = info[0].As<Napi::Boolean>().Value();
+}
+
+void AbletonLinkAudioTempoTrackerWrapper::Close(const Napi::CallbackInfo& info) {
+    analyzer_.Close();
+}
+
+void AbletonLinkAudioTempoTrackerWrapper::handleBuffer(
+    const ableton::LinkAudioSource::BufferHandle& handle) {
+    TraceSpan span("tempo", "analyze");
+    const auto& bufferInfo = handle.info;
+    if (bufferInfo.numFrames == 0 || bufferInfo.numChannels == 0 || bufferInfo.sampleRate == 0) {
+        return;
+    }
+    const auto arrival = analyzer_.Link().clock().micros();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+        return;
+    }
+    if (detector_.SampleRate() != bufferInfo.sampleRate) {
+        detector_.Configure(bufferInfo.sampleRate, minBpm_, maxBpm_, halfLifeSec_);
+        evaluatedFrames_ = 0;
+    }
+    detector_.Process(handle.samples, bufferInfo.numFrames, bufferInfo.numChannels);
+    lastInfo_ = bufferInfo;
+    lastArrival_ = arrival;
+    ++buffersAnalyzed_;
+}
+
+void AbletonLinkAudioTempoTrackerWrapper::Run() {
+    TraceThreadName("tempo-tracker");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        wake_.wait_for(lock, interval_);
+        if (!running_) {
+            return;
+        }
+        lock.unlock();
+        Evaluate();
+        lock.lock();
+    }
+}
+
+void AbletonLinkAudioTempoTrackerWrapper::Evaluate() {
+    // Called on the tracker thread without mutex_.
+    OnsetTempoDetector::Estimate estimate;
+    ableton::LinkAudioSource::BufferHandle::Info bufferInfo{};
+    std::chrono::microseconds arrival{0};
+    double newestFrameAge = 0.0;
+    double frameMicros = 0.0;
+    bool commit = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (detector_.FrameCount() == evaluatedFrames_) {
+            return;
+        }
+        evaluatedFrames_ = detector_.FrameCount();
+        estimate = detector_.Evaluate();
+        bufferInfo = lastInfo_;
+        arrival = lastArrival_;
+        const auto sampleMicros = 1000000.0 / detector_.SampleRate();
+        frameMicros = detector_.HopSize() * sampleMicros;
+        // Centre of the newest onset frame, before the end of the latest buffer.
+        newestFrameAge = detector_.SamplesSinceFrame() * sampleMicros + 0.5 * frameMicros;
+        commit = commit_;
+    }
+
+    TraceSpan span("tempo", "evaluate");
+    Report report;
+    if (estimate.valid) {
+        auto& link = analyzer_.Link();
+        auto state = link.captureAppSessionState();
+        // Buffers from the local session are placed where they play on the
+        // timeline; others fall back to when they arrived.
+        auto bufferEnd = static_cast<double>(arrival.count());
+        if (const auto endBeat = bufferInfo.endBeats(state, quantum_)) {
+            bufferEnd = static_cast<double>(state.timeAtBeat(*endBeat, quantum_).count());
+        }
+        report.valid = true;
+        report.bpm = estimate.bpm;
+        report.confidence = estimate.confidence;
+        report.beatTime = bufferEnd - newestFrameAge - estimate.beatAge * frameMicros;
+        report.beat = state.beatAtTime(
+            std::chrono::microseconds(std::llround(report.beatTime)), quantum_);
+        report.phase = report.beat - std::round(report.beat);
+        if (commit && estimate.confidence >= minConfidence_ &&
+            std::abs(estimate.bpm - state.tempo()) >= kMinTempoChange) {
+            state.setTempo(estimate.bpm, link.clock().micros());
+            link.commitAppSessionState(state);
+            report.committed = true;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    report_ = report;
+    if (report.committed) {
+        ++commits_;
+    }
+    analyzer_.Post([this](Napi::Env env, Napi::Function callback) { Dispatch(env, callback); });
+}
+
+void AbletonLinkAudioTempoTrackerWrapper::Dispatch(Napi::Env env, Napi::Function callback) {
+    Report report;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        report = report_;
+        analyzer_.Dispatched();
+    }
+    auto obj = EstimateToObject(env, report.valid, report.bpm, report.confidence,
+                                report.beatTime, report.beat, report.phase);
+    obj.Set("committed", report.committed);
+    callback.Call({obj});
+}
+
+Napi::Object InitAbletonLinkTempo(Napi::Env env, Napi::Object exports) {
+    AbletonLinkAudioTempoTrackerWrapper::Init(env, exports);
+    exports.Set("estimateTempo", Napi::Function::New(env, EstimateTempo, "estimateTempo"));
+    return exports;
+}
@@ -0,0 +1,135 @@
+#ifndef ABLETONLINK_TEMPO_H
+#define ABLETONLINK_TEMPO_H
+
+#include "abletonlink_analyzer.h"
+
+#include <napi.h>
+#include <ableton/LinkAudio.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Incremental onset/tempo estimator. Audio is reduced to an onset strength
+// signal at about 100 Hz (rectified log-energy rise in a low and a high
+// band), whose autocorrelation over the tempo range is updated with
+// exponential forgetting as each frame arrives. Estimating tempo and the
+// position of the most recent beat only reads that state, so the per-sample
+// cost is a few multiply-adds and the per-frame cost is one pass over the
+// lag range.
+class OnsetTempoDetector {
+public:
+    struct Estimate {
+        bool valid = false;
+        double bpm = 0.0;
+        double confidence = 0.0;
+        // Onset frames between the newest frame and the most recent beat.
+        double beatAge = 0.0;
+    };
+
+    void Configure(uint32_t sampleRate, double minBpm, double maxBpm, double halfLifeSec);
+    void Process(const int16_t* samples, std::size_t numFrames, std::size_t numChannels);
+    Estimate Evaluate() const;
+
+    uint32_t SampleRate() const { return sampleRate_; }
+    std::size_t HopSize() const { return hop_; }
+    uint64_t FrameCount() const { return frames_; }
+    // Samples received since the newest onset frame ended.
+    std::size_t SamplesSinceFrame() const { return hopPosition_; }
+
+private:
+    void PushFrame();
+    float History(std::size_t age) const;
+
+    uint32_t sampleRate_ = 0;
+    double minBpm_ = 70.0;
+    double maxBpm_ = 180.0;
+    std::size_t hop_ = 480;
+    double frameRate_ = 100.0;
+    std::size_t minLag_ = 0;
+    std::size_t maxLag_ = 0;
+    float decay_ = 1.0f;
+    float lowCoefficient_ = 0.0f;
+
+    // Per-sample state.
+    float low_ = 0.0f;
+    float lowEnergy_ = 0.0f;
+    float highEnergy_ = 0.0f;
+    std::size_t hopPosition_ = 0;
+
+    // Per-frame state.
+    float lastLow_ = 0.0f;
+    float lastHigh_ = 0.0f;
+    float mean_ = 0.0f;
+    std::vector<float> history_;
+    std::size_t historyMask_ = 0;
+    uint64_t frames_ = 0;
+    // acf_[lag] for lags up to twice maxLag_, so each candidate period can be
+    // scored together with its double.
+    std::vector<float> acf_;
+    float energy_ = 0.0f;
+};
+
+// Tracks the tempo of a received channel from its own LinkAudioSource.
+// Buffers are analyzed on the Link thread as they arrive; a separate thread
+// evaluates the estimate every interval, maps the latest beat onto the local
+// session timeline, optionally commits the tempo to the session and posts the
+// estimate to JS.
+class AbletonLinkAudioTempoTrackerWrapper
+    : public Napi::ObjectWrap<AbletonLinkAudioTempoTrackerWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    AbletonLinkAudioTempoTrackerWrapper(const Napi::CallbackInfo& info);
+    ~AbletonLinkAudioTempoTrackerWrapper();
+
+private:
+    struct Report {
+        bool valid = false;
+        double bpm = 0.0;
+        double confidence = 0.0;
+        // Link clock micros.
+        double beatTime = 0.0;
+        double beat = 0.0;
+        double phase = 0.0;
+        bool committed = false;
+    };
+
+    Napi::Value Status(const Napi::CallbackInfo& info);
+    void SetCommitEnabled(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void handleBuffer(const ableton::LinkAudioSource::BufferHandle& handle);
+    void Run();
+    void Evaluate();
+    void Dispatch(Napi::Env env, Napi::Function callback);
+
+    double quantum_ = 4.0;
+    double minBpm_ = 70.0;
+    double maxBpm_ = 180.0;
+    double halfLifeSec_ = 8.0;
+    double minConfidence_ = 0.5;
+    std::chrono::microseconds interval_{500000};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+    ChannelAnalyzer analyzer_{mutex_, wake_, running_};
+
+    // Guarded by mutex_. The latest buffer's info and arrival time place the
+    // newest onset frame on the timeline.
+    OnsetTempoDetector detector_;
+    ableton::LinkAudioSource::BufferHandle::Info lastInfo_{};
+    std::chrono::microseconds lastArrival_{0};
+    uint64_t evaluatedFrames_ = 0;
+    uint64_t buffersAnalyzed_ = 0;
+    uint64_t commits_ = 0;
+    bool commit_ = false;
+    Report report_;
+};
+
+Napi::Object InitAbletonLinkTempo(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_TEMPO_H
@@ -0,0 +1,308 @@
+#include "abletonlink_thread_policy.h"
+#include "abletonlink_trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+enum class SchedPolicy { kOther, kFifo, kRoundRobin };
+
+struct ThreadPolicy {
+    SchedPolicy policy = SchedPolicy::kOther;
+    int priority = 0;
+    // Affinity is left alone until cpuAffinity is given; an empty list then
+    // means every CPU.
+    bool setAffinity = false;
+    std::vector<int> cpus;
+};
+
+struct OwnedThread {
+    std::string name;
+#if defined(__linux__)
+    pthread_t handle;
+#endif
+};
+
+struct ThreadReport {
+    std::string name;
+    std::vector<std::string> errors;
+};
+
+// How long setThreadPolicy() waits for a thread reached through an executor.
+constexpr std::chrono::milliseconds kExecutorTimeout{250};
+
+constexpr const char* kRealtimeHint = " (needs CAP_SYS_NICE or an RLIMIT_RTPRIO limit)";
+constexpr const char* kMemlockHint = " (needs CAP_IPC_LOCK or a larger RLIMIT_MEMLOCK)";
+
+std::mutex policyMutex;
+bool policySet = false;
+ThreadPolicy currentPolicy;
+std::map<uint64_t, OwnedThread> ownedThreads;
+std::map<uint64_t, std::pair<std::string, ThreadPolicyExecutor>> executors;
+uint64_t nextThreadId = 1;
+
+std::string ErrorText(int error, const char* permissionHint) {
+    std::string text = std::strerror(error);
+    if (error == EPERM || error == ENOMEM) {
+        text += permissionHint;
+    }
+    return text;
+}
+
+#if defined(__linux__)
+// Failures leave the thread on its previous (default) scheduling.
+std::vector<std::string> ApplyPolicy(pthread_t thread, const ThreadPolicy& policy) {
+    std::vector<std::string> errors;
+
+    int native = SCHED_OTHER;
+    if (policy.policy == SchedPolicy::kFifo) {
+        native = SCHED_FIFO;
+    } else if (policy.policy == SchedPolicy::kRoundRobin) {
+        native = SCHED_RR;
+    }
+    sched_param param{};
+    if (native != SCHED_OTHER) {
+        param.sched_priority = std::clamp(policy.priority, sched_get_priority_min(native),
+                                          sched_get_priority_max(native));
+    }
+    const auto schedResult = pthread_setschedparam(thread, native, &param);
+    if (schedResult != 0) {
+        errors.push_back("policy: " + ErrorText(schedResult, kRealtimeHint));
+    }
+
+    if (policy.setAffinity) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (policy.cpus.empty()) {
+            const auto count = std::min<long>(sysconf(_SC_NPROCESSORS_CONF), CPU_SETSIZE);
+            for (long cpu = 0; cpu < count; ++cpu) {
+                CPU_SET(cpu, &set);
+            }
+        } else {
+            for (const auto cpu : policy.cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+        }
+        const auto affinityResult = pthread_setaffinity_np(thread, sizeof(set), &set);
+        if (affinityResult != 0) {
+            errors.push_back("cpuAffinity: " + ErrorText(affinityResult, ""));
+        }
+    }
+    return errors;
+}
+#endif
+
+bool ParseThreadPolicy(const Napi::CallbackInfo& info, ThreadPolicy& policy) {
+    auto env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Options object ({ policy, priority, cpuAffinity, mlock }) "
+                                  "expected")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    auto options = info[0].As<Napi::Object>();
+
+    const auto name = options.Get("policy");
+    if (name.IsString()) {
+        const auto value = name.As<Napi::String>().Utf8Value();
+        if (value == "fifo") {
+            policy.policy = SchedPolicy::kFifo;
+        } else if (value == "rr") {
+            policy.policy = SchedPolicy::kRoundRobin;
+        } else if (value == "other") {
+            policy.policy = SchedPolicy::kOther;
+        } else {
+            Napi::TypeError::New(env, "policy must be 'fifo', 'rr' or 'other'")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+    } else if (!name.IsUndefined()) {
+        Napi::TypeError::New(env, "policy must be 'fifo', 'rr' or 'other'")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+
+    const auto priority = options.Get("priority");
+    if (priority.IsNumber()) {
+        policy.priority = priority.As<Napi::Number>().Int32Value();
+    }
+
+    const auto affinity = options.Get("cpuAffinity");
+    if (affinity.IsArray()) {
+        auto cpus = affinity.As<Napi::Array>();
+        policy.setAffinity = true;
+        for (uint32_t i = 0; i < cpus.Length(); ++i) {
+            const auto cpu = cpus.Get(i);
+            if (!cpu.IsNumber()) {
+                Napi::TypeError::New(env, "cpuAffinity must be an array of CPU indices")
+                    .ThrowAsJavaScriptException();
+                return false;
+            }
+            policy.cpus.push_back(cpu.As<Napi::Number>().Int32Value());
+        }
+    } else if (!affinity.IsUndefined()) {
+        Napi::TypeError::New(env, "cpuAffinity must be an array of CPU indices")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+Napi::Value ReportToValue(Napi::Env env, const std::vector<ThreadReport>& reports) {
+    auto threads = Napi::Array::New(env, reports.size());
+    for (size_t i = 0; i < reports.size(); ++i) {
+        auto entry = Napi::Object::New(env);
+        entry.Set("name", reports[i].name);
+        entry.Set("ok", reports[i].errors.empty());
+        auto errors = Napi::Array::New(env, reports[i].errors.size());
+        for (size_t j = 0; j < reports[i].errors.size(); ++j) {
+            errors.Set(j, reports[i].errors[j]);
+        }
+        entry.Set("errors", errors);
+        threads.Set(i, entry);
+    }
+    return threads;
+}
+
+Napi::Value SetThreadPolicy(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    ThreadPolicy policy;
+    if (!ParseThreadPolicy(info, policy)) {
+        return env.Null();
+    }
+    const auto mlockOption = info[0].As<Napi::Object>().Get("mlock");
+
+    std::vector<ThreadReport> reports;
+    std::vector<std::pair<uint64_t, std::pair<std::string, ThreadPolicyExecutor>>> targets;
+    {
+        std::lock_guard<std::mutex> lock(policyMutex);
+        if (!policy.setAffinity) {
+            policy.setAffinity = currentPolicy.setAffinity;
+            policy.cpus = currentPolicy.cpus;
+        }
+        currentPolicy = policy;
+        policySet = true;
+        for (const auto& item : ownedThreads) {
+#if defined(__linux__)
+            reports.push_back({item.second.name, ApplyPolicy(item.second.handle, policy)});
+#else
+            reports.push_back({item.second.name, {"not supported on this platform"}});
+#endif
+        }
+        targets.assign(executors.begin(), executors.end());
+    }
+
+    // Threads owned by Link run the policy themselves; wait briefly for each.
+    std::vector<uint64_t> gone;
+    for (auto& target : targets) {
+#if defined(__linux__)
+        auto result = std::make_shared<std::promise<std::vector<std::string>>>();
+        auto future = result->get_future();
+        const auto posted = target.second.second([result, policy]() {
+            result->set_value(ApplyPolicy(pthread_self(), policy));
+        });
+        if (!posted) {
+            gone.push_back(target.first);
+            continue;
+        }
+        if (future.wait_for(kExecutorTimeout) == std::future_status::ready) {
+            reports.push_back({target.second.first, future.get()});
+        } else {
+            reports.push_back({target.second.first, {"timed out waiting for the thread"}});
+        }
+#else
+        reports.push_back({target.second.first, {"not supported on this platform"}});
+#endif
+    }
+    if (!gone.empty()) {
+        std::lock_guard<std::mutex> lock(policyMutex);
+        for (const auto id : gone) {
+            executors.erase(id);
+        }
+    }
+
+    auto report = Napi::Object::New(env);
+#if defined(__linux__)
+    report.Set("supported", true);
+#else
+    report.Set("supported", false);
+#endif
+    report.Set("threads", ReportToValue(env, reports));
+
+    if (mlockOption.IsBoolean()) {
+        auto mlock = Napi::Object::New(env);
+#if defined(__linux__)
+        const auto lockMemory = mlockOption.As<Napi::Boolean>().Value();
+        const auto result = lockMemory ? mlockall(MCL_CURRENT | MCL_FUTURE) : munlockall();
+        // Read before any N-API call can overwrite it.
+        const int error = errno;
+        mlock.Set("ok", result == 0);
+        if (result != 0) {
+            mlock.Set("error", ErrorText(error, kMemlockHint));
+        }
+#else
+        mlock.Set("ok", false);
+        mlock.Set("error", "not supported on this platform");
+#endif
+        report.Set("mlock", mlock);
+    } else {
+        report.Set("mlock", env.Null());
+    }
+    return report;
+}
+} // namespace
+
+ThreadPolicyScope::ThreadPolicyScope(const char* name) {
+    TraceThreadName(name);
+    std::lock_guard<std::mutex> lock(policyMutex);
+    id_ = nextThreadId++;
+#if defined(__linux__)
+    ownedThreads.emplace(id_, OwnedThread{name, pthread_self()});
+    if (policySet) {
+        ApplyPolicy(pthread_self(), currentPolicy);
+    }
+#else
+    ownedThreads.emplace(id_, OwnedThread{name});
+#endif
+}
+
+ThreadPolicyScope::~ThreadPolicyScope() {
+    // Unregistering under the lock keeps setThreadPolicy() from touching a
+    // thread that has exited.
+    std::lock_guard<std::mutex> lock(policyMutex);
+    ownedThreads.erase(id_);
+}
+
+void RegisterThreadPolicyExecutor(const std::string& name, ThreadPolicyExecutor executor) {
+    std::lock_guard<std::mutex> lock(policyMutex);
+#if defined(__linux__)
+    if (policySet) {
+        const auto policy = currentPolicy;
+        if (!executor([policy]() { ApplyPolicy(pthread_self(), policy); })) {
+            return;
+        }
+    }
+#endif
+    executors.emplace(nextThreadId++, std::make_pair(name, std::move(executor)));
+}
+
+Napi::Object InitAbletonLinkThreadPolicy(Napi::Env env, Napi::Object exports) {
+    exports.Set("setThreadPolicy", Napi::Function::New(env, SetThreadPolicy, "setThreadPolicy"));
+    return exports;
+}
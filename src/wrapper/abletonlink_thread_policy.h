@@ -0,0 +1,34 @@
+#ifndef ABLETONLINK_THREAD_POLICY_H
+#define ABLETONLINK_THREAD_POLICY_H
+
+#include <napi.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Scheduling policy for the addon's native threads, set process-wide with
+// setThreadPolicy(). Only applied on Linux; elsewhere it is reported as
+// unsupported.
+//
+// Threads owned by the addon create a ThreadPolicyScope when they start. The
+// current policy is applied to them immediately and again whenever it changes.
+class ThreadPolicyScope {
+public:
+    explicit ThreadPolicyScope(const char* name);
+    ~ThreadPolicyScope();
+    ThreadPolicyScope(const ThreadPolicyScope&) = delete;
+    ThreadPolicyScope& operator=(const ThreadPolicyScope&) = delete;
+
+private:
+    uint64_t id_ = 0;
+};
+
+// Threads the addon does not create (Link's own thread) are reached through an
+// executor that runs a function on them. The executor returns false once the
+// thread is gone, which drops it from the registry.
+using ThreadPolicyExecutor = std::function<bool(std::function<void()>)>;
+void RegisterThreadPolicyExecutor(const std::string& name, ThreadPolicyExecutor executor);
+
+Napi::Object InitAbletonLinkThreadPolicy(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_THREAD_POLICY_H
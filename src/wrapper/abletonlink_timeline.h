@@ -0,0 +1,93 @@
+#ifndef ABLETONLINK_TIMELINE_H
+#define ABLETONLINK_TIMELINE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#endif
+
+// Session timeline view owned by a single native worker thread. Capture()
+// snapshots the app session state into storage private to the instance, so
+// each thread can query the timeline without touching the JS thread's state.
+class LinkTimeline {
+public:
+    virtual ~LinkTimeline() = default;
+
+    virtual std::chrono::microseconds Now() const = 0;
+    virtual void Capture() = 0;
+    virtual double Tempo() const = 0;
+    virtual double BeatAtTime(std::chrono::microseconds time, double quantum) const = 0;
+    virtual std::chrono::microseconds TimeAtBeat(double beat, double quantum) const = 0;
+    virtual bool IsPlaying() const = 0;
+    virtual std::chrono::microseconds TimeForIsPlaying() const = 0;
+    virtual std::size_t NumPeers() const = 0;
+};
+
+// Close notifications for native objects (schedulers, worker threads) that
+// depend on a Link instance. The owning wrapper runs them before the Link
+// instance is destroyed so no thread outlives it.
+class LinkDependents {
+public:
+    uint64_t Add(std::function<void()> onClose) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto id = nextId_++;
+        callbacks_.emplace(id, std::move(onClose));
+        return id;
+    }
+
+    void Remove(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callbacks_.erase(id);
+    }
+
+    void CloseAll() {
+        std::unordered_map<uint64_t, std::function<void()>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            callbacks.swap(callbacks_);
+        }
+        for (auto& entry : callbacks) {
+            entry.second();
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, std::function<void()>> callbacks_;
+    uint64_t nextId_ = 1;
+};
+
+// Sleeps until the Link clock reaches target. On Linux this uses an absolute
+// clock_nanosleep on CLOCK_MONOTONIC, re-checking the Link clock after each
+// wake so small rate differences between the two clocks cannot fire early.
+inline void SleepUntilLinkTime(const LinkTimeline& timeline,
+                               std::chrono::microseconds target) {
+    for (;;) {
+        const auto remaining = target - timeline.Now();
+        if (remaining.count() <= 0) {
+            return;
+        }
+#if defined(__linux__)
+        timespec deadline{};
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        const auto nanos = static_cast<int64_t>(deadline.tv_nsec) +
+                           static_cast<int64_t>(remaining.count()) * 1000;
+        deadline.tv_sec += static_cast<time_t>(nanos / 1000000000);
+        deadline.tv_nsec = static_cast<long>(nanos % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) ==
+               EINTR) {
+        }
+#else
+        std::this_thread::sleep_for(remaining);
+#endif
+    }
+}
+
+#endif // ABLETONLINK_TIMELINE_H
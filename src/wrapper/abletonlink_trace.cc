@@ -0,0 +1,176 @@
+#include "abletonlink_trace.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> traceEnabled{false};
+
+namespace {
+// Events kept per thread; older ones are overwritten. 40 bytes each.
+constexpr uint64_t kEventsPerThread = 1 << 15;
+
+struct TraceEvent {
+    const char* category;
+    const char* name;
+    uint64_t ts;
+    uint64_t dur;
+    char phase;
+};
+static_assert(sizeof(TraceEvent) <= 40, "TraceEvent grew; update the comment above");
+
+// Single producer (the owning thread), read by dumpTrace() on the JS thread.
+struct TraceRing {
+    TraceRing(uint32_t tid, const char* name) : tid(tid), name(name), events(kEventsPerThread) {}
+
+    const uint32_t tid;
+    std::atomic<const char*> name;
+    std::vector<TraceEvent> events;
+    // Number of events ever written; only the owning thread stores it.
+    std::atomic<uint64_t> head{0};
+    // Value of head when the current capture started.
+    std::atomic<uint64_t> start{0};
+};
+
+std::mutex ringsMutex;
+std::vector<std::shared_ptr<TraceRing>> rings;
+uint32_t nextTid = 1;
+
+thread_local std::shared_ptr<TraceRing> threadRing;
+thread_local const char* threadName = nullptr;
+
+// The first event on a thread registers its ring under ringsMutex; every later
+// event is lock-free.
+TraceRing& ThreadRing() {
+    if (!threadRing) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        threadRing = std::make_shared<TraceRing>(nextTid++, threadName);
+        rings.push_back(threadRing);
+    }
+    return *threadRing;
+}
+
+void AppendEscaped(std::string& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+        }
+        out += *c;
+    }
+    out += '"';
+}
+
+Napi::Value StartTrace(const Napi::CallbackInfo& info) {
+    TraceThreadName("js");
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        // Drop rings of threads that have exited; the others start empty.
+        std::vector<std::shared_ptr<TraceRing>> live;
+        for (auto& ring : rings) {
+            if (ring.use_count() > 1) {
+                ring->start.store(ring->head.load(std::memory_order_acquire),
+                                  std::memory_order_relaxed);
+                live.push_back(ring);
+            }
+        }
+        rings.swap(live);
+    }
+    traceEnabled.store(true, std::memory_order_release);
+    return info.Env().Undefined();
+}
+
+Napi::Value StopTrace(const Napi::CallbackInfo& info) {
+    traceEnabled.store(false, std::memory_order_release);
+    return info.Env().Undefined();
+}
+
+// Events overwritten while they were being copied are discarded, so dumping
+// during a capture is safe but may lose the oldest events of busy threads.
+Napi::Value DumpTrace(const Napi::CallbackInfo& info) {
+    std::vector<std::shared_ptr<TraceRing>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        snapshot = rings;
+    }
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    const auto separator = [&]() {
+        if (!first) {
+            json += ',';
+        }
+        first = false;
+    };
+    std::vector<TraceEvent> copy;
+    for (const auto& ring : snapshot) {
+        const auto tid = std::to_string(ring->tid);
+        const char* name = ring->name.load(std::memory_order_relaxed);
+        separator();
+        json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid +
+                ",\"args\":{\"name\":";
+        AppendEscaped(json, name != nullptr ? name : ("thread-" + tid).c_str());
+        json += "}}";
+
+        const auto head = ring->head.load(std::memory_order_acquire);
+        auto begin = ring->start.load(std::memory_order_relaxed);
+        if (head - begin > kEventsPerThread) {
+            begin = head - kEventsPerThread;
+        }
+        copy.clear();
+        for (auto i = begin; i < head; ++i) {
+            copy.push_back(ring->events[i % kEventsPerThread]);
+        }
+        // The writer may be overwriting slot `after` during the copy; after a
+        // wrap that slot held event after - kEventsPerThread, so keep only the
+        // newer ones.
+        const auto after = ring->head.load(std::memory_order_acquire);
+        const auto valid = after >= kEventsPerThread ? after - kEventsPerThread + 1 : 0;
+
+        for (uint64_t i = 0; i < copy.size(); ++i) {
+            if (begin + i < valid) {
+                continue;
+            }
+            const auto& event = copy[i];
+            separator();
+            json += "{\"name\":";
+            AppendEscaped(json, event.name);
+            json += ",\"cat\":";
+            AppendEscaped(json, event.category);
+            json += ",\"ph\":\"";
+            json += event.phase;
+            json += "\",\"ts\":" + std::to_string(event.ts);
+            if (event.phase == 'X') {
+                json += ",\"dur\":" + std::to_string(event.dur);
+            } else {
+                json += ",\"s\":\"t\"";
+            }
+            json += ",\"pid\":1,\"tid\":" + tid + "}";
+        }
+    }
+    json += "]}";
+    return Napi::String::New(info.Env(), json);
+}
+} // namespace
+
+void TraceRecord(char phase, const char* category, const char* name, uint64_t ts, uint64_t dur) {
+    auto& ring = ThreadRing();
+    const auto index = ring.head.load(std::memory_order_relaxed);
+    ring.events[index % kEventsPerThread] = TraceEvent{category, name, ts, dur, phase};
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+void TraceThreadName(const char* name) {
+    threadName = name;
+    if (threadRing) {
+        threadRing->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+Napi::Object InitAbletonLinkTrace(Napi::Env env, Napi::Object exports) {
+    exports.Set("startTrace", Napi::Function::New(env, StartTrace, "startTrace"));
+    exports.Set("stopTrace", Napi::Function::New(env, StopTrace, "stopTrace"));
+    exports.Set("dumpTrace", Napi::Function::New(env, DumpTrace, "dumpTrace"));
+    return exports;
+}
@@ -0,0 +1,68 @@
+#ifndef ABLETONLINK_TRACE_H
+#define ABLETONLINK_TRACE_H
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Opt-in span/instant recording for the native hot paths, exported as Chrome
+// trace event JSON (startTrace/stopTrace/dumpTrace). Each thread appends to
+// its own fixed-size ring, so recording never takes a lock once the thread's
+// ring exists; with tracing off every hook is one relaxed load.
+//
+// Categories and names are stored by pointer and must be string literals.
+
+extern std::atomic<bool> traceEnabled;
+
+inline bool TraceEnabled() {
+    return traceEnabled.load(std::memory_order_relaxed);
+}
+
+// Trace timestamps, in microseconds of the steady clock.
+inline uint64_t TraceNowMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+void TraceRecord(char phase, const char* category, const char* name, uint64_t ts, uint64_t dur);
+
+inline void TraceInstant(const char* category, const char* name) {
+    if (TraceEnabled()) {
+        TraceRecord('i', category, name, TraceNowMicros(), 0);
+    }
+}
+
+inline void TraceComplete(const char* category, const char* name, uint64_t begin, uint64_t end) {
+    if (TraceEnabled()) {
+        TraceRecord('X', category, name, begin, end > begin ? end - begin : 0);
+    }
+}
+
+// Names the calling thread in dumps; threads default to "thread-<n>".
+void TraceThreadName(const char* name);
+
+// Records a complete event covering its lifetime when tracing was on at
+// construction.
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name)
+        : category_(category), name_(name), begin_(TraceEnabled() ? TraceNowMicros() : 0) {}
+    ~TraceSpan() {
+        if (begin_ != 0) {
+            TraceComplete(category_, name_, begin_, TraceNowMicros());
+        }
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* category_;
+    const char* name_;
+    uint64_t begin_;
+};
+
+Napi::Object InitAbletonLinkTrace(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_TRACE_H
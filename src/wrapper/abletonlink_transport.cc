@@ -0,0 +1,332 @@
+#include "abletonlink_transport.h"
+#include "abletonlink_addon.h"
+#include "abletonlink_audio.h"
+#include "abletonlink_thread_policy.h"
+#include "abletonlink_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+// Tolerance when snapping a start beat to the quantum grid, so a start that
+// lands on a boundary up to rounding error does not skip a whole quantum.
+constexpr double kBeatEpsilon = 1e-6;
+
+constexpr std::chrono::microseconds kNeverStop{std::numeric_limits<long long>::max()};
+} // namespace
+
+Napi::Object AbletonLinkAudioTransportWrapper::Init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "AbletonLinkAudioTransport", {
+        InstanceMethod("setClip", &AbletonLinkAudioTransportWrapper::SetClip),
+        InstanceMethod("start", &AbletonLinkAudioTransportWrapper::Start),
+        InstanceMethod("stop", &AbletonLinkAudioTransportWrapper::Stop),
+        InstanceMethod("status", &AbletonLinkAudioTransportWrapper::Status),
+        InstanceMethod("close", &AbletonLinkAudioTransportWrapper::Close),
+    });
+
+    AddonData(env).transport = Napi::Persistent(func);
+    exports.Set("AbletonLinkAudioTransport", func);
+    return exports;
+}
+
+AbletonLinkAudioTransportWrapper::AbletonLinkAudioTransportWrapper(
+    const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<AbletonLinkAudioTransportWrapper>(info) {
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
+        Napi::TypeError::New(info.Env(), "LinkAudio instance and sink expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto linkObject = info[0].As<Napi::Object>();
+    auto sinkObject = info[1].As<Napi::Object>();
+    if (!AbletonLinkAudioWrapper::IsInstance(linkObject) ||
+        !AbletonLinkAudioSinkWrapper::IsInstance(sinkObject)) {
+        Napi::TypeError::New(info.Env(), "AbletonLinkAudio and AbletonLinkAudioSink expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto* sinkWrapper = Napi::ObjectWrap<AbletonLinkAudioSinkWrapper>::Unwrap(sinkObject);
+    if (!sinkWrapper->Sink()) {
+        Napi::Error::New(info.Env(), "Sink is closed").ThrowAsJavaScriptException();
+        return;
+    }
+    auto* link = Napi::ObjectWrap<AbletonLinkAudioWrapper>::Unwrap(linkObject);
+    timeline_ = link->CreateTimeline();
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "AbletonLinkAudio is closed")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    link_ = &link->LinkAudio();
+    sink_ = sinkWrapper->Sink();
+    sinkStats_ = sinkWrapper->Stats();
+    state_ = std::make_unique<ableton::LinkAudio::SessionState>(
+        link_->captureAppSessionState());
+
+    if (info.Length() > 2 && info[2].IsObject()) {
+        auto options = info[2].As<Napi::Object>();
+        if (options.Get("quantum").IsNumber()) {
+            quantum_ = options.Get("quantum").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("framesPerBuffer").IsNumber()) {
+            framesPerBuffer_ = std::max<std::size_t>(
+                1, options.Get("framesPerBuffer").As<Napi::Number>().Uint32Value());
+        }
+        if (options.Get("leadMs").IsNumber()) {
+            const auto leadMs = options.Get("leadMs").As<Napi::Number>().DoubleValue();
+            lead_ = std::chrono::microseconds(
+                static_cast<long long>(std::max(0.0, leadMs) * 1000.0));
+        }
+        if (options.Get("loop").IsBoolean()) {
+            loop_ = options.Get("loop").As<Napi::Boolean>().Value();
+        }
+    }
+    if (!(quantum_ > 0.0)) {
+        Napi::TypeError::New(info.Env(), "Quantum must be positive")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    linkRef_ = Napi::Persistent(linkObject);
+    linkRef_.SuppressDestruct();
+    sinkRef_ = Napi::Persistent(sinkObject);
+    sinkRef_.SuppressDestruct();
+
+    // The render thread must stop before the LinkAudio instance is destroyed.
+    dependents_ = &link->Dependents();
+    dependentId_ = dependents_->Add([this]() {
+        dependents_ = nullptr;
+        CloseInternal();
+    });
+}
+
+AbletonLinkAudioTransportWrapper::~AbletonLinkAudioTransportWrapper() {
+    CloseInternal();
+}
+
+void AbletonLinkAudioTransportWrapper::SetClip(const Napi::CallbackInfo& info) {
+    if (info.Length() < 3 || !info[0].IsTypedArray() || !info[1].IsNumber() ||
+        !info[2].IsNumber() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_int16_array) {
+        Napi::TypeError::New(info.Env(),
+                             "Int16Array samples, numChannels, and sampleRate expected")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto samples = info[0].As<Napi::Int16Array>();
+    auto clip = std::make_shared<Clip>();
+    clip->numChannels = info[1].As<Napi::Number>().Uint32Value();
+    clip->sampleRate = info[2].As<Napi::Number>().Uint32Value();
+    if (clip->numChannels == 0 || clip->sampleRate == 0 ||
+        samples.ElementLength() < clip->numChannels) {
+        Napi::TypeError::New(info.Env(), "Clip must hold at least one frame")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    clip->numFrames = samples.ElementLength() / clip->numChannels;
+    clip->samples.assign(samples.Data(),
+                         samples.Data() + clip->numFrames * clip->numChannels);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clip_ = std::move(clip);
+    }
+    wake_.notify_one();
+}
+
+void AbletonLinkAudioTransportWrapper::Start(const Napi::CallbackInfo& info) {
+    if (!timeline_) {
+        Napi::Error::New(info.Env(), "Transport is closed").ThrowAsJavaScriptException();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return;
+        }
+        running_ = true;
+        armed_ = false;
+        launchTime_ = std::chrono::microseconds{0};
+        stopTime_ = std::chrono::microseconds{0};
+    }
+    thread_ = std::thread([this]() { Run(); });
+}
+
+void AbletonLinkAudioTransportWrapper::Stop(const Napi::CallbackInfo& info) {
+    StopThread();
+}
+
+Napi::Value AbletonLinkAudioTransportWrapper::Status(const Napi::CallbackInfo& info) {
+    auto obj = Napi::Object::New(info.Env());
+    std::lock_guard<std::mutex> lock(mutex_);
+    obj.Set("running", running_);
+    obj.Set("playing", armed_);
+    obj.Set("launchBeat", launchBeat_);
+    obj.Set("launchTime", launchTime_.count() / 1000000.0);
+    if (stopTime_ == kNeverStop) {
+        obj.Set("stopTime", info.Env().Null());
+    } else {
+        obj.Set("stopTime", stopTime_.count() / 1000000.0);
+    }
+    obj.Set("framesCommitted", static_cast<double>(framesCommitted_));
+    obj.Set("buffersDropped", static_cast<double>(buffersDropped_));
+    return obj;
+}
+
+void AbletonLinkAudioTransportWrapper::Close(const Napi::CallbackInfo& info) {
+    CloseInternal();
+}
+
+void AbletonLinkAudioTransportWrapper::Run() {
+    ThreadPolicyScope policy("transport");
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool synced = false;
+    while (running_) {
+        if (!clip_) {
+            synced = false;
+            wake_.wait(lock);
+            continue;
+        }
+        auto clip = clip_;
+
+        const auto frameMicros = 1000000.0 / clip->sampleRate;
+        const auto now = static_cast<double>(timeline_->Now().count());
+        if (!synced || bufferTime_ < now - framesPerBuffer_ * frameMicros) {
+            // First buffer, or the thread fell behind: restart the stream one
+            // lead ahead of the clock. Clip positions follow from launchTime_.
+            bufferTime_ = now + lead_.count();
+            synced = true;
+        }
+
+        const auto ahead = bufferTime_ - now;
+        if (ahead > lead_.count()) {
+            wake_.wait_for(lock, std::chrono::microseconds(
+                                     static_cast<long long>(ahead - lead_.count())));
+            continue;
+        }
+        RenderBuffer(*clip);
+    }
+}
+
+void AbletonLinkAudioTransportWrapper::UpdatePlayState(
+    std::chrono::microseconds bufferBegin) {
+    // Called with mutex_ held on the render thread.
+    const bool playing = state_->isPlaying();
+    if (playing && !armed_) {
+        // Launch on the first quantum boundary at or after the session start
+        // that is still ahead of the audio already committed.
+        const auto startTime = std::max(state_->timeForIsPlaying(), bufferBegin);
+        const auto startBeat = state_->beatAtTime(startTime, quantum_);
+        launchBeat_ = std::ceil(startBeat / quantum_ - kBeatEpsilon) * quantum_;
+        launchTime_ = state_->timeAtBeat(launchBeat_, quantum_);
+        stopTime_ = kNeverStop;
+        armed_ = true;
+    } else if (!playing && armed_) {
+        stopTime_ = state_->timeForIsPlaying();
+        armed_ = false;
+    }
+}
+
+void AbletonLinkAudioTransportWrapper::RenderBuffer(const Clip& clip) {
+    // Called with mutex_ held on the render thread.
+    TraceSpan span("transport", "render");
+    *state_ = link_->captureAppSessionState();
+    const auto frameMicros = 1000000.0 / clip.sampleRate;
+    const auto beginMicros = bufferTime_;
+    const auto bufferBegin =
+        std::chrono::microseconds(static_cast<long long>(std::llround(beginMicros)));
+    UpdatePlayState(bufferBegin);
+    bufferTime_ += framesPerBuffer_ * frameMicros;
+
+    ableton::LinkAudioSink::BufferHandle handle(*sink_);
+    sinkStats_->Retained(static_cast<bool>(handle));
+    const auto numFrames =
+        handle ? std::min(framesPerBuffer_, handle.maxNumSamples / clip.numChannels) : 0;
+    if (numFrames == 0) {
+        ++buffersDropped_;
+        return;
+    }
+
+    // Frame offsets, relative to this buffer, of the launch and stop samples.
+    const auto firstFrame = static_cast<long long>(
+        std::ceil((launchTime_.count() - beginMicros) / frameMicros));
+    const auto endFrame =
+        stopTime_ == kNeverStop
+            ? std::numeric_limits<long long>::max()
+            : static_cast<long long>(std::ceil((stopTime_.count() - beginMicros) / frameMicros));
+
+    auto* out = handle.samples;
+    const auto channels = clip.numChannels;
+    for (std::size_t i = 0; i < numFrames; ++i) {
+        const auto frame = static_cast<long long>(i);
+        auto* dst = out + i * channels;
+        if (frame < firstFrame || frame >= endFrame) {
+            std::memset(dst, 0, channels * sizeof(int16_t));
+            continue;
+        }
+        auto position = static_cast<std::size_t>(frame - firstFrame);
+        if (loop_) {
+            position %= clip.numFrames;
+        } else if (position >= clip.numFrames) {
+            std::memset(dst, 0, channels * sizeof(int16_t));
+            continue;
+        }
+        std::memcpy(dst, clip.samples.data() + position * channels,
+                    channels * sizeof(int16_t));
+    }
+
+    const auto beatsAtBufferBegin = state_->beatAtTime(bufferBegin, quantum_);
+    const auto committed = handle.commit(*state_, beatsAtBufferBegin, quantum_, numFrames,
+                                         channels, clip.sampleRate);
+    sinkStats_->Committed(committed, numFrames * channels * sizeof(int16_t));
+    if (committed) {
+        framesCommitted_ += numFrames;
+    } else {
+        ++buffersDropped_;
+    }
+}
+
+void AbletonLinkAudioTransportWrapper::StopThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void AbletonLinkAudioTransportWrapper::CloseInternal() {
+    StopThread();
+    if (dependents_) {
+        dependents_->Remove(dependentId_);
+        dependents_ = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clip_.reset();
+    }
+    sink_.reset();
+    sinkStats_.reset();
+    state_.reset();
+    timeline_.reset();
+    link_ = nullptr;
+    sinkRef_.Reset();
+    linkRef_.Reset();
+}
+
+Napi::Object InitAbletonLinkTransport(Napi::Env env, Napi::Object exports) {
+    AbletonLinkAudioTransportWrapper::Init(env, exports);
+    return exports;
+}
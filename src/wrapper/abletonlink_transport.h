@@ -0,0 +1,82 @@
+#ifndef ABLETONLINK_TRANSPORT_H
+#define ABLETONLINK_TRANSPORT_H
+
+#include "abletonlink_stats.h"
+#include "abletonlink_timeline.h"
+#include <napi.h>
+#include <ableton/LinkAudio.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Quantized clip transport for a LinkAudio sink. A render thread keeps the
+// sink fed `lead` ahead of the Link clock and follows the session's play
+// state: when the session starts, the clip begins at the exact sample of the
+// next quantum boundary; when it stops, output is silenced from the sample at
+// which the session stops.
+class AbletonLinkAudioTransportWrapper
+    : public Napi::ObjectWrap<AbletonLinkAudioTransportWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    AbletonLinkAudioTransportWrapper(const Napi::CallbackInfo& info);
+    ~AbletonLinkAudioTransportWrapper();
+
+private:
+    struct Clip {
+        std::vector<int16_t> samples;
+        std::size_t numChannels = 0;
+        std::size_t numFrames = 0;
+        uint32_t sampleRate = 0;
+    };
+
+    void SetClip(const Napi::CallbackInfo& info);
+    void Start(const Napi::CallbackInfo& info);
+    void Stop(const Napi::CallbackInfo& info);
+    Napi::Value Status(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void Run();
+    void RenderBuffer(const Clip& clip);
+    void UpdatePlayState(std::chrono::microseconds bufferBegin);
+    void StopThread();
+    void CloseInternal();
+
+    ableton::LinkAudio* link_ = nullptr;
+    std::shared_ptr<ableton::LinkAudioSink> sink_;
+    std::shared_ptr<SinkStats> sinkStats_;
+    std::unique_ptr<LinkTimeline> timeline_;
+    double quantum_ = 4.0;
+    std::size_t framesPerBuffer_ = 512;
+    std::chrono::microseconds lead_{20000};
+    bool loop_ = true;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::shared_ptr<const Clip> clip_;
+    bool running_ = false;
+    std::thread thread_;
+
+    // Render thread state, guarded by mutex_. bufferTime_ is the Link time of
+    // the next buffer's first frame in fractional microseconds, so it advances
+    // by exact frame durations and clip positions can be derived from it.
+    std::unique_ptr<ableton::LinkAudio::SessionState> state_;
+    double bufferTime_ = 0.0;
+    bool armed_ = false;
+    double launchBeat_ = 0.0;
+    std::chrono::microseconds launchTime_{0};
+    std::chrono::microseconds stopTime_{0};
+    uint64_t framesCommitted_ = 0;
+    uint64_t buffersDropped_ = 0;
+
+    Napi::ObjectReference linkRef_;
+    Napi::ObjectReference sinkRef_;
+    LinkDependents* dependents_ = nullptr;
+    uint64_t dependentId_ = 0;
+};
+
+Napi::Object InitAbletonLinkTransport(Napi::Env env, Napi::Object exports);
+
+#endif // ABLETONLINK_TRANSPORT_H
@@ -1,4 +1,22 @@
-import { AbletonLink } from '../index.ts';
+import {
+  closeSync,
+  constants,
+  existsSync,
+  openSync,
+  readFileSync,
+  unlinkSync,
+  writeFileSync,
+  writeSync,
+} from 'fs';
+import { execFileSync } from 'child_process';
+import { tmpdir } from 'os';
+import path from 'path';
+import {
+  AbletonLink,
+  AbletonLinkMidiClock,
+  AbletonLinkStatePublisher,
+  MidiClockStatus,
+} from '../index.ts';
 
 describe('AbletonLink', () => {
   let link: any;
@@ -38,6 +56,21 @@ describe('AbletonLink', () => {
     expect(typeof phase).toBe('number');
   });
 
+  test('should get a consistent state snapshot', () => {
+    const state = link.getState(4.0);
+    expect(state.tempo).toBe(120.0);
+    expect(typeof state.beat).toBe('number');
+    expect(state.phase).toBeGreaterThanOrEqual(0);
+    expect(state.phase).toBeLessThan(4.0);
+    expect(typeof state.peers).toBe('number');
+    expect(state.playing).toBe(false);
+
+    const out = new Float64Array(5);
+    expect(link.getState(4.0, out)).toBe(out);
+    expect(out[0]).toBe(120.0);
+    expect(() => link.getState(4.0, new Float64Array(2))).toThrow();
+  });
+
   test('should get number of peers', () => {
     const peers = link.getNumPeers();
     expect(typeof peers).toBe('number');
@@ -62,6 +95,23 @@ describe('AbletonLink', () => {
     link.setStartStopCallback(() => {});
   });
 
+  test('should coalesce tempo callbacks to the latest value', async () => {
+    const calls: Array<[number, number]> = [];
+    link.setTempoCallback((tempo: number, changes: number) => calls.push([tempo, changes]), {
+      coalesce: true,
+    });
+    for (let bpm = 121; bpm <= 180; bpm += 1) {
+      link.setTempo(bpm);
+    }
+    const total = () => calls.reduce((sum, [, changes]) => sum + changes, 0);
+    for (let waited = 0; total() < 60 && waited < 1000; waited += 10) {
+      await new Promise((resolve) => setTimeout(resolve, 10));
+    }
+    expect(calls.length).toBeGreaterThanOrEqual(1);
+    expect(calls[calls.length - 1][0]).toBe(180);
+    expect(total()).toBe(60);
+  });
+
   test('should handle quantized methods', () => {
     const quantum = 4.0;
     const beat = link.getBeat();
@@ -70,6 +120,133 @@ describe('AbletonLink', () => {
     expect(typeof phase).toBe('number');
   });
 
+  test('should emit MIDI clock pulses on the beat grid', async () => {
+    const events: number[] = [];
+    const clock = new AbletonLinkMidiClock(link, (batch: Float64Array) => {
+      events.push(...batch);
+    });
+    clock.start();
+    await new Promise((resolve) => setTimeout(resolve, 100));
+    clock.close();
+
+    expect(events.length).toBeGreaterThanOrEqual(3 * 3);
+    for (let i = 0; i < events.length; i += 3) {
+      expect(events[i + 1]).toBe(MidiClockStatus.clock);
+    }
+    // At 120 BPM, 24 PPQN pulses are 1/48 s apart.
+    expect(events[3] - events[0]).toBeCloseTo(1 / 48, 4);
+  });
+
+  (process.platform === 'linux' ? test : test.skip)(
+    'should drop MIDI bytes instead of blocking on a full FIFO',
+    async () => {
+      const fifo = path.join(tmpdir(), `abletonlink-midi-${process.pid}`);
+      execFileSync('mkfifo', [fifo]);
+      // O_RDWR keeps the FIFO open without a reader; fill it before the clock starts.
+      const fd = openSync(fifo, constants.O_RDWR | constants.O_NONBLOCK);
+      for (const size of [4096, 1]) {
+        try {
+          for (;;) writeSync(fd, Buffer.alloc(size));
+        } catch (error: any) {
+          expect(error.code).toBe('EAGAIN');
+        }
+      }
+
+      const clock = new AbletonLinkMidiClock(link, null, { fd });
+      clock.start();
+      await new Promise((resolve) => setTimeout(resolve, 100));
+      const started = Date.now();
+      clock.stop();
+      expect(Date.now() - started).toBeLessThan(50);
+      const status = clock.status();
+      clock.close();
+      closeSync(fd);
+      unlinkSync(fifo);
+
+      expect(status.written).toBe(0);
+      expect(status.dropped).toBeGreaterThan(0);
+    }
+  );
+
+  (process.platform === 'linux' ? test : test.skip)(
+    'should publish Link state to shared memory',
+    () => {
+      const name = `/abletonlink-test-${process.pid}`;
+      const publisher = new AbletonLinkStatePublisher(link, name);
+      const segment = readFileSync(`/dev/shm${name}`);
+      expect(segment.length).toBe(128);
+      expect(segment.toString('latin1', 0, 4)).toBe('LKSM');
+      expect(segment.readBigUInt64LE(16) % 2n).toBe(0n);
+      expect(segment.readDoubleLE(40)).toBeCloseTo(120, 6);
+      expect(segment.readDoubleLE(56)).toBe(4);
+      expect(segment.readUInt32LE(80)).toBe(1);
+      expect(publisher.status().name).toBe(name);
+      expect(() => new AbletonLinkStatePublisher(link, name)).toThrow('in use');
+
+      publisher.close();
+      expect(existsSync(`/dev/shm${name}`)).toBe(false);
+    }
+  );
+
+  (process.platform === 'linux' ? test : test.skip)(
+    'should read shared memory with the C99 reader',
+    () => {
+      const name = `/abletonlink-c99-${process.pid}`;
+      const source = path.join(tmpdir(), `abletonlink-c99-${process.pid}.c`);
+      const binary = path.join(tmpdir(), `abletonlink-c99-${process.pid}`);
+      writeFileSync(
+        source,
+        [
+          '#include <abletonlink_shm.h>',
+          '#include <stdio.h>',
+          'int main(int argc, char** argv) {',
+          '    const lkshm_state* shm = lkshm_open(argc > 1 ? argv[1] : "");',
+          '    lkshm_snapshot s;',
+          '    int result;',
+          '    if (!shm) {',
+          '        return 2;',
+          '    }',
+          '    result = lkshm_read(shm, &s);',
+          '    printf("%d %.6f %.1f %lld\\n", result, s.tempo, s.quantum,',
+          '           (long long)lkshm_age_us(&s));',
+          '    lkshm_close(shm);',
+          '    return 0;',
+          '}',
+          '',
+        ].join('\n')
+      );
+      execFileSync('cc', [
+        '-std=c99',
+        '-pedantic',
+        '-Wall',
+        '-Werror',
+        '-I',
+        path.join(process.cwd(), 'include'),
+        source,
+        '-o',
+        binary,
+      ]);
+
+      const publisher = new AbletonLinkStatePublisher(link, name, { quantum: 8 });
+      try {
+        const [result, tempo, quantum, age] = execFileSync(binary, [name])
+          .toString()
+          .trim()
+          .split(' ')
+          .map(Number);
+        expect(result).toBe(0);
+        expect(tempo).toBeCloseTo(120, 6);
+        expect(quantum).toBe(8);
+        expect(age).toBeGreaterThanOrEqual(0);
+        expect(age).toBeLessThan(1000000);
+      } finally {
+        publisher.close();
+        unlinkSync(source);
+        unlinkSync(binary);
+      }
+    }
+  );
+
   test('should force beat at time', () => {
     const time = typeof link.getClockTime === 'function' ? link.getClockTime() : Date.now() / 1000;
     link.forceBeatAtTime(4.0, time, 4.0);
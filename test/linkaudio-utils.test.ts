@@ -1,5 +1,5 @@
 import path from 'path';
-import { AbletonLinkAudio, linkAudioUtils } from '../index.ts';
+import { AbletonLinkAudio, decodeAudio, estimateTempo, linkAudioUtils } from '../index.ts';
 
 describe('linkAudioUtils', () => {
   let link: any;
@@ -57,6 +57,60 @@ describe('linkAudioUtils', () => {
     expect(typeof fired).toBe('boolean');
   });
 
+  test('NativeLinkTimeScheduler fires events on the Link clock', async () => {
+    const scheduler = new linkAudioUtils.NativeLinkTimeScheduler(link, { coarseMs: 1 });
+    scheduler.start();
+    const target = scheduler.now() + 0.005;
+    const firedAt = await new Promise<number>((resolve) => {
+      scheduler.scheduleAt(target, () => resolve(link.getClockTime()));
+    });
+    let cancelledFired = false;
+    scheduler.scheduleIn(0.001, () => {
+      cancelledFired = true;
+    }).cancel();
+    await new Promise((resolve) => setTimeout(resolve, 10));
+    scheduler.close();
+    expect(firedAt).toBeGreaterThanOrEqual(target);
+    expect(cancelledFired).toBe(false);
+  });
+
+  test('NativeLinkTimeScheduler fires beat-domain events', async () => {
+    const scheduler = new linkAudioUtils.NativeLinkTimeScheduler(link, { coarseMs: 1 });
+    scheduler.start();
+    const state = link.getState(1.0);
+    const target = Math.ceil(state.beat) + 1;
+    const fired = await new Promise<{ time: number; beat: number }>((resolve) => {
+      scheduler.scheduleAtBeat(target, 1.0, (time: number, beat: number) =>
+        resolve({ time, beat })
+      );
+    });
+    scheduler.close();
+    expect(fired.beat).toBe(target);
+    expect(fired.time).toBeCloseTo(link.getTimeForBeat(target, 1.0), 3);
+  });
+
+  test('NativeLinkTimeScheduler re-derives beat deadlines after a tempo change', async () => {
+    const scheduler = new linkAudioUtils.NativeLinkTimeScheduler(link, { coarseMs: 1 });
+    scheduler.start();
+    const target = Math.ceil(link.getState(1.0).beat) + 2;
+    const before = link.getTimeForBeat(target, 1.0);
+    const fired = new Promise<{ time: number; beat: number }>((resolve) => {
+      scheduler.scheduleAtBeat(target, 1.0, (time: number, beat: number) =>
+        resolve({ time, beat })
+      );
+    });
+    await new Promise((resolve) => setTimeout(resolve, 50));
+    link.setTempo(240.0);
+    const after = link.getTimeForBeat(target, 1.0);
+    const result = await fired;
+    scheduler.close();
+
+    // At 240 BPM the remaining beats take half as long.
+    expect(before - after).toBeGreaterThan(0.3);
+    expect(result.beat).toBe(target);
+    expect(result.time).toBeCloseTo(after, 3);
+  });
+
   test('createWavSinkPlayer supports resample mode', () => {
     link.enable(true);
     link.enableLinkAudio(true);
@@ -108,6 +162,93 @@ describe('linkAudioUtils', () => {
     expect(wav.samples).toBeInstanceOf(Int16Array);
   });
 
+  test('parseWav decodes float WAV and 24-bit AIFF natively', () => {
+    const wav = Buffer.alloc(44 + 16);
+    wav.write('RIFF', 0, 'ascii');
+    wav.writeUInt32LE(36 + 16, 4);
+    wav.write('WAVEfmt ', 8, 'ascii');
+    wav.writeUInt32LE(16, 16);
+    wav.writeUInt16LE(3, 20);
+    wav.writeUInt16LE(2, 22);
+    wav.writeUInt32LE(44100, 24);
+    wav.writeUInt32LE(44100 * 8, 28);
+    wav.writeUInt16LE(8, 32);
+    wav.writeUInt16LE(32, 34);
+    wav.write('data', 36, 'ascii');
+    wav.writeUInt32LE(16, 40);
+    [0, 0.5, -1, 1.5].forEach((v, i) => wav.writeFloatLE(v, 44 + i * 4));
+    const decodedWav = linkAudioUtils.parseWav(wav);
+    expect(decodedWav.numChannels).toBe(2);
+    expect(decodedWav.sampleRate).toBe(44100);
+    expect(Array.from(decodedWav.samples)).toEqual([0, 16384, -32767, 32767]);
+
+    const aiff = Buffer.alloc(12 + 26 + 16 + 9 + 1);
+    aiff.write('FORM', 0, 'ascii');
+    aiff.writeUInt32BE(aiff.length - 8, 4);
+    aiff.write('AIFFCOMM', 8, 'ascii');
+    aiff.writeUInt32BE(18, 16);
+    aiff.writeUInt16BE(1, 20);
+    aiff.writeUInt32BE(3, 22);
+    aiff.writeUInt16BE(24, 26);
+    Buffer.from([0x40, 0x0e, 0xbb, 0x80]).copy(aiff, 28);
+    aiff.write('SSND', 38, 'ascii');
+    aiff.writeUInt32BE(8 + 9, 42);
+    Buffer.from([0x7f, 0xff, 0xff, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00]).copy(aiff, 54);
+    const decodedAiff = decodeAudio(aiff);
+    expect(decodedAiff.container).toBe('aiff');
+    expect(decodedAiff.sampleRate).toBe(48000);
+    expect(Array.from(decodedAiff.samples)).toEqual([32767, -32768, 128]);
+  });
+
+  test('decodeAudio maps float NaN to silence in vector and tail positions', () => {
+    // 11 mono samples: the first 8 take the vector path, the rest the scalar tail.
+    const values = [NaN, 0.5, -1, NaN, 1.5, 0, -2, 0.25, NaN, 0.5, -1];
+    const wav = Buffer.alloc(44 + values.length * 4);
+    wav.write('RIFF', 0, 'ascii');
+    wav.writeUInt32LE(wav.length - 8, 4);
+    wav.write('WAVEfmt ', 8, 'ascii');
+    wav.writeUInt32LE(16, 16);
+    wav.writeUInt16LE(3, 20);
+    wav.writeUInt16LE(1, 22);
+    wav.writeUInt32LE(48000, 24);
+    wav.writeUInt32LE(48000 * 4, 28);
+    wav.writeUInt16LE(4, 32);
+    wav.writeUInt16LE(32, 34);
+    wav.write('data', 36, 'ascii');
+    wav.writeUInt32LE(values.length * 4, 40);
+    values.forEach((v, i) => wav.writeFloatLE(v, 44 + i * 4));
+    const decoded = decodeAudio(wav);
+    expect(Array.from(decoded.samples)).toEqual([
+      0, 16384, -32767, 0, 32767, 0, -32767, 8192, 0, 16384, -32767,
+    ]);
+  });
+
+  test('estimateTempo finds the tempo and beats of a click track', () => {
+    const sampleRate = 48000;
+    const firstClick = 0.1;
+    for (const bpm of [90, 120, 128, 140]) {
+      // 12 s of 10 ms decaying 1 kHz clicks, one per beat.
+      const samples = new Int16Array(sampleRate * 12);
+      const period = 60 / bpm;
+      for (let t = firstClick; t < 12; t += period) {
+        const start = Math.round(t * sampleRate);
+        for (let i = 0; i < 480 && start + i < samples.length; i++) {
+          samples[start + i] = Math.round(
+            20000 * Math.exp(-i / 96) * Math.sin((2 * Math.PI * 1000 * i) / sampleRate)
+          );
+        }
+      }
+      const estimate = estimateTempo(samples, 1, sampleRate);
+      expect(estimate.tempo).not.toBeNull();
+      expect(Math.abs(estimate.tempo! - bpm)).toBeLessThan(0.5);
+      expect(estimate.confidence).toBeGreaterThan(0.5);
+      const beats = (estimate.beatTime! - firstClick) / period;
+      expect(Math.abs(beats - Math.round(beats))).toBeLessThan(0.05);
+    }
+    expect(estimateTempo(new Int16Array(4800), 1, sampleRate).tempo).toBeNull();
+    expect(() => estimateTempo(new Int16Array(3), 2, sampleRate)).toThrow();
+  });
+
   test('waitForChannel times out when no channel exists', async () => {
     link.enable(true);
     link.enableLinkAudio(true);
@@ -1,7 +1,22 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { Worker } from 'worker_threads';
 import {
   AbletonLinkAudio,
+  AbletonLinkAudioArchivePlayer,
+  AbletonLinkAudioArchiveWriter,
+  AbletonLinkAudioMixBus,
   AbletonLinkAudioSink,
   AbletonLinkAudioSource,
+  AbletonLinkAudioSpectrumAnalyzer,
+  AbletonLinkAudioTempoTracker,
+  AbletonLinkAudioTransport,
+  LinkEventType,
+  dumpTrace,
+  setThreadPolicy,
+  startTrace,
+  stopTrace,
 } from '../index.ts';
 
 describe('AbletonLinkAudio', () => {
@@ -46,12 +61,98 @@ describe('AbletonLinkAudio', () => {
     expect(link.isLinkAudioEnabled()).toBe(false);
   });
 
+  test('should get a state snapshot', () => {
+    const state = link.getState(4.0);
+    expect(state.tempo).toBe(120.0);
+    expect(typeof state.playing).toBe('boolean');
+    const out = new Float64Array(5);
+    link.getState(4.0, out);
+    expect(out[0]).toBe(120.0);
+  });
+
+  test('should look up channels in the directory', () => {
+    const channels = link.channels();
+    expect(link.findChannels({})).toEqual(channels);
+    expect(link.findChannels({ name: 'no-such-channel' })).toEqual([]);
+    expect(link.findChannels({ peer: 'no-such-peer' })).toEqual([]);
+    expect(() => link.findChannels()).toThrow();
+  });
+
   test('should manage channels and callbacks', () => {
     link.setChannelsChangedCallback(() => {});
     const channels = link.channels();
     expect(Array.isArray(channels)).toBe(true);
   });
 
+  test('should report channel diffs when requested', async () => {
+    const diffs: any[] = [];
+    const waitForDiff = async (match: (diff: any) => boolean) => {
+      for (let waited = 0; waited < 5000; waited += 20) {
+        const found = diffs.find(match);
+        if (found) return found;
+        await new Promise((resolve) => setTimeout(resolve, 20));
+      }
+      throw new Error('Timed out waiting for channel diff');
+    };
+    link.setChannelsChangedCallback((diff: any) => diffs.push(diff), { diff: true });
+    link.enable(true);
+    link.enableLinkAudio(true);
+
+    const peer = new AbletonLinkAudio(120.0, 'diff-peer');
+    peer.enable(true);
+    peer.enableLinkAudio(true);
+    const sink = new AbletonLinkAudioSink(peer, 'diff-before', 1024);
+    try {
+      const added = await waitForDiff((d) => d.added.some((c: any) => c.name === 'diff-before'));
+      const id = added.added.find((c: any) => c.name === 'diff-before').id;
+
+      sink.setName('diff-after');
+      const renamed = await waitForDiff((d) => d.renamed.some((c: any) => c.id === id));
+      expect(renamed.renamed.find((c: any) => c.id === id).name).toBe('diff-after');
+      expect(renamed.added.some((c: any) => c.id === id)).toBe(false);
+    } finally {
+      peer.close();
+    }
+    const removed = await waitForDiff((d) => d.removed.some((c: any) => c.name === 'diff-after'));
+    expect(removed.removed.find((c: any) => c.name === 'diff-after').peerName).toBe('diff-peer');
+    link.setChannelsChangedCallback(() => {});
+  });
+
+  test('should deliver batched, timestamped events', async () => {
+    const events: number[] = [];
+    link.setEventCallback((batch: Float64Array) => events.push(...batch));
+    link.setTempo(133.0);
+    await new Promise((resolve) => setTimeout(resolve, 100));
+    link.setEventCallback(null);
+
+    expect(events.length % 3).toBe(0);
+    for (let i = 0; i < events.length; i += 3) {
+      expect(Object.values(LinkEventType)).toContain(events[i]);
+      expect(events[i + 1]).toBeLessThanOrEqual(link.getClockTime());
+      if (events[i] === LinkEventType.tempo) {
+        expect(events[i + 2]).toBe(133.0);
+      }
+    }
+  });
+
+  test('should keep on* helpers subscribed across setEventCallback', async () => {
+    const helper: number[] = [];
+    const raw: number[] = [];
+    const unsubscribe = link.onTempoChange((tempo: number) => helper.push(tempo));
+    link.setEventCallback((batch: Float64Array) => raw.push(...batch));
+    link.setTempo(141.0);
+    await new Promise((resolve) => setTimeout(resolve, 100));
+    expect(helper).toContain(141.0);
+    expect(raw).toContain(141.0);
+
+    link.setEventCallback(null);
+    link.setTempo(142.0);
+    await new Promise((resolve) => setTimeout(resolve, 100));
+    unsubscribe();
+    expect(helper).toContain(142.0);
+    expect(raw).not.toContain(142.0);
+  });
+
   test('should capture and commit session state', () => {
     const state = link.captureAppSessionState();
     expect(state.tempo()).toBe(120.0);
@@ -59,12 +160,91 @@ describe('AbletonLinkAudio', () => {
     link.commitAppSessionState(state);
   });
 
+  test('should capture session state into an existing object', () => {
+    const state = link.captureAppSessionState();
+    expect(link.captureAppSessionStateInto(state)).toBe(state);
+    expect(state.tempo()).toBe(120.0);
+    expect(link.captureAudioSessionStateInto(state)).toBe(state);
+    expect(() => link.captureAppSessionStateInto(42)).toThrow();
+  });
+
   test('should call on link thread', (done) => {
     link.callOnLinkThread(() => {
       done();
     });
   });
 
+  test('should run tasks on the link thread in order', async () => {
+    const order: number[] = [];
+    const results = await Promise.all(
+      [0, 1, 2, 3].map((i) =>
+        link.runOnLinkThread(() => {
+          order.push(i);
+          return i * 2;
+        })
+      )
+    );
+    expect(order).toEqual([0, 1, 2, 3]);
+    expect(results).toEqual([0, 2, 4, 6]);
+    await expect(
+      link.runOnLinkThread(() => {
+        throw new Error('task failed');
+      })
+    ).rejects.toThrow('task failed');
+  });
+
+  test('should attach handles to a shared instance', () => {
+    const key = link.share();
+    expect(link.share()).toBe(key);
+    const attached = AbletonLinkAudio.attach(key);
+    expect(attached.isAttached()).toBe(true);
+    expect(link.isAttached()).toBe(false);
+    link.setTempo(133);
+    expect(attached.getTempo()).toBeCloseTo(133, 5);
+    const sink = new AbletonLinkAudioSink(attached, 'shared-channel', 1024);
+    expect(sink.name()).toBe('shared-channel');
+    expect(() => attached.setTempoCallback(() => {})).toThrow();
+    attached.close();
+    expect(link.getTempo()).toBeCloseTo(133, 5);
+    expect(() => AbletonLinkAudio.attach('link-audio:unknown')).toThrow();
+  });
+
+  test('should share the Link peer with a worker thread', async () => {
+    const key = link.share();
+    link.setTempo(127);
+    // Eval workers are CommonJS, so the addon is loaded directly.
+    const source = `
+      const { parentPort, workerData } = require('worker_threads');
+      const addon = require('bindings')({ bindings: 'abletonlink', module_root: workerData.root });
+      const link = addon.AbletonLinkAudio.attach(workerData.key);
+      const sink = new addon.AbletonLinkAudioSink(link, 'worker-channel', 1024);
+      const tempo = link.getTempo();
+      link.setTempo(131);
+      parentPort.postMessage({ attached: link.isAttached(), tempo, sink: sink.name() });
+      link.close();
+    `;
+    const worker = new Worker(source, { eval: true, workerData: { key, root: process.cwd() } });
+    const result = await new Promise<any>((resolve, reject) => {
+      worker.once('message', resolve);
+      worker.once('error', reject);
+    });
+    await worker.terminate();
+
+    expect(result).toEqual({ attached: true, tempo: 127, sink: 'worker-channel' });
+    expect(link.getTempo()).toBeCloseTo(131, 5);
+  });
+
+  test('should report thread policy results per thread', () => {
+    const report = setThreadPolicy({ policy: 'other' });
+    expect(typeof report.supported).toBe('boolean');
+    expect(report.mlock).toBeNull();
+    if (report.supported) {
+      expect(report.threads.some((t: any) => t.name === 'link')).toBe(true);
+      expect(report.threads.every((t: any) => t.ok)).toBe(true);
+    }
+    expect(() => setThreadPolicy({ policy: 'idle' as any })).toThrow();
+  });
+
   test('should create sink and retain buffer safely', () => {
     const sink = new AbletonLinkAudioSink(link, 'test-channel', 1024);
     expect(sink.name()).toBe('test-channel');
@@ -74,6 +254,292 @@ describe('AbletonLinkAudio', () => {
     if (handle) {
       expect(handle.isValid()).toBe(true);
     }
+    sink.close();
+    expect(() => sink.retainBuffer()).toThrow('Sink is closed');
+    expect(() => new AbletonLinkAudioTransport(link, sink)).toThrow('Sink is closed');
+  });
+
+  test('should launch a transport on the next quantum boundary', async () => {
+    const sink = new AbletonLinkAudioSink(link, 'transport-channel', 1024);
+    const transport = new AbletonLinkAudioTransport(link, sink, {
+      quantum: 1,
+      framesPerBuffer: 256,
+    });
+    transport.setClip(new Int16Array(256 * 2), 2, 48000);
+    transport.start();
+    link.setIsPlaying(true);
+    await new Promise((resolve) => setTimeout(resolve, 50));
+    const status = transport.status();
+    expect(status.running).toBe(true);
+    expect(status.playing).toBe(true);
+    expect(Number.isInteger(status.launchBeat)).toBe(true);
+    expect(status.launchTime).toBeCloseTo(link.getTimeForBeat(status.launchBeat, 1), 3);
+    link.setIsPlaying(false);
+    transport.close();
+    expect(transport.status().running).toBe(false);
+  });
+
+  test('should write archives and seek them by beat', () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'lkar-'));
+    const writer = new AbletonLinkAudioArchiveWriter(
+      link,
+      '0x0000000000000000',
+      path.join(dir, 'empty.lkar')
+    );
+    writer.close();
+    expect(writer.status()).toMatchObject({ recording: false, numBlocks: 0, firstBeat: null });
+
+    // Three mono blocks of 4 frames covering beats [0, 1), [1, 2) and [3, 4).
+    const blocks = [
+      [0, 1],
+      [1, 2],
+      [3, 4],
+    ];
+    const archive = Buffer.alloc(64 + 3 * 8 + 3 * 40);
+    archive.write('LKAR', 0, 'ascii');
+    archive.writeUInt32LE(1, 4);
+    archive.writeUInt32LE(1, 8);
+    archive.writeUInt32LE(48000, 12);
+    archive.writeDoubleLE(4, 16);
+    archive.writeBigUInt64LE(3n, 24);
+    archive.writeBigUInt64LE(88n, 32);
+    archive.writeBigUInt64LE(12n, 40);
+    archive.writeDoubleLE(0, 48);
+    archive.writeDoubleLE(4, 56);
+    blocks.forEach(([begin, end], i) => {
+      const entry = 88 + i * 40;
+      archive.writeDoubleLE(begin, entry);
+      archive.writeDoubleLE(end, entry + 8);
+      archive.writeDoubleLE(120, entry + 16);
+      archive.writeBigUInt64LE(BigInt(64 + i * 8), entry + 24);
+      archive.writeUInt32LE(4, entry + 32);
+    });
+    const file = path.join(dir, 'blocks.lkar');
+    fs.writeFileSync(file, archive);
+
+    const sink = new AbletonLinkAudioSink(link, 'archive-channel', 1024);
+    const player = new AbletonLinkAudioArchivePlayer(link, sink, file);
+    expect(player.info()).toMatchObject({ numBlocks: 3, numFrames: 12, firstBeat: 0, lastBeat: 4 });
+    expect(player.seek(1.5)).toBeCloseTo(1.5);
+    expect(player.seek(2.5)).toBe(3);
+    expect(player.seek(-1)).toBe(0);
+    expect(player.seek(5)).toBeNull();
+    player.close();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  test('should play back the samples an archive recorded', async () => {
+    const poll = async (done: () => unknown, what: string) => {
+      for (let waited = 0; waited < 5000; waited += 20) {
+        const value = done();
+        if (value) return value;
+        await new Promise((resolve) => setTimeout(resolve, 20));
+      }
+      throw new Error(`Timed out waiting for ${what}`);
+    };
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'lkar-'));
+    const file = path.join(dir, 'roundtrip.lkar');
+    link.enable(true);
+    link.enableLinkAudio(true);
+    const peer = new AbletonLinkAudio(120.0, 'archive-peer');
+    peer.enable(true);
+    peer.enableLinkAudio(true);
+    try {
+      await poll(() => link.getNumPeers() > 0, 'the peer to join');
+      const input = new AbletonLinkAudioSink(peer, 'archive-in', 1024);
+      const inChannel: any = await poll(
+        () => link.findChannels({ name: 'archive-in' })[0],
+        'the input channel'
+      );
+      const writer = new AbletonLinkAudioArchiveWriter(link, inChannel.id, file, { quantum: 1 });
+      await new Promise((resolve) => setTimeout(resolve, 100));
+
+      // A mono ramp in contiguous 64-frame buffers: frame k holds k + 1.
+      const frames = 64;
+      const numBuffers = 40;
+      const state = peer.captureAppSessionState();
+      const firstBeat = state.beatAtTime(peer.getClockTime(), 1);
+      const beatsPerBuffer = (frames / 48000) * (state.tempo() / 60);
+      for (let b = 0; b < numBuffers; b++) {
+        const handle = input.retainBuffer();
+        expect(handle).not.toBeNull();
+        const out = handle!.samples()!;
+        const words = new Int16Array(out.buffer, out.byteOffset, frames);
+        words.forEach((_, i) => (words[i] = b * frames + i + 1));
+        handle!.commit(state, firstBeat + b * beatsPerBuffer, 1, frames, 1, 48000);
+        await new Promise((resolve) => setTimeout(resolve, 2));
+      }
+      await poll(() => writer.status().numBlocks === numBuffers, 'the writer');
+      writer.close();
+
+      const sink = new AbletonLinkAudioSink(link, 'archive-out', 1024);
+      const outChannel: any = await poll(
+        () => peer.findChannels({ name: 'archive-out' })[0],
+        'the output channel'
+      );
+      const received: number[][] = [];
+      const source = new AbletonLinkAudioSource(peer, outChannel.id, ({ samples }: any) => {
+        const words = new Int16Array(samples.buffer, samples.byteOffset, samples.length / 2);
+        const played = Array.from(words).filter((sample) => sample !== 0);
+        if (played.length > 0) received.push(played);
+      });
+      const player = new AbletonLinkAudioArchivePlayer(link, sink, file, { framesPerBuffer: 128 });
+      expect(player.info()).toMatchObject({ numChannels: 1, numFrames: numBuffers * frames });
+      player.start();
+      await poll(() => player.status().ended, 'playback to end');
+      await new Promise((resolve) => setTimeout(resolve, 100));
+      const status = player.status();
+      player.close();
+      source.close();
+
+      // Everything that sounded is the recorded ramp, in order and unaltered.
+      const played = received.flat();
+      expect(played.length).toBeGreaterThan(frames);
+      expect(played[0]).toBe(1);
+      expect(played[played.length - 1]).toBeLessThanOrEqual(numBuffers * frames);
+      expect(played.every((sample, i) => i === 0 || sample > played[i - 1])).toBe(true);
+      expect(received.every((run) => run.every((s, i) => i === 0 || s === run[i - 1] + 1))).toBe(
+        true
+      );
+      expect(status.framesCommitted).toBeGreaterThan(0);
+      expect(status.resyncs).toBe(0);
+    } finally {
+      peer.close();
+      fs.rmSync(dir, { recursive: true, force: true });
+    }
+  });
+
+  test('should mix clips and streams into a sink', async () => {
+    const sink = new AbletonLinkAudioSink(link, 'mix-channel', 4096);
+    const bus = new AbletonLinkAudioMixBus(link, sink, { quantum: 1, framesPerBuffer: 256 });
+    const clip = bus.addClip(new Int16Array(512).fill(20000), 2, { gain: 0.5 });
+    const stream = bus.addStream(1, { capacityFrames: 1024, pan: -1 });
+    expect(bus.write(stream, new Int16Array(1500).fill(30000))).toBe(1024);
+    expect(bus.setGain(clip, 2, 0)).toBe(true);
+    expect(bus.setPan(999, 0)).toBe(false);
+    expect(() => bus.addStream(3)).toThrow();
+
+    bus.start();
+    await new Promise((resolve) => setTimeout(resolve, 50));
+    const status = bus.status();
+    expect(status.running).toBe(true);
+    expect(status.inputs).toMatchObject([
+      { id: clip, type: 'clip', gain: 2 },
+      { id: stream, type: 'stream', pan: -1 },
+    ]);
+    expect(bus.removeInput(stream, 0)).toBe(true);
+    expect(bus.status().inputs).toHaveLength(1);
+    bus.close();
+    expect(bus.status()).toMatchObject({ running: false, inputs: [] });
+  });
+
+  test('should finish removing a drained stream', async () => {
+    const sink = new AbletonLinkAudioSink(link, 'mix-drain-channel', 4096);
+    const bus = new AbletonLinkAudioMixBus(link, sink, { quantum: 1, framesPerBuffer: 256 });
+    const stream = bus.addStream(1, { capacityFrames: 1024 });
+    bus.write(stream, new Int16Array(256).fill(1000));
+    bus.start();
+    await new Promise((resolve) => setTimeout(resolve, 50));
+    expect(bus.status().inputs[0].bufferedFrames).toBe(0);
+
+    // The stream has nothing left to mix; its fade-out must still run out.
+    expect(bus.removeInput(stream, 20)).toBe(true);
+    expect(bus.status().removingInputs).toBe(1);
+    await new Promise((resolve) => setTimeout(resolve, 100));
+    expect(bus.status().removingInputs).toBe(0);
+    bus.close();
+  });
+
+  test('should track tempo of a channel', () => {
+    expect(
+      () => new AbletonLinkAudioTempoTracker(link, '0x0000000000000000', null, { minBpm: 200 })
+    ).toThrow();
+    const tracker = new AbletonLinkAudioTempoTracker(link, '0x0000000000000000', () => {}, {
+      intervalMs: 50,
+    });
+    expect(tracker.status()).toMatchObject({
+      running: true,
+      commitEnabled: false,
+      tempo: null,
+      beatTime: null,
+      commits: 0,
+    });
+    tracker.setCommitEnabled(true);
+    expect(tracker.status().commitEnabled).toBe(true);
+    tracker.close();
+    expect(tracker.status().running).toBe(false);
+  });
+
+  test('should analyze channel spectra in log bands', () => {
+    expect(
+      () =>
+        new AbletonLinkAudioSpectrumAnalyzer(link, '0x0000000000000000', null, { fftSize: 1000 })
+    ).toThrow();
+    const analyzer = new AbletonLinkAudioSpectrumAnalyzer(link, '0x0000000000000000', null, {
+      fftSize: 1024,
+      bands: 10,
+      minHz: 50,
+      maxHz: 20000,
+    });
+    const edges = analyzer.bandFrequencies();
+    expect(edges).toHaveLength(11);
+    expect(edges[0]).toBeCloseTo(50);
+    expect(edges[10]).toBeCloseTo(20000, 0);
+    expect(analyzer.getSpectrum()).toBeNull();
+    expect(analyzer.status()).toMatchObject({ running: true, sampleRate: null, bands: 10 });
+    analyzer.close();
+    expect(analyzer.status().running).toBe(false);
+  });
+
+  test('should read a full-scale sine as 0 dB in its band', async () => {
+    link.enable(true);
+    link.enableLinkAudio(true);
+    const peer = new AbletonLinkAudio(120.0, 'spectrum-peer');
+    peer.enable(true);
+    peer.enableLinkAudio(true);
+    try {
+      const sink = new AbletonLinkAudioSink(peer, 'spectrum-sine', 1024);
+      let channel: any;
+      for (let waited = 0; !channel && waited < 5000; waited += 20) {
+        await new Promise((resolve) => setTimeout(resolve, 20));
+        channel = link.findChannels({ name: 'spectrum-sine' })[0];
+      }
+      expect(channel).toBeDefined();
+      const analyzer = new AbletonLinkAudioSpectrumAnalyzer(link, channel.id, null, {
+        fftSize: 2048,
+        bands: 32,
+      });
+      const edges = analyzer.bandFrequencies();
+      const band = edges.findIndex(
+        (edge: number, b: number) => edge <= 1000 && 1000 < edges[b + 1]
+      );
+      const hz = Math.sqrt(edges[band] * edges[band + 1]);
+
+      const frames = 512;
+      const state = peer.captureAppSessionState();
+      for (let n = 0; n < 60; n++) {
+        const handle = sink.retainBuffer();
+        if (handle) {
+          const out = handle.samples()!;
+          const words = new Int16Array(out.buffer, out.byteOffset, frames);
+          words.forEach((_, i) => {
+            words[i] = Math.round(32767 * Math.sin((2 * Math.PI * hz * (n * frames + i)) / 48000));
+          });
+          handle.commit(state, state.beatAtTime(peer.getClockTime(), 4), 4, frames, 1, 48000);
+        }
+        await new Promise((resolve) => setTimeout(resolve, 5));
+      }
+      await new Promise((resolve) => setTimeout(resolve, 100));
+      const spectrum = analyzer.getSpectrum();
+      analyzer.close();
+
+      expect(spectrum).not.toBeNull();
+      expect(spectrum![band]).toBeCloseTo(0, 0);
+      expect(spectrum![band - 2]).toBeLessThan(-40);
+      expect(spectrum![band + 2]).toBeLessThan(-40);
+    } finally {
+      peer.close();
+    }
   });
 
   test('should create source with dummy channel id', () => {
@@ -82,5 +548,178 @@ describe('AbletonLinkAudio', () => {
     source.close();
   });
 
+  test('should report channel latency and alignment', () => {
+    const plain = new AbletonLinkAudioSource(link, '0x0000000000000000', () => {});
+    expect(plain.getStats()).toMatchObject({
+      latency: { count: 0, smoothedMs: null },
+      alignment: null,
+    });
+    plain.close();
+
+    const aligned = new AbletonLinkAudioSource(link, '0x0000000000000000', () => {}, {
+      align: true,
+    });
+    expect(aligned.getStats().alignment).toEqual({
+      targetMs: 0,
+      buffersDelayed: 0,
+      buffersLate: 0,
+    });
+    aligned.close();
+  });
+
+  test('should delay aligned buffers to the target latency', async () => {
+    link.enable(true);
+    link.enableLinkAudio(true);
+    const peer = new AbletonLinkAudio(120.0, 'align-peer');
+    peer.enable(true);
+    peer.enableLinkAudio(true);
+    try {
+      const sink = new AbletonLinkAudioSink(peer, 'align-out', 1024);
+      let channel: any;
+      for (let waited = 0; !channel && waited < 5000; waited += 20) {
+        await new Promise((resolve) => setTimeout(resolve, 20));
+        channel = link.findChannels({ name: 'align-out' })[0];
+      }
+      expect(channel).toBeDefined();
+      const lags: number[] = [];
+      const target = new AbletonLinkAudioSource(
+        link,
+        channel.id,
+        ({ info }: any) => {
+          const state = link.captureAppSessionState();
+          const beat = info.beginBeats(state, 4);
+          if (beat !== null) {
+            lags.push((link.getClockTime() - state.timeAtBeat(beat, 4)) * 1000);
+          }
+        },
+        { align: true, targetLatencyMs: 80 }
+      );
+      const follower = new AbletonLinkAudioSource(link, channel.id, () => {}, { align: true });
+      expect(target.getStats().alignment!.targetMs).toBe(80);
+      expect(follower.getStats().alignment!.targetMs).toBe(80);
+
+      const frames = 256;
+      for (let n = 0; n < 20; n++) {
+        const handle = sink.retainBuffer();
+        if (handle) {
+          const state = peer.captureAppSessionState();
+          handle.commit(state, state.beatAtTime(peer.getClockTime(), 4), 4, frames, 1, 48000);
+        }
+        await new Promise((resolve) => setTimeout(resolve, 5));
+      }
+      await new Promise((resolve) => setTimeout(resolve, 200));
+      const stats = follower.getStats().alignment!;
+      target.close();
+      follower.close();
+
+      expect(stats.targetMs).toBeGreaterThanOrEqual(80);
+      expect(stats.buffersDelayed).toBeGreaterThan(0);
+      expect(lags.length).toBeGreaterThan(0);
+      expect(Math.min(...lags)).toBeGreaterThan(70);
+    } finally {
+      peer.close();
+    }
+  });
+
+  test('should close a source with aligned buffers still queued', async () => {
+    link.enable(true);
+    link.enableLinkAudio(true);
+    const peer = new AbletonLinkAudio(120.0, 'align-close-peer');
+    peer.enable(true);
+    peer.enableLinkAudio(true);
+    try {
+      const sink = new AbletonLinkAudioSink(peer, 'align-close', 1024);
+      let channel: any;
+      for (let waited = 0; !channel && waited < 5000; waited += 20) {
+        await new Promise((resolve) => setTimeout(resolve, 20));
+        channel = link.findChannels({ name: 'align-close' })[0];
+      }
+      expect(channel).toBeDefined();
+      let delivered = 0;
+      const source = new AbletonLinkAudioSource(
+        link,
+        channel.id,
+        () => {
+          delivered++;
+        },
+        { align: true, targetLatencyMs: 2000 }
+      );
+
+      for (let n = 0; n < 10; n++) {
+        const handle = sink.retainBuffer();
+        if (handle) {
+          const state = peer.captureAppSessionState();
+          handle.commit(state, state.beatAtTime(peer.getClockTime(), 4), 4, 256, 1, 48000);
+        }
+        await new Promise((resolve) => setTimeout(resolve, 5));
+      }
+      await new Promise((resolve) => setTimeout(resolve, 50));
+      expect(source.getStats().alignment!.buffersDelayed).toBeGreaterThan(0);
+      source.close();
+      await new Promise((resolve) => setTimeout(resolve, 50));
+      expect(delivered).toBe(0);
+    } finally {
+      peer.close();
+    }
+  });
+
+  test('should drain queue depth when a callback is replaced', async () => {
+    link.setTempoCallback(() => {});
+    for (let bpm = 100; bpm < 110; bpm++) link.setTempo(bpm);
+    // Keep the event loop busy so the notifications queue up undelivered.
+    const until = Date.now() + 50;
+    while (Date.now() < until);
+    link.setTempoCallback(() => {});
+    await new Promise((resolve) => setTimeout(resolve, 100));
+
+    const tempo = link.getStats().callbacks.tempo;
+    expect(tempo.dropped).toBeGreaterThan(0);
+    expect(tempo.queueDepth).toBe(0);
+  });
+
+  test('should report callback and buffer stats', async () => {
+    link.setTempoCallback(() => {});
+    link.setTempo(127.0);
+    link.getState(4, new Float64Array(5));
+    await new Promise((resolve) => setTimeout(resolve, 100));
+
+    const stats = link.getStats();
+    const tempo = stats.callbacks.tempo;
+    expect(tempo.delivered).toBeLessThanOrEqual(tempo.posted);
+    expect(tempo.posted).toBeLessThanOrEqual(tempo.fired);
+    expect(tempo.queueDepth).toBe(tempo.posted - tempo.delivered);
+    expect(tempo.latency.count).toBe(tempo.delivered);
+    expect(tempo.latency.buckets.reduce((a: number, b: number) => a + b, 0)).toBe(
+      tempo.delivered
+    );
+    expect(stats.allocationsAvoided).toBeGreaterThanOrEqual(1);
+
+    const sink = new AbletonLinkAudioSink(link, 'stats-channel', 1024);
+    const handle = sink.retainBuffer();
+    const sinkStats = sink.getStats();
+    expect(sinkStats.buffersRetained + sinkStats.retainFailures).toBe(1);
+    expect(sinkStats.buffersRetained).toBe(handle ? 1 : 0);
+
+    const source = new AbletonLinkAudioSource(link, '0x0000000000000000', () => {});
+    expect(source.getStats()).toMatchObject({ bytesCopied: 0, buffersPerSec: 0 });
+    source.close();
+  });
+
+  test('should export recorded spans as Chrome trace JSON', () => {
+    startTrace();
+    link.captureAppSessionState();
+    const sink = new AbletonLinkAudioSink(link, 'trace-channel', 1024);
+    sink.retainBuffer();
+    stopTrace();
+    link.captureAppSessionState();
+
+    const trace = JSON.parse(dumpTrace());
+    const names = trace.traceEvents.map((e: any) => `${e.cat}:${e.name}`);
+    expect(names).toContain('session:captureAppSessionState');
+    expect(names).toContain('sink:retain');
+    expect(names.filter((n: string) => n === 'session:captureAppSessionState')).toHaveLength(1);
+    expect(trace.traceEvents.find((e: any) => e.ph === 'M').args.name).toBeDefined();
+  });
+
   // linkAudioUtils tests live in test/linkaudio-utils.test.ts
 });